@@ -11,15 +11,16 @@
 #include "EffectButton.h"
 #include "ToolbarComponent.h"
 
-EffectButton::EffectButton(const juce::String &name)
+EffectButton::EffectButton(const EffectRegistry::Type &type, const juce::String &label)
     : juce::Component(),
-      effectName(name)
+      effectName(type.id),
+      displayName(label.isNotEmpty() ? label : type.displayName)
 {
   setOpaque(false);             // Make sure the component is not opaque
   setPaintingIsUnclipped(true); // This can help with OpenGL rendering
 
   // Load the SVG icon
-  loadSvgIcon();
+  loadSvgIcon(type.iconFile);
 }
 
 EffectButton::~EffectButton()
@@ -43,8 +44,11 @@ void EffectButton::setActive(bool shouldBeActive)
   }
 }
 
-void EffectButton::loadSvgIcon()
+void EffectButton::loadSvgIcon(const juce::String &svgFileName)
 {
+  if (svgFileName.isEmpty())
+    return;
+
   // Start from the executable location
   juce::File executableFile = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
   DBG("Executable path: " << executableFile.getFullPathName());
@@ -84,21 +88,6 @@ void EffectButton::loadSvgIcon()
 
   DBG("Looking for Assets folder in: " << currentDir.getFullPathName());
 
-  // Determine which SVG to load based on effect name
-  juce::String svgFileName;
-  if (effectName == "Delay")
-    svgFileName = "delay.svg";
-  else if (effectName == "Distortion")
-    svgFileName = "distortion.svg";
-  else if (effectName == "Reverb")
-    svgFileName = "reverb.svg";
-  else if (effectName == "Chorus")
-    svgFileName = "chorus.svg";
-  else if (effectName == "EQ")
-    svgFileName = "eq.svg";
-  else
-    return;
-
   // Try to load the SVG
   iconFile = currentDir.getChildFile("Assets/Icons/" + svgFileName);
   DBG("Attempting to load SVG from: " << iconFile.getFullPathName());
@@ -172,7 +161,7 @@ void EffectButton::paint(juce::Graphics &g)
   // Adjust text bounds to start closer to the left edge
   auto textBounds = bounds.reduced(padding * 1.5f, 0.0f); // Reduced left padding
   textBounds.setWidth(textBounds.getWidth() - iconSize - padding * 2);
-  g.drawText(effectName, textBounds, juce::Justification::centredLeft, true);
+  g.drawText(displayName, textBounds, juce::Justification::centredLeft, true);
 
   // Draw SVG icon if available
   if (icon != nullptr)
@@ -253,7 +242,29 @@ void EffectButton::mouseDown(const juce::MouseEvent &event)
 
   if (event.mods.isPopupMenu()) // Right click
   {
-    // Handle right-click menu if needed in the future
+    // Options for the effect this button has in the rack
+    juce::Component::SafePointer<EffectButton> safeThis(this);
+    juce::PopupMenu menu;
+
+    if (active && onPipelinedChange != nullptr)
+    {
+      const bool pipelined = isPipelined != nullptr && isPipelined();
+      menu.addItem("Run one block behind", true, pipelined, [safeThis, pipelined]
+                   {
+                     if (safeThis != nullptr && safeThis->onPipelinedChange != nullptr)
+                       safeThis->onPipelinedChange(!pipelined);
+                   });
+    }
+
+    if (onAddInstance != nullptr)
+      menu.addItem("Add another " + displayName, [safeThis]
+                   {
+                     if (safeThis != nullptr && safeThis->onAddInstance != nullptr)
+                       safeThis->onAddInstance();
+                   });
+
+    if (menu.getNumItems() > 0)
+      menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(this));
   }
   else // Left click
   {
@@ -412,8 +423,15 @@ int EffectButton::calculateInsertPosition(int newY) const
   return 0;
 }
 
-void EffectButton::mouseUp(const juce::MouseEvent &)
+void EffectButton::mouseUp(const juce::MouseEvent &event)
 {
+  if (event.mods.isPopupMenu())
+  {
+    // Right clicks open the menu instead of toggling
+    dragging = false;
+    return;
+  }
+
   if (!dragging)
   {
     // If we didn't drag, this was a click - toggle active state
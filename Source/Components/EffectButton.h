@@ -11,12 +11,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "../Effects/EffectRegistry.h"
 
 class EffectButton : public juce::Component,
                      public juce::Timer
 {
 public:
-  EffectButton(const juce::String &effectName);
+  // The label defaults to the type's display name
+  explicit EffectButton(const EffectRegistry::Type &type, const juce::String &label = {});
   ~EffectButton() override;
 
   void paint(juce::Graphics &) override;
@@ -38,11 +40,18 @@ public:
   // State management
   bool isActive() const { return active; }
   void setActive(bool shouldBeActive);
-  const juce::String &getEffectName() const { return effectName; }
+  const juce::String &getEffectName() const { return effectName; } // The type ID
 
   // Callback for state changes
   std::function<void(bool)> onStateChange;
 
+  // Offered in the right-click menu while the button is active
+  std::function<bool()> isPipelined;
+  std::function<void(bool)> onPipelinedChange;
+
+  // Offered in the right-click menu to put another instance of the type in the rack
+  std::function<void()> onAddInstance;
+
 private:
   // Custom constrainer that only allows vertical movement
   class VerticalOnlyConstrainer : public juce::ComponentBoundsConstrainer
@@ -87,11 +96,12 @@ private:
     juce::Rectangle<int> allowedBounds;
   };
 
-  void loadSvgIcon();
+  void loadSvgIcon(const juce::String &svgFileName);
   int calculateInsertPosition(int newY) const;
 
   // Member variables
   juce::String effectName;
+  juce::String displayName;
   bool active = false;
   bool dragging = false;
   float cornerSize = 6.0f;   // Rounded corner size
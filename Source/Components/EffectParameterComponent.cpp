@@ -1,8 +1,11 @@
 #include "EffectParameterComponent.h"
 #include "KnobComponent.h"
+#include "TransferCurveComponent.h"
+#include "ResponseCurveComponent.h"
 #include "../Effects/Delay.h"
 #include "../Effects/Distortion.h"
 #include "../Effects/Reverb.h"
+#include "../Effects/ConvolutionReverb.h"
 #include "../Effects/Chorus.h"
 #include "../Effects/Equalizer.h"
 
@@ -107,6 +110,8 @@ void EffectParameterComponent::setEnabled(bool shouldBeEnabled)
             distortion->setBypassed(!enabled);
         else if (auto *reverb = dynamic_cast<Reverb *>(processor))
             reverb->setBypassed(!enabled);
+        else if (auto *convolution = dynamic_cast<ConvolutionReverb *>(processor))
+            convolution->setBypassed(!enabled);
         else if (auto *chorus = dynamic_cast<Chorus *>(processor))
             chorus->setBypassed(!enabled);
         else if (auto *eq = dynamic_cast<Equalizer *>(processor))
@@ -140,6 +145,8 @@ void EffectParameterComponent::createParameterControls()
                             return &distortion->parameters;
                         if (auto *reverb = dynamic_cast<Reverb *>(processor))
                             return &reverb->parameters;
+                        if (auto *convolution = dynamic_cast<ConvolutionReverb *>(processor))
+                            return &convolution->parameters;
                         if (auto *chorus = dynamic_cast<Chorus *>(processor))
                             return &chorus->parameters;
                         if (auto *eq = dynamic_cast<Equalizer *>(processor))
@@ -194,13 +201,88 @@ void EffectParameterComponent::createParameterControls()
                 if (!useKnobs) // Only add value label for sliders
                     addAndMakeVisible(parameterValueLabels.back().get());
 
+                // Equalizer parameter IDs start with their band number, counting from 1
+                int band = -1;
+                if (auto *paramWithID = dynamic_cast<juce::AudioProcessorParameterWithID *>(parameter))
+                    if (dynamic_cast<Equalizer *>(processor) != nullptr && paramWithID->paramID.startsWith("band"))
+                        band = paramWithID->paramID.substring(4).getIntValue() - 1;
+
                 parameterControls.push_back(std::move(control));
+                controlBands.push_back(band);
                 // Do not push label to parameterLabels
             }
         }
+
+        // Distortion's custom curve is drawn rather than set with a knob
+        if (auto *distortion = dynamic_cast<Distortion *>(processor))
+        {
+            auto curveEditor = std::make_unique<TransferCurveComponent>(*distortion);
+            addAndMakeVisible(curveEditor.get());
+            parameterControls.push_back(std::move(curveEditor));
+            controlBands.push_back(-1);
+        }
+
+        // The equalizer shows the response of all its bands together
+        if (auto *eq = dynamic_cast<Equalizer *>(processor))
+        {
+            auto responseCurve = std::make_unique<ResponseCurveComponent>(*eq);
+            addAndMakeVisible(responseCurve.get());
+            parameterControls.push_back(std::move(responseCurve));
+            controlBands.push_back(-1);
+        }
+
+        // The convolution reverb needs a way to pick its impulse response file
+        if (auto *convolution = dynamic_cast<ConvolutionReverb *>(processor))
+        {
+            auto loadButton = std::make_unique<juce::TextButton>(convolution->getImpulseResponseName());
+            loadButton->setTooltip("Load an impulse response");
+            loadButton->onClick = [this, convolution, button = loadButton.get()]
+            {
+                impulseResponseChooser = std::make_unique<juce::FileChooser>("Load Impulse Response",
+                                                                             juce::File(),
+                                                                             "*.wav;*.aif;*.aiff;*.flac");
+                impulseResponseChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                                    [convolution, button](const juce::FileChooser &chooser)
+                                                    {
+                                                        const auto file = chooser.getResult();
+                                                        if (file.existsAsFile() && convolution->loadImpulseResponse(file))
+                                                            button->setButtonText(convolution->getImpulseResponseName());
+                                                    });
+            };
+            addAndMakeVisible(loadButton.get());
+            parameterControls.push_back(std::move(loadButton));
+            controlBands.push_back(-1);
+        }
+
+        // The equalizer picks which band's controls to show
+        if (dynamic_cast<Equalizer *>(processor) != nullptr)
+        {
+            auto bandSelector = std::make_unique<ComboBoxComponent>();
+            for (int band = 0; band < Equalizer::numBands; ++band)
+                bandSelector->addItem("Band " + juce::String(band + 1), band + 1);
+            bandSelector->setSelectedId(selectedBand + 1, juce::dontSendNotification);
+            bandSelector->getComboBox()->onChange = [this, comboBox = bandSelector->getComboBox()]
+            {
+                showBand(comboBox->getSelectedId() - 1);
+            };
+            addAndMakeVisible(bandSelector.get());
+            parameterControls.insert(parameterControls.begin(), std::move(bandSelector));
+            controlBands.insert(controlBands.begin(), -1);
+            showBand(selectedBand);
+        }
     }
 }
 
+void EffectParameterComponent::showBand(int band)
+{
+    selectedBand = band;
+
+    for (size_t i = 0; i < parameterControls.size(); ++i)
+        parameterControls[i]->setVisible(controlBands[i] < 0 || controlBands[i] == selectedBand);
+
+    updateParameterComponentBounds();
+}
+
 void EffectParameterComponent::updateParameterComponentBounds()
 {
     auto bounds = getLocalBounds();
@@ -211,11 +293,17 @@ void EffectParameterComponent::updateParameterComponentBounds()
     bounds.removeFromTop(static_cast<int>(padding));
     bounds.removeFromBottom(static_cast<int>(padding));
 
-    if (parameterControls.empty())
+    // Hidden controls, such as other equalizer bands, take no space
+    std::vector<juce::Component *> visibleControls;
+    for (auto &control : parameterControls)
+        if (control->isVisible())
+            visibleControls.push_back(control.get());
+
+    if (visibleControls.empty())
         return;
 
     // Calculate width for each control
-    const int numControls = static_cast<int>(parameterControls.size());
+    const int numControls = static_cast<int>(visibleControls.size());
     const int totalSpacing = static_cast<int>(controlSpacing) * (numControls - 1);
     const int controlWidth = juce::jmin(100, (bounds.getWidth() - totalSpacing) / numControls);
 
@@ -228,11 +316,11 @@ void EffectParameterComponent::updateParameterComponentBounds()
     int y = bounds.getY() + (bounds.getHeight() - groupHeight) / 2;
     int x = bounds.getX();
 
-    for (size_t i = 0; i < parameterControls.size(); ++i)
+    for (auto *control : visibleControls)
     {
         // Only set bounds for the control (knob/slider)
         auto controlBounds = juce::Rectangle<int>(x, y, controlWidth, groupHeight);
-        parameterControls[i]->setBounds(controlBounds);
+        control->setBounds(controlBounds);
         x += controlWidth + controlSpacing;
     }
 }
@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include "KnobComponent.h"
+#include "ComboBoxComponent.h"
 #include <juce_audio_processors/juce_audio_processors.h>
 
 class EffectParameterComponent : public juce::Component,
@@ -32,6 +33,7 @@ private:
     void createParameterControls();
     void updateParameterComponentBounds();
     bool shouldUseKnobs() const;
+    void showBand(int band);
 
     juce::String name;
     juce::AudioProcessor *audioProcessor;
@@ -39,6 +41,13 @@ private:
     std::vector<std::unique_ptr<juce::Label>> parameterLabels;
     std::vector<std::unique_ptr<juce::Label>> parameterValueLabels;
     std::unique_ptr<juce::ToggleButton> enableButton;
+    std::unique_ptr<juce::FileChooser> impulseResponseChooser;
+
+    // The band each control belongs to, or -1 for controls that are always shown.
+    // The equalizer has too many bands to show at once, so only the selected
+    // band's controls are visible.
+    std::vector<int> controlBands;
+    int selectedBand = 0;
 
     bool enabled = true;
     float opacity = 1.0f;
@@ -19,38 +19,34 @@ void EffectParametersContainer::resized()
     updateComponentBounds();
 }
 
-void EffectParametersContainer::addEffectParameters(const juce::String &effectName, juce::AudioProcessor *processor)
+void EffectParametersContainer::addEffectParameters(int handle, const juce::String &effectName, juce::AudioProcessor *processor)
 {
     // Check if we already have this effect
-    auto it = std::find_if(effectComponents.begin(), effectComponents.end(),
-                           [&effectName](const auto &info)
-                           {
-                               return info.component->getEffectName() == effectName;
-                           });
-
-    if (it == effectComponents.end())
+    if (findComponentIndex(handle) < 0)
     {
         EffectComponentInfo info;
         info.component = std::make_unique<EffectParameterComponent>(effectName, processor);
-        info.position = effectPositions.count(effectName) > 0 ? effectPositions[effectName] : static_cast<int>(effectComponents.size());
+        info.handle = handle;
+        info.position = effectPositions.count(handle) > 0 ? effectPositions[handle] : static_cast<int>(effectComponents.size());
 
+        const int position = info.position;
         addAndMakeVisible(info.component.get());
         effectComponents.push_back(std::move(info));
-        effectPositions[effectName] = info.position;
+        effectPositions[handle] = position;
 
         updatePositions();
         updateComponentBounds();
     }
 }
 
-void EffectParametersContainer::removeEffectParameters(const juce::String &effectName)
+void EffectParametersContainer::removeEffectParameters(int handle)
 {
     // Store the position before removal
     int position = -1;
     auto it = std::find_if(effectComponents.begin(), effectComponents.end(),
-                           [&effectName](const auto &info)
+                           [handle](const auto &info)
                            {
-                               return info.component->getEffectName() == effectName;
+                               return info.handle == handle;
                            });
 
     if (it != effectComponents.end())
@@ -58,7 +54,7 @@ void EffectParametersContainer::removeEffectParameters(const juce::String &effec
         position = it->position;
         effectComponents.erase(it);
         // Keep the position in effectPositions for potential restoration
-        effectPositions[effectName] = position;
+        effectPositions[handle] = position;
 
         updatePositions();
         updateComponentBounds();
@@ -109,15 +105,15 @@ void EffectParametersContainer::updatePositions()
     for (size_t i = 0; i < effectComponents.size(); ++i)
     {
         effectComponents[i].position = static_cast<int>(i);
-        effectPositions[effectComponents[i].component->getEffectName()] = static_cast<int>(i);
+        effectPositions[effectComponents[i].handle] = static_cast<int>(i);
     }
 }
 
-int EffectParametersContainer::findComponentIndex(const juce::String &effectName) const
+int EffectParametersContainer::findComponentIndex(int handle) const
 {
     for (size_t i = 0; i < effectComponents.size(); ++i)
     {
-        if (effectComponents[i].component->getEffectName() == effectName)
+        if (effectComponents[i].handle == handle)
         {
             return static_cast<int>(i);
         }
@@ -125,9 +121,9 @@ int EffectParametersContainer::findComponentIndex(const juce::String &effectName
     return -1;
 }
 
-void EffectParametersContainer::setEffectEnabled(const juce::String &effectName, bool shouldBeEnabled)
+void EffectParametersContainer::setEffectEnabled(int handle, bool shouldBeEnabled)
 {
-    auto index = findComponentIndex(effectName);
+    auto index = findComponentIndex(handle);
     if (index >= 0)
     {
         effectComponents[index].component->setEnabled(shouldBeEnabled);
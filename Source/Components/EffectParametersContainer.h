@@ -12,14 +12,15 @@ public:
     void paint(juce::Graphics &g) override;
     void resized() override;
 
-    // Add a new effect parameter component
-    void addEffectParameters(const juce::String &effectName, juce::AudioProcessor *processor);
+    // Add a new effect parameter component. Effects are identified by their
+    // handle in the rack, so several of one type can be shown.
+    void addEffectParameters(int handle, const juce::String &effectName, juce::AudioProcessor *processor);
 
     // Remove an effect parameter component
-    void removeEffectParameters(const juce::String &effectName);
+    void removeEffectParameters(int handle);
 
     // Enable/disable an effect
-    void setEffectEnabled(const juce::String &effectName, bool shouldBeEnabled);
+    void setEffectEnabled(int handle, bool shouldBeEnabled);
 
     // Reorder effect components
     void reorderEffects(int oldPosition, int newPosition);
@@ -27,8 +28,8 @@ public:
     // Get the minimum height needed to display all components
     int getMinimumHeight() const;
 
-    // Helper to find component index by name (moved to public)
-    int findComponentIndex(const juce::String &effectName) const;
+    // Helper to find component index by handle (moved to public)
+    int findComponentIndex(int handle) const;
 
 private:
     void updateComponentBounds();
@@ -37,6 +38,7 @@ private:
     struct EffectComponentInfo
     {
         std::unique_ptr<EffectParameterComponent> component;
+        int handle;
         int position;
     };
 
@@ -44,7 +46,7 @@ private:
     void updatePositions();
 
     std::vector<EffectComponentInfo> effectComponents;
-    std::map<juce::String, int> effectPositions; // Track positions separately
+    std::map<int, int> effectPositions; // Track positions separately, by handle
 
     const float padding = 20.0f;
     const float componentSpacing = 15.0f;
@@ -0,0 +1,113 @@
+#include "ResponseCurveComponent.h"
+
+ResponseCurveComponent::ResponseCurveComponent(Equalizer &equalizerToShow)
+    : juce::Thread("EQ Response Curve"),
+      equalizer(equalizerToShow),
+      snapshot(equalizerToShow.parameters, Equalizer::getParameterIDs()),
+      frequencies(numPoints),
+      magnitudes(numPoints)
+{
+    for (int i = 0; i < numPoints; ++i)
+        frequencies[static_cast<size_t>(i)] = minFrequency * std::pow(maxFrequency / minFrequency, i / (numPoints - 1.0));
+
+    startThread(juce::Thread::Priority::low);
+    startTimerHz(refreshRateHz);
+}
+
+ResponseCurveComponent::~ResponseCurveComponent()
+{
+    stopTimer();
+    stopThread(4000);
+}
+
+void ResponseCurveComponent::timerCallback()
+{
+    // Pick up a finished curve, then let the thread look for changes
+    bool changed = false;
+    {
+        const juce::ScopedLock lock(curveLock);
+        if (curvePending)
+        {
+            curve.swapWithPath(pendingCurve);
+            curvePending = false;
+            changed = true;
+        }
+    }
+
+    if (changed)
+        repaint();
+
+    notify();
+}
+
+void ResponseCurveComponent::run()
+{
+    while (!threadShouldExit())
+    {
+        wait(-1);
+
+        if (threadShouldExit())
+            return;
+
+        updateCurve();
+    }
+}
+
+void ResponseCurveComponent::updateCurve()
+{
+    // Before the equalizer has been prepared, draw it as it would run at 48 kHz
+    const double sampleRate = equalizer.getSampleRate() > 0.0 ? equalizer.getSampleRate() : 48000.0;
+    if (!snapshot.update() && curveValid && sampleRate == curveSampleRate)
+        return;
+
+    curveValid = true;
+    curveSampleRate = sampleRate;
+    Equalizer::getMagnitudeResponse(snapshot.get(), sampleRate, frequencies.data(), magnitudes.data(), numPoints);
+
+    juce::Path path;
+    for (int i = 0; i < numPoints; ++i)
+    {
+        const float x = static_cast<float>(i) / (numPoints - 1);
+
+        // Above Nyquist the bands have nothing left to say
+        const float db = frequencies[static_cast<size_t>(i)] < 0.5 * sampleRate
+                             ? juce::Decibels::gainToDecibels(magnitudes[static_cast<size_t>(i)], -rangeDb)
+                             : 0.0f;
+        const float y = juce::jmap(juce::jlimit(-rangeDb, rangeDb, db), rangeDb, -rangeDb, 0.0f, 1.0f);
+
+        if (i == 0)
+            path.startNewSubPath(x, y);
+        else
+            path.lineTo(x, y);
+    }
+
+    const juce::ScopedLock lock(curveLock);
+    pendingCurve.swapWithPath(path);
+    curvePending = true;
+}
+
+void ResponseCurveComponent::paint(juce::Graphics &g)
+{
+    auto area = getLocalBounds().toFloat().reduced(1.0f);
+
+    // Draw background
+    g.setColour(backgroundColour);
+    g.fillRoundedRectangle(area, cornerSize);
+
+    // Draw the 0 dB line and the decades for reference
+    g.setColour(gridColour);
+    g.drawLine(area.getX(), area.getCentreY(), area.getRight(), area.getCentreY(), 1.0f);
+    for (double decade : {100.0, 1000.0, 10000.0})
+    {
+        const float x = area.getX() + area.getWidth() * static_cast<float>(std::log(decade / minFrequency) / std::log(maxFrequency / minFrequency));
+        g.drawLine(x, area.getY(), x, area.getBottom(), 0.5f);
+    }
+
+    if (curve.isEmpty())
+        return;
+
+    // The curve is already computed, so painting only has to scale it
+    g.setColour(curveColour);
+    g.strokePath(curve, juce::PathStrokeType(1.5f),
+                 juce::AffineTransform::scale(area.getWidth(), area.getHeight()).translated(area.getX(), area.getY()));
+}
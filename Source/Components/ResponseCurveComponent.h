@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Effects/Equalizer.h"
+#include "../Effects/ParameterSnapshot.h"
+
+// Draws the Equalizer's combined magnitude response. The curve is worked out
+// on a background thread, only when the settings have changed, and handed
+// over as a finished path, so painting never evaluates a filter. The timer
+// checks for changes at display rate.
+class ResponseCurveComponent : public juce::Component,
+                               private juce::Timer,
+                               private juce::Thread
+{
+public:
+    explicit ResponseCurveComponent(Equalizer &equalizer);
+    ~ResponseCurveComponent() override;
+
+    void paint(juce::Graphics &g) override;
+
+private:
+    void timerCallback() override;
+    void run() override;
+
+    // Background thread. Rebuilds the path if the settings have moved.
+    void updateCurve();
+
+    Equalizer &equalizer;
+    ParameterSnapshot<Equalizer::ParameterValues> snapshot; // Only touched by the background thread
+    bool curveValid = false;
+
+    // Frequencies the response is evaluated at, log spaced across the range
+    static constexpr int numPoints = 256;
+    static constexpr double minFrequency = 20.0;
+    static constexpr double maxFrequency = 20000.0;
+    static constexpr float rangeDb = 24.0f; // Shown above and below 0 dB
+    std::vector<double> frequencies;
+    std::vector<float> magnitudes;
+    double curveSampleRate = 0.0;
+
+    // The newest curve, in a unit square: x from the lowest frequency to the
+    // highest, y from +rangeDb at the top to -rangeDb at the bottom
+    juce::CriticalSection curveLock;
+    juce::Path pendingCurve;
+    bool curvePending = false;
+    juce::Path curve;
+
+    juce::Colour curveColour = juce::Colour(0xff00ffff);      // Light blue
+    juce::Colour gridColour = juce::Colour(0xff555555);       // Mid gray
+    juce::Colour backgroundColour = juce::Colour(0xff333333); // Dark gray
+
+    const float cornerSize = 4.0f;
+    const int refreshRateHz = 30;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseCurveComponent)
+};
@@ -9,222 +9,137 @@
 */
 
 #include "ToolbarComponent.h"
-#include "../Effects/Reverb.h"
-#include "../Effects/Delay.h"
-#include "../Effects/Distortion.h"
-#include "../Effects/Chorus.h"
-#include "../Effects/Equalizer.h"
 
 ToolbarComponent::ToolbarComponent(EffectRack &rack)
     : effectRack(rack)
 {
-  // Create and add delay button
-  auto delayButton = std::make_unique<EffectButton>("Delay");
-  delayButton->onStateChange = [this](bool isActive)
-  {
-    if (isActive)
-    {
-      auto delay = std::make_unique<Delay>();
-      auto *delayPtr = delay.get();
-      int position = this->findNextAvailablePosition();
+  // One button per registered effect type
+  for (const auto &type : EffectRegistry::getInstance().getTypes())
+    addEffectButton(type);
 
-      this->effectRack.addEffect(std::move(delay));
-      this->saveEffectState("Delay", delayPtr, position);
-
-      if (this->onEffectVisibilityChanged)
-        this->onEffectVisibilityChanged("Delay", delayPtr, true);
-    }
-    else
-    {
-      auto it = this->effectStates.find("Delay");
-      if (it != this->effectStates.end())
-      {
-          int index = this ->effectRack.findEffectPosition("Delay");
-          if (index >= 0)
-              this->effectRack.setEffectActive(index, false);
-        if (this->onEffectVisibilityChanged)
-          this->onEffectVisibilityChanged("Delay", it->second.processor, false);
+  // Set initial size - this will be overridden by the parent's resized() call
+  setSize(200, 600);
 
-        it->second.isEnabled = false;
-      }
-    }
-  };
-  addAndMakeVisible(delayButton.get());
-  effectButtons.push_back(std::move(delayButton));
+  // Call resized to set up initial button positions
+  resized();
+}
 
-  // Create and add distortion button
-  auto distortionButton = std::make_unique<EffectButton>("Distortion");
-  distortionButton->onStateChange = [this](bool isActive)
+EffectButton &ToolbarComponent::addEffectButton(const EffectRegistry::Type &type, const juce::String &label)
+{
+  auto button = std::make_unique<EffectButton>(type, label);
+  auto *buttonPtr = button.get();
+  button->onStateChange = [this, buttonPtr](bool isActive)
   {
     if (isActive)
-    {
-      // Create a new Distortion effect at the next available position
-      auto distortion = std::make_unique<Distortion>();
-      auto *distortionPtr = distortion.get();
-      int position = findNextAvailablePosition();
+      enableEffect(*buttonPtr);
+    else
+      disableEffect(*buttonPtr);
+  };
+  button->isPipelined = [this, buttonPtr]()
+  {
+    auto it = buttonHandles.find(buttonPtr);
+    return it != buttonHandles.end() && effectRack.isEffectPipelined(effectRack.findEffectSlot(it->second));
+  };
+  button->onPipelinedChange = [this, buttonPtr](bool shouldPipeline)
+  {
+    auto it = buttonHandles.find(buttonPtr);
+    if (it != buttonHandles.end())
+      effectRack.setEffectPipelined(effectRack.findEffectSlot(it->second), shouldPipeline);
+  };
+  button->onAddInstance = [this, buttonPtr]()
+  {
+    addEffectInstance(*buttonPtr);
+  };
+  addAndMakeVisible(button.get());
+  effectButtons.push_back(std::move(button));
+  return *buttonPtr;
+}
 
-      // Add to effect rack and save state
-      effectRack.addEffect(std::move(distortion));
-      saveEffectState("Distortion", distortionPtr, position);
+void ToolbarComponent::addEffectInstance(const EffectButton &source)
+{
+  const auto *type = EffectRegistry::getInstance().findType(source.getEffectName());
+  if (type == nullptr)
+    return;
 
-      if (onEffectVisibilityChanged)
-        onEffectVisibilityChanged("Distortion", distortionPtr, true);
-    }
-    else
-    {
-      auto it = effectStates.find("Distortion");
-      if (it != effectStates.end())
-      {
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Distortion", it->second.processor, false);
+  // Number the new button after the ones already showing this type
+  int count = 1;
+  for (const auto &button : effectButtons)
+    if (button->getEffectName() == type->id)
+      ++count;
 
-        it->second.isEnabled = false;
-      }
-    }
-  };
-  addAndMakeVisible(distortionButton.get());
-  effectButtons.push_back(std::move(distortionButton));
+  // Switching the new button on puts its instance straight into the rack,
+  // under a handle of its own
+  auto &button = addEffectButton(*type, type->displayName + " " + juce::String(count));
+  resized();
+  button.setActive(true);
+}
 
-  // Create and add reverb button
-  auto reverbButton = std::make_unique<EffectButton>("Reverb");
-  reverbButton->onStateChange = [this](bool isActive)
+void ToolbarComponent::enableEffect(EffectButton &button)
+{
+  // Bring back the effect this button made before, keeping its settings
+  auto handleIt = buttonHandles.find(&button);
+  if (handleIt != buttonHandles.end())
   {
-    if (isActive)
+    auto it = effectStates.find(handleIt->second);
+    if (it != effectStates.end() && !it->second.isEnabled)
     {
-      // Check if we have a saved state
-      auto it = effectStates.find("Reverb");
-      if (it != effectStates.end() && !it->second.isEnabled)
+      // The slot gets a ready instance from the rack's pool, with the
+      // settings it was switched off with
+      int index = effectRack.findEffectSlot(handleIt->second);
+      if (index >= 0)
       {
-        // Restore the existing reverb at its previous position
-        it->second.isEnabled = true;
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Reverb", it->second.processor, true);
+        effectRack.setEffectActive(index, true);
+        it->second.processor = effectRack.getEffect(index);
       }
-      else
-      {
-        // Create a new Reverb effect at the next available position
-        auto reverb = std::make_unique<Reverb>();
-        auto *reverbPtr = reverb.get();
-        int position = findNextAvailablePosition();
-
-        // Add to effect rack and save state
-        effectRack.addEffect(std::move(reverb));
-        saveEffectState("Reverb", reverbPtr, position);
 
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Reverb", reverbPtr, true);
-      }
+      it->second.isEnabled = true;
+      if (onEffectVisibilityChanged)
+        onEffectVisibilityChanged(it->first, it->second.effectName, it->second.processor, true);
+      return;
     }
-    else
-    {
-      auto it = effectStates.find("Reverb");
-      if (it != effectStates.end())
-      {
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Reverb", it->second.processor, false);
+  }
 
-        it->second.isEnabled = false;
-      }
-    }
-  };
-  addAndMakeVisible(reverbButton.get());
-  effectButtons.push_back(std::move(reverbButton));
+  // Otherwise create a new one at the next available position
+  int position = findNextAvailablePosition();
 
-  // Add Chorus button
-  auto chorusButton = std::make_unique<EffectButton>("Chorus");
-  chorusButton->onStateChange = [this](bool isActive)
-  {
-    if (isActive)
-    {
-      auto it = effectStates.find("Chorus");
-      if (it != effectStates.end() && !it->second.isEnabled)
-      {
-        // Restore existing chorus
-        it->second.isEnabled = true;
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Chorus", it->second.processor, true);
-      }
-      else
-      {
-        // Create new chorus
-        auto chorus = std::make_unique<Chorus>();
-        auto *chorusPtr = chorus.get();
-        int position = findNextAvailablePosition();
+  auto handle = effectRack.addEffect(button.getEffectName());
+  auto *processor = effectRack.getEffect(effectRack.findEffectSlot(handle));
+  if (processor == nullptr)
+    return;
 
-        effectRack.addEffect(std::move(chorus));
-        saveEffectState("Chorus", chorusPtr, position);
+  buttonHandles[&button] = handle;
+  saveEffectState(handle, button.getEffectName(), processor, position);
 
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Chorus", chorusPtr, true);
-      }
-    }
-    else
-    {
-      auto it = effectStates.find("Chorus");
-      if (it != effectStates.end())
-      {
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("Chorus", it->second.processor, false);
-        it->second.isEnabled = false;
-      }
-    }
-  };
-  addAndMakeVisible(chorusButton.get());
-  effectButtons.push_back(std::move(chorusButton));
+  if (onEffectVisibilityChanged)
+    onEffectVisibilityChanged(handle, button.getEffectName(), processor, true);
+}
 
-  // Add EQ button
-  auto eqButton = std::make_unique<EffectButton>("EQ");
-  eqButton->onStateChange = [this](bool isActive)
-  {
-    if (isActive)
-    {
-      auto it = effectStates.find("EQ");
-      if (it != effectStates.end() && !it->second.isEnabled)
-      {
-        // Restore existing EQ
-        it->second.isEnabled = true;
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("EQ", it->second.processor, true);
-      }
-      else
-      {
-        // Create new EQ
-        auto eq = std::make_unique<Equalizer>();
-        auto *eqPtr = eq.get();
-        int position = findNextAvailablePosition();
+void ToolbarComponent::disableEffect(EffectButton &button)
+{
+  auto handleIt = buttonHandles.find(&button);
+  if (handleIt == buttonHandles.end())
+    return;
 
-        effectRack.addEffect(std::move(eq));
-        saveEffectState("EQ", eqPtr, position);
+  auto it = effectStates.find(handleIt->second);
+  if (it == effectStates.end())
+    return;
 
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("EQ", eqPtr, true);
-      }
-    }
-    else
-    {
-      auto it = effectStates.find("EQ");
-      if (it != effectStates.end())
-      {
-        if (onEffectVisibilityChanged)
-          onEffectVisibilityChanged("EQ", it->second.processor, false);
-        it->second.isEnabled = false;
-      }
-    }
-  };
-  addAndMakeVisible(eqButton.get());
-  effectButtons.push_back(std::move(eqButton));
+  // The panel lets go of the processor before it goes back to the pool
+  if (onEffectVisibilityChanged)
+    onEffectVisibilityChanged(it->first, it->second.effectName, it->second.processor, false);
 
-  // Set initial size - this will be overridden by the parent's resized() call
-  setSize(200, 600);
+  int index = effectRack.findEffectSlot(it->first);
+  if (index >= 0)
+    effectRack.setEffectActive(index, false);
 
-  // Call resized to set up initial button positions
-  resized();
+  it->second.isEnabled = false;
 }
 
-void ToolbarComponent::saveEffectState(const juce::String &effectName, juce::AudioProcessor *processor, int position)
+void ToolbarComponent::saveEffectState(EffectRack::Handle handle, const juce::String &effectName,
+                                       juce::AudioProcessor *processor, int position)
 {
   // Check if effect already exists and is enabled
-  auto it = effectStates.find(effectName);
+  auto it = effectStates.find(handle);
   if (it != effectStates.end() && it->second.isEnabled)
   {
     // Effect already exists and is enabled, don't create duplicate
@@ -232,13 +147,14 @@ void ToolbarComponent::saveEffectState(const juce::String &effectName, juce::Aud
   }
 
   ToolbarEffectState state;
+  state.effectName = effectName;
   state.processor = processor;
   state.isEnabled = true;
   state.position = position;
-  effectStates[effectName] = std::move(state);
+  effectStates[handle] = std::move(state);
 
   // Update the effect order in the rack using the single source of truth
-  int effectIndex = effectRack.findEffectPosition(effectName);
+  int effectIndex = effectRack.findEffectSlot(handle);
   if (effectIndex >= 0)
   {
     effectRack.setEffectOrder(effectIndex, position);
@@ -252,19 +168,19 @@ void ToolbarComponent::saveEffectState(const juce::String &effectName, juce::Aud
   }
 }
 
-void ToolbarComponent::restoreEffectState(const juce::String &effectName)
+void ToolbarComponent::restoreEffectState(EffectRack::Handle handle)
 {
-  auto it = effectStates.find(effectName);
+  auto it = effectStates.find(handle);
   if (it != effectStates.end())
   {
     it->second.isEnabled = true;
 
     // First notify about visibility
     if (onEffectVisibilityChanged)
-      onEffectVisibilityChanged(effectName, it->second.processor, true);
+      onEffectVisibilityChanged(handle, it->second.effectName, it->second.processor, true);
 
     // Update the effect order in the rack using the single source of truth
-    int effectIndex = effectRack.findEffectPosition(effectName);
+    int effectIndex = effectRack.findEffectSlot(handle);
     if (effectIndex >= 0)
     {
       effectRack.setEffectOrder(effectIndex, it->second.position);
@@ -353,7 +269,7 @@ void ToolbarComponent::normalizePositions()
 {
   // Check if normalization is needed
   bool needsNormalization = false;
-  std::vector<std::pair<juce::String, int>> enabledEffects;
+  std::vector<std::pair<EffectRack::Handle, int>> enabledEffects;
 
   // First pass: collect enabled effects and check for gaps
   int lastPosition = -1;
@@ -382,16 +298,16 @@ void ToolbarComponent::normalizePositions()
   // Assign new sequential positions
   for (size_t i = 0; i < enabledEffects.size(); ++i)
   {
-    const auto &effectName = enabledEffects[i].first;
+    const auto handle = enabledEffects[i].first;
     int newPosition = static_cast<int>(i);
 
     // Only update if position has changed
-    if (effectStates[effectName].position != newPosition)
+    if (effectStates[handle].position != newPosition)
     {
-      effectStates[effectName].position = newPosition;
+      effectStates[handle].position = newPosition;
 
       // Update rack position using the single source of truth
-      int effectIndex = effectRack.findEffectPosition(effectName);
+      int effectIndex = effectRack.findEffectSlot(handle);
       if (effectIndex >= 0)
       {
         effectRack.setEffectOrder(effectIndex, newPosition);
@@ -407,8 +323,8 @@ void ToolbarComponent::normalizePositions()
   {
     for (size_t i = 0; i < enabledEffects.size(); ++i)
     {
-      const auto &effectName = enabledEffects[i].first;
-      int oldPosition = effectStates[effectName].position;
+      const auto handle = enabledEffects[i].first;
+      int oldPosition = effectStates[handle].position;
       int newPosition = static_cast<int>(i);
 
       if (oldPosition != newPosition)
@@ -423,13 +339,11 @@ void ToolbarComponent::reorderButtons(EffectButton *draggedButton, int newPositi
 {
   // Find the current position of the dragged button
   int currentPosition = -1;
-  juce::String effectName;
   for (size_t i = 0; i < effectButtons.size(); ++i)
   {
     if (effectButtons[i].get() == draggedButton)
     {
       currentPosition = static_cast<int>(i);
-      effectName = draggedButton->getEffectName();
       break;
     }
   }
@@ -448,8 +362,11 @@ void ToolbarComponent::reorderButtons(EffectButton *draggedButton, int newPositi
   // Update effectStates positions to match the new visual order
   for (size_t i = 0; i < effectButtons.size(); ++i)
   {
-    const auto &button = effectButtons[i];
-    auto it = effectStates.find(button->getEffectName());
+    auto handleIt = buttonHandles.find(effectButtons[i].get());
+    if (handleIt == buttonHandles.end())
+      continue;
+
+    auto it = effectStates.find(handleIt->second);
     if (it != effectStates.end())
     {
       it->second.position = static_cast<int>(i);
@@ -457,7 +374,8 @@ void ToolbarComponent::reorderButtons(EffectButton *draggedButton, int newPositi
   }
 
   // Update the effect order in the rack using the single source of truth
-  int effectIndex = effectRack.findEffectPosition(effectName);
+  auto handleIt = buttonHandles.find(draggedButton);
+  int effectIndex = handleIt != buttonHandles.end() ? effectRack.findEffectSlot(handleIt->second) : -1;
   if (effectIndex >= 0)
   {
     effectRack.setEffectOrder(effectIndex, newPosition);
@@ -23,8 +23,9 @@ public:
   void paint(juce::Graphics &) override;
   void resized() override;
 
-  // Callback for effect visibility change
-  std::function<void(const juce::String &, juce::AudioProcessor *, bool)> onEffectVisibilityChanged;
+  // Callback for effect visibility change, with the effect's handle in the rack
+  // and its type name
+  std::function<void(EffectRack::Handle, const juce::String &, juce::AudioProcessor *, bool)> onEffectVisibilityChanged;
 
   // Callback for effect reordering
   std::function<void(int, int)> onEffectReordered;
@@ -40,21 +41,30 @@ public:
   const int buttonMargin = 20; // Top margin for first butto
 
   // Helper methods for effect managemen
-  void saveEffectState(const juce::String &effectName, juce::AudioProcessor *processor, int position);
-  void restoreEffectState(const juce::String &effectName);
+  void saveEffectState(EffectRack::Handle handle, const juce::String &effectName, juce::AudioProcessor *processor, int position);
+  void restoreEffectState(EffectRack::Handle handle);
   int findNextAvailablePosition() const;
   void normalizePositions();
 
 private:
+  // Each button toggles one instance of its type, created the first time;
+  // more instances of a type get a button of their own
+  EffectButton &addEffectButton(const EffectRegistry::Type &type, const juce::String &label = {});
+  void addEffectInstance(const EffectButton &source);
+  void enableEffect(EffectButton &button);
+  void disableEffect(EffectButton &button);
+
   struct ToolbarEffectState
   {
+    juce::String effectName;
     bool isEnabled = false;
     juce::AudioProcessor *processor = nullptr;
     int position = -1;
   };
 
   std::vector<std::unique_ptr<EffectButton>> effectButtons;
-  std::map<juce::String, ToolbarEffectState> effectStates;
+  std::map<EffectRack::Handle, ToolbarEffectState> effectStates;
+  std::map<const EffectButton *, EffectRack::Handle> buttonHandles; // The instance each button made
 
   const float toolbarWidthRatio = 0.2f; // Toolbar takes 20% of parent widt
   int buttonSpacing = 10;               // Will be calculated based on button heigh
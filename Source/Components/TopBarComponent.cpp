@@ -1,6 +1,7 @@
 #include "TopBarComponent.h"
 
-TopBarComponent::TopBarComponent()
+TopBarComponent::TopBarComponent(GainProcessor &inputGain, GainProcessor &outputGain)
+    : inputGainProcessor(inputGain), outputGainProcessor(outputGain)
 {
     addAndMakeVisible(levelMeter);
 
@@ -9,6 +10,25 @@ TopBarComponent::TopBarComponent()
 
     // Create gain controls
     createGainControls();
+
+    compareButton.setTooltip("Switch between racks A and B");
+    compareButton.onClick = [this]
+    {
+        if (onCompareClicked)
+            onCompareClicked();
+    };
+    addAndMakeVisible(compareButton);
+
+    morphButton.setTooltip("Add or clear morph snapshots");
+    morphButton.onClick = [this]
+    {
+        if (onMorphClicked)
+            onMorphClicked();
+    };
+    addAndMakeVisible(morphButton);
+
+    morphSlider.setTooltip("Morph between the snapshots");
+    addAndMakeVisible(morphSlider);
 }
 
 TopBarComponent::~TopBarComponent()
@@ -77,6 +97,32 @@ void TopBarComponent::resized()
     // Position output gain knob
     auto outputBounds = knobArea.removeFromLeft(knobWidth);
     outputGainKnob->setBounds(outputBounds);
+
+    // A/B switch to the left of the gain controls
+    const int compareSize = 32;
+    compareButton.setBounds(bounds.removeFromRight(compareSize + gainControlsPadding)
+                                .withTrimmedRight(gainControlsPadding)
+                                .withSizeKeepingCentre(compareSize, compareSize));
+
+    // Morph controls to the left of the A/B switch
+    const int morphSliderWidth = 100;
+    const int morphButtonWidth = 60;
+    morphSlider.setBounds(bounds.removeFromRight(morphSliderWidth + gainControlsPadding)
+                              .withTrimmedRight(gainControlsPadding)
+                              .withSizeKeepingCentre(morphSliderWidth, compareSize));
+    morphButton.setBounds(bounds.removeFromRight(morphButtonWidth + 10)
+                              .withTrimmedRight(10)
+                              .withSizeKeepingCentre(morphButtonWidth, compareSize));
+}
+
+void TopBarComponent::setActiveRack(int index)
+{
+    compareButton.setButtonText(index == 0 ? "A" : "B");
+}
+
+void TopBarComponent::setMorphParameter(juce::RangedAudioParameter &parameter)
+{
+    morphAttachment = std::make_unique<juce::SliderParameterAttachment>(parameter, morphSlider);
 }
 
 void TopBarComponent::setLevels(float leftLevel, float rightLevel)
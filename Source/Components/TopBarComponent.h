@@ -10,7 +10,9 @@ class TopBarComponent : public juce::Component,
                         private juce::AsyncUpdater
 {
 public:
-    TopBarComponent();
+    // The gain stages belong to the processor, so the knobs keep working
+    // whether or not the editor is open
+    TopBarComponent(GainProcessor &inputGain, GainProcessor &outputGain);
     ~TopBarComponent() override;
 
     void paint(juce::Graphics &) override;
@@ -19,6 +21,15 @@ public:
     void setLevel(float newLevel) { setLevels(newLevel, newLevel); }
     void setLevels(float leftLevel, float rightLevel);
 
+    // The A/B switch. Shows which rack is active; clicking asks for the other.
+    std::function<void()> onCompareClicked;
+    void setActiveRack(int index);
+
+    // Morphing. The slider follows the processor's morph parameter, and the
+    // button asks for the snapshot menu.
+    std::function<void()> onMorphClicked;
+    void setMorphParameter(juce::RangedAudioParameter &parameter);
+
 private:
     void handleAsyncUpdate() override;
     void createGainControls();
@@ -31,13 +42,19 @@ private:
     const juce::String title{"Tonic"};
     const int leftPadding = 15; // Padding from left edge
 
+    juce::TextButton compareButton{"A"};
+
+    juce::TextButton morphButton{"Morph"};
+    juce::Slider morphSlider{juce::Slider::LinearHorizontal, juce::Slider::NoTextBox};
+    std::unique_ptr<juce::SliderParameterAttachment> morphAttachment;
+
     // Gain controls
     std::unique_ptr<RotaryKnob> inputGainKnob;
     std::unique_ptr<RotaryKnob> outputGainKnob;
 
     // Gain processors
-    GainProcessor inputGainProcessor{true};   // true for input gain
-    GainProcessor outputGainProcessor{false}; // false for output gain
+    GainProcessor &inputGainProcessor;
+    GainProcessor &outputGainProcessor;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TopBarComponent)
 };
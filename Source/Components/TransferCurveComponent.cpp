@@ -0,0 +1,133 @@
+#include "TransferCurveComponent.h"
+#include "../Effects/Distortion.h"
+
+TransferCurveComponent::TransferCurveComponent(Distortion &distortionToEdit)
+    : distortion(distortionToEdit), points(distortionToEdit.getTransferCurve())
+{
+}
+
+TransferCurveComponent::~TransferCurveComponent()
+{
+}
+
+juce::Rectangle<float> TransferCurveComponent::getCurveArea() const
+{
+    // Keep the curve square and leave room for the point handles
+    auto bounds = getLocalBounds().toFloat().reduced(pointRadius);
+    const float side = juce::jmin(bounds.getWidth(), bounds.getHeight());
+    return bounds.withSizeKeepingCentre(side, side);
+}
+
+juce::Point<float> TransferCurveComponent::toCurve(juce::Point<float> position) const
+{
+    auto area = getCurveArea();
+    const float x = juce::jmap(position.x, area.getX(), area.getRight(), -1.0f, 1.0f);
+    const float y = juce::jmap(position.y, area.getBottom(), area.getY(), -1.0f, 1.0f);
+    return {juce::jlimit(-1.0f, 1.0f, x), juce::jlimit(-1.0f, 1.0f, y)};
+}
+
+juce::Point<float> TransferCurveComponent::toScreen(juce::Point<float> point) const
+{
+    auto area = getCurveArea();
+    return {juce::jmap(point.x, -1.0f, 1.0f, area.getX(), area.getRight()),
+            juce::jmap(point.y, -1.0f, 1.0f, area.getBottom(), area.getY())};
+}
+
+int TransferCurveComponent::findPointNear(juce::Point<float> position) const
+{
+    for (int i = 0; i < points.size(); ++i)
+        if (toScreen(points[i]).getDistanceFrom(position) <= hitRadius)
+            return i;
+
+    return -1;
+}
+
+void TransferCurveComponent::paint(juce::Graphics &g)
+{
+    auto area = getCurveArea();
+
+    // Draw background
+    g.setColour(backgroundColour);
+    g.fillRoundedRectangle(area, cornerSize);
+
+    // Draw axes and the unity line for reference
+    g.setColour(gridColour);
+    g.drawLine(area.getCentreX(), area.getY(), area.getCentreX(), area.getBottom(), 1.0f);
+    g.drawLine(area.getX(), area.getCentreY(), area.getRight(), area.getCentreY(), 1.0f);
+    g.drawLine(area.getX(), area.getBottom(), area.getRight(), area.getY(), 0.5f);
+
+    if (points.isEmpty())
+        return;
+
+    // Draw the curve through the control points
+    juce::Path curve;
+    curve.startNewSubPath(toScreen(points.getFirst()));
+    for (int i = 1; i < points.size(); ++i)
+        curve.lineTo(toScreen(points[i]));
+
+    g.setColour(curveColour);
+    g.strokePath(curve, juce::PathStrokeType(1.5f));
+
+    // Draw the point handles
+    for (const auto &point : points)
+        g.fillEllipse(juce::Rectangle<float>(pointRadius * 2.0f, pointRadius * 2.0f).withCentre(toScreen(point)));
+}
+
+void TransferCurveComponent::mouseDown(const juce::MouseEvent &event)
+{
+    draggedIndex = findPointNear(event.position);
+
+    if (draggedIndex < 0)
+    {
+        // Add a new point between its neighbours
+        const auto point = toCurve(event.position);
+        int insertIndex = 0;
+        while (insertIndex < points.size() && points[insertIndex].x < point.x)
+            ++insertIndex;
+
+        points.insert(insertIndex, point);
+        draggedIndex = insertIndex;
+        distortion.setTransferCurve(points);
+        repaint();
+    }
+}
+
+void TransferCurveComponent::mouseDrag(const juce::MouseEvent &event)
+{
+    if (!juce::isPositiveAndBelow(draggedIndex, points.size()))
+        return;
+
+    auto point = toCurve(event.position);
+
+    // End points stay at the edges, interior points stay between their neighbours
+    if (draggedIndex == 0)
+        point.x = -1.0f;
+    else if (draggedIndex == points.size() - 1)
+        point.x = 1.0f;
+    else
+        point.x = juce::jlimit(points[draggedIndex - 1].x, points[draggedIndex + 1].x, point.x);
+
+    points.set(draggedIndex, point);
+    distortion.setTransferCurve(points);
+    repaint();
+}
+
+void TransferCurveComponent::mouseUp(const juce::MouseEvent &)
+{
+    draggedIndex = -1;
+}
+
+void TransferCurveComponent::mouseDoubleClick(const juce::MouseEvent &event)
+{
+    const int index = findPointNear(event.position);
+
+    // Keep the end points so the curve always spans the full input range
+    if (index > 0 && index < points.size() - 1)
+    {
+        points.remove(index);
+        distortion.setTransferCurve(points);
+        repaint();
+    }
+
+    draggedIndex = -1;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+class Distortion;
+
+// Editor for Distortion's custom transfer curve. Click to add a point, drag to
+// move it, double-click to remove it. The end points can only move vertically.
+class TransferCurveComponent : public juce::Component
+{
+public:
+    explicit TransferCurveComponent(Distortion &distortion);
+    ~TransferCurveComponent() override;
+
+    void paint(juce::Graphics &g) override;
+
+    void mouseDown(const juce::MouseEvent &event) override;
+    void mouseDrag(const juce::MouseEvent &event) override;
+    void mouseUp(const juce::MouseEvent &event) override;
+    void mouseDoubleClick(const juce::MouseEvent &event) override;
+
+private:
+    juce::Rectangle<float> getCurveArea() const;
+    juce::Point<float> toCurve(juce::Point<float> position) const;
+    juce::Point<float> toScreen(juce::Point<float> point) const;
+    int findPointNear(juce::Point<float> position) const;
+
+    Distortion &distortion;
+    juce::Array<juce::Point<float>> points;
+    int draggedIndex = -1;
+
+    juce::Colour curveColour = juce::Colour(0xff00ffff);      // Light blue
+    juce::Colour gridColour = juce::Colour(0xff555555);       // Mid gray
+    juce::Colour backgroundColour = juce::Colour(0xff333333); // Dark gray
+
+    const float cornerSize = 4.0f;
+    const float pointRadius = 4.0f;
+    const float hitRadius = 8.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransferCurveComponent)
+};
@@ -57,40 +57,40 @@ bool WorkspaceComponent::keyPressed(const juce::KeyPress &key)
   return false;
 }
 
-void WorkspaceComponent::addEffectParameters(const juce::String &effectName, juce::AudioProcessor *processor)
+void WorkspaceComponent::addEffectParameters(int handle, const juce::String &effectName, juce::AudioProcessor *processor)
 {
   // If we have a stored position, use it, otherwise use the next available position
-  int position = effectPositions.count(effectName) > 0 ? effectPositions[effectName] : static_cast<int>(effectPositions.size());
+  int position = effectPositions.count(handle) > 0 ? effectPositions[handle] : static_cast<int>(effectPositions.size());
 
-  effectParameters.addEffectParameters(effectName, processor);
-  updateEffectPosition(effectName, position);
+  effectParameters.addEffectParameters(handle, effectName, processor);
+  updateEffectPosition(handle, position);
   resized();
 }
 
-void WorkspaceComponent::removeEffectParameters(const juce::String &effectName)
+void WorkspaceComponent::removeEffectParameters(int handle)
 {
   // Store the position before removal
-  int position = getEffectPosition(effectName);
+  int position = getEffectPosition(handle);
   if (position >= 0)
   {
-    effectPositions[effectName] = position; // Keep position for later restoration
+    effectPositions[handle] = position; // Keep position for later restoration
   }
 
-  effectParameters.removeEffectParameters(effectName);
+  effectParameters.removeEffectParameters(handle);
   resized();
 }
 
-void WorkspaceComponent::setEffectEnabled(const juce::String &effectName, bool shouldBeEnabled)
+void WorkspaceComponent::setEffectEnabled(int handle, bool shouldBeEnabled)
 {
-  effectParameters.setEffectEnabled(effectName, shouldBeEnabled);
+  effectParameters.setEffectEnabled(handle, shouldBeEnabled);
 
   if (!shouldBeEnabled)
   {
     // Store position when disabling
-    int position = getEffectPosition(effectName);
+    int position = getEffectPosition(handle);
     if (position >= 0)
     {
-      effectPositions[effectName] = position;
+      effectPositions[handle] = position;
     }
   }
 
@@ -114,17 +114,17 @@ void WorkspaceComponent::reorderEffects(int oldPosition, int newPosition)
   resized();
 }
 
-int WorkspaceComponent::getEffectPosition(const juce::String &effectName) const
+int WorkspaceComponent::getEffectPosition(int handle) const
 {
-  return effectParameters.findComponentIndex(effectName);
+  return effectParameters.findComponentIndex(handle);
 }
 
-void WorkspaceComponent::updateEffectPosition(const juce::String &effectName, int newPosition)
+void WorkspaceComponent::updateEffectPosition(int handle, int newPosition)
 {
-  effectPositions[effectName] = newPosition;
+  effectPositions[handle] = newPosition;
 
   // If the current position differs from the desired position, reorder
-  int currentPosition = getEffectPosition(effectName);
+  int currentPosition = getEffectPosition(handle);
   if (currentPosition >= 0 && currentPosition != newPosition)
   {
     effectParameters.reorderEffects(currentPosition, newPosition);
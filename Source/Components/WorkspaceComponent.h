@@ -23,26 +23,27 @@ public:
   void resized() override;
   bool keyPressed(const juce::KeyPress &key) override;
 
-  // Forward these methods to the effectParameters container
-  void addEffectParameters(const juce::String &effectName, juce::AudioProcessor *processor);
-  void removeEffectParameters(const juce::String &effectName);
-  void setEffectEnabled(const juce::String &effectName, bool shouldBeEnabled);
+  // Forward these methods to the effectParameters container. Effects are
+  // identified by their handle in the rack.
+  void addEffectParameters(int handle, const juce::String &effectName, juce::AudioProcessor *processor);
+  void removeEffectParameters(int handle);
+  void setEffectEnabled(int handle, bool shouldBeEnabled);
 
   // Add method to reorder effects
   void reorderEffects(int oldPosition, int newPosition);
 
   // Get current position of an effect
-  int getEffectPosition(const juce::String &effectName) const;
+  int getEffectPosition(int handle) const;
 
 private:
   std::unique_ptr<juce::Viewport> viewport;
   EffectParametersContainer effectParameters;
 
   // Track effect positions
-  std::map<juce::String, int> effectPositions;
+  std::map<int, int> effectPositions;
 
   // Helper method to update positions
-  void updateEffectPosition(const juce::String &effectName, int newPosition);
+  void updateEffectPosition(int handle, int newPosition);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkspaceComponent)
 };
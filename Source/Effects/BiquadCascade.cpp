@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.cpp
+    Created: 18 Oct 2026 10:12:40pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "BiquadCascade.h"
+
+BiquadCascade::Section BiquadCascade::makeSection(const Coefficients &coefficients)
+{
+  return {Vector::expand(coefficients.b0), Vector::expand(coefficients.b1), Vector::expand(coefficients.b2),
+          Vector::expand(coefficients.a1), Vector::expand(coefficients.a2),
+          Vector::expand(0.0), Vector::expand(0.0)};
+}
+
+void BiquadCascade::reset()
+{
+  for (int i = 0; i < numSections; ++i)
+  {
+    auto &section = sections[static_cast<size_t>(i)];
+    section.s1 = Vector::expand(0.0);
+    section.s2 = Vector::expand(0.0);
+  }
+}
+
+void BiquadCascade::setLayout(const int *previous, int newNumSections)
+{
+  jassert(newNumSections <= maxSections);
+  newNumSections = juce::jlimit(0, maxSections, newNumSections);
+
+  std::array<Section, maxSections> next;
+  for (int i = 0; i < newNumSections; ++i)
+  {
+    const int from = previous[i];
+    next[static_cast<size_t>(i)] = from >= 0 && from < numSections ? sections[static_cast<size_t>(from)] : makeSection({});
+  }
+
+  std::copy(next.begin(), next.begin() + newNumSections, sections.begin());
+  numSections = newNumSections;
+}
+
+void BiquadCascade::setCoefficients(int section, const Coefficients &coefficients)
+{
+  auto &target = sections[static_cast<size_t>(section)];
+  const auto state = std::make_pair(target.s1, target.s2);
+
+  target = makeSection(coefficients);
+  target.s1 = state.first;
+  target.s2 = state.second;
+}
+
+void BiquadCascade::process(juce::dsp::AudioBlock<float> &block)
+{
+  processBlock<false>(block);
+}
+
+void BiquadCascade::process(juce::dsp::AudioBlock<float> &block, const Coefficients *targets)
+{
+  const int numSamples = static_cast<int>(block.getNumSamples());
+  if (numSamples == 0)
+    return;
+
+  const double scale = 1.0 / numSamples;
+  for (int i = 0; i < numSections; ++i)
+  {
+    const auto &current = sections[static_cast<size_t>(i)];
+    const auto target = makeSection(targets[i]);
+    auto &step = steps[static_cast<size_t>(i)];
+
+    step.b0 = (target.b0 - current.b0) * scale;
+    step.b1 = (target.b1 - current.b1) * scale;
+    step.b2 = (target.b2 - current.b2) * scale;
+    step.a1 = (target.a1 - current.a1) * scale;
+    step.a2 = (target.a2 - current.a2) * scale;
+  }
+
+  processBlock<true>(block);
+
+  // Land exactly on the targets rather than wherever rounding left the glide
+  for (int i = 0; i < numSections; ++i)
+    setCoefficients(i, targets[i]);
+}
+
+template <bool glide>
+void BiquadCascade::processBlock(juce::dsp::AudioBlock<float> &block)
+{
+  if (numSections == 0)
+    return;
+
+  const int numChannels = juce::jmin(maxChannels, static_cast<int>(block.getNumChannels()));
+  const int numSamples = static_cast<int>(block.getNumSamples());
+  alignas(sizeof(Vector)) double frames[chunkSize * lanes] = {};
+
+  for (int start = 0; start < numSamples; start += chunkSize)
+  {
+    const int count = juce::jmin(chunkSize, numSamples - start);
+
+    // Interleave, one frame of channels per register
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+      const float *samples = block.getChannelPointer(static_cast<size_t>(channel)) + start;
+      for (int i = 0; i < count; ++i)
+        frames[i * lanes + channel] = samples[i];
+    }
+
+    processFrames<glide>(frames, count);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+      float *samples = block.getChannelPointer(static_cast<size_t>(channel)) + start;
+      for (int i = 0; i < count; ++i)
+        samples[i] = static_cast<float>(frames[i * lanes + channel]);
+    }
+  }
+}
+
+template <bool glide>
+void BiquadCascade::processFrames(double *frames, int numFrames)
+{
+  Section *chain = sections.data();
+  const Section *chainSteps = steps.data();
+  const int count = numSections;
+
+  for (int i = 0; i < numFrames; ++i)
+  {
+    auto x = Vector::fromRawArray(frames + i * lanes);
+
+    for (int k = 0; k < count; ++k)
+    {
+      auto &section = chain[k];
+
+      if constexpr (glide)
+      {
+        const auto &step = chainSteps[k];
+        section.b0 += step.b0;
+        section.b1 += step.b1;
+        section.b2 += step.b2;
+        section.a1 += step.a1;
+        section.a2 += step.a2;
+      }
+
+      const auto y = section.b0 * x + section.s1;
+      section.s1 = section.b1 * x - section.a1 * y + section.s2;
+      section.s2 = section.b2 * x - section.a2 * y;
+      x = y;
+    }
+
+    x.copyToRawArray(frames + i * lanes);
+  }
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    Created: 18 Oct 2026 10:12:40pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+// A chain of transposed direct form II biquad sections run in a single pass:
+// each sample goes through every section before the next sample starts. The
+// channels of a sample share one SIMD register, so a stereo section costs the
+// same as a mono one. Work is done in double precision, which keeps low and
+// narrow bands accurate, and which fills a 128-bit register with a stereo pair.
+//
+// Coefficients are plain values, so updating them never allocates, and they
+// can glide from one set to the next across a block. Gliding is safe: the
+// stable (a1, a2) pairs form a triangle, so every point on a straight line
+// between two stable sections is stable too.
+class BiquadCascade
+{
+public:
+  static constexpr int maxSections = 64;
+  static constexpr int maxChannels = 2;
+
+  // Normalized so a0 is 1
+  struct Coefficients
+  {
+    double b0 = 1.0;
+    double b1 = 0.0;
+    double b2 = 0.0;
+    double a1 = 0.0;
+    double a2 = 0.0;
+
+    // From the {b0, b1, b2, a0, a1, a2} arrays of juce::dsp::IIR::ArrayCoefficients
+    static Coefficients fromArray(const std::array<double, 6> &raw)
+    {
+      const double scale = 1.0 / raw[3];
+      return {raw[0] * scale, raw[1] * scale, raw[2] * scale, raw[4] * scale, raw[5] * scale};
+    }
+
+    // Multiplies power[i] by the section's squared gain at angular frequency
+    // w[i], given cos(w[i]) and cos(2 w[i]). With those shared by every
+    // section the loop is a few multiply-adds and a divide per frequency, and
+    // vectorizes.
+    void multiplyPowerResponse(const double *cosW, const double *cos2W, double *power, int count) const
+    {
+      const double n0 = b0 * b0 + b1 * b1 + b2 * b2, n1 = 2.0 * (b0 * b1 + b1 * b2), n2 = 2.0 * b0 * b2;
+      const double d0 = 1.0 + a1 * a1 + a2 * a2, d1 = 2.0 * (a1 + a1 * a2), d2 = 2.0 * a2;
+
+      for (int i = 0; i < count; ++i)
+        power[i] *= (n0 + n1 * cosW[i] + n2 * cos2W[i]) / (d0 + d1 * cosW[i] + d2 * cos2W[i]);
+    }
+  };
+
+  // Clears every section's state
+  void reset();
+
+  // Replaces the chain with numSections sections. Section i carries on with the
+  // state and coefficients of old section previous[i], or starts from silence
+  // as a pass-through if that is -1.
+  void setLayout(const int *previous, int numSections);
+  int getNumSections() const { return numSections; }
+
+  // Jumps straight to new coefficients
+  void setCoefficients(int section, const Coefficients &coefficients);
+
+  // Filters with fixed coefficients
+  void process(juce::dsp::AudioBlock<float> &block);
+
+  // Filters while moving every section in a straight line to targets, one per
+  // section, which are reached on the block's last sample
+  void process(juce::dsp::AudioBlock<float> &block, const Coefficients *targets);
+
+private:
+  using Vector = juce::dsp::SIMDRegister<double>;
+  static constexpr int lanes = static_cast<int>(Vector::SIMDNumElements);
+  static_assert(lanes >= maxChannels, "A sample's channels must fit in one register");
+
+  // Samples are interleaved into this many frames at a time
+  static constexpr int chunkSize = 64;
+
+  struct Section
+  {
+    Vector b0, b1, b2, a1, a2; // The same value in every lane
+    Vector s1, s2;             // One state per channel
+  };
+
+  std::array<Section, maxSections> sections;
+  std::array<Section, maxSections> steps; // Per-sample coefficient change while gliding
+  int numSections = 0;
+
+  template <bool glide>
+  void processBlock(juce::dsp::AudioBlock<float> &block);
+
+  template <bool glide>
+  void processFrames(double *frames, int numFrames);
+
+  static Section makeSection(const Coefficients &coefficients);
+};
@@ -27,21 +27,11 @@ Chorus::Chorus()
                   std::make_unique<juce::AudioParameterFloat>(
                       "phase", "Phase", minPhase, maxPhase, defaultPhase)})
 {
-  rateParam = parameters.getRawParameterValue("rate");
-  depthParam = parameters.getRawParameterValue("depth");
-  delayParam = parameters.getRawParameterValue("delay");
-  mixParam = parameters.getRawParameterValue("mix");
-  phaseParam = parameters.getRawParameterValue("phase");
 }
 
 Chorus::~Chorus()
 {
   releaseResources();
-  rateParam = nullptr;
-  depthParam = nullptr;
-  delayParam = nullptr;
-  mixParam = nullptr;
-  phaseParam = nullptr;
 }
 
 void Chorus::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -57,6 +47,18 @@ void Chorus::prepareToPlay(double sampleRate, int samplesPerBlock)
   const int maxDelaySamples = static_cast<int>(maxDelayTimeMs * sampleRate / 1000.0);
   delayLine.setMaximumDelayInSamples(maxDelaySamples);
 
+  // Start the smoothers at the current values so playback doesn't open with a ramp
+  for (auto *smoother : {&rateSmoother, &depthSmoother, &delaySmoother, &mixSmoother, &phaseSmoother})
+    smoother->prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+
+  snapshot.update();
+  const auto &values = snapshot.get();
+  rateSmoother.setCurrentAndTarget(values.rate);
+  depthSmoother.setCurrentAndTarget(values.depth);
+  delaySmoother.setCurrentAndTarget(values.delay);
+  mixSmoother.setCurrentAndTarget(values.mix);
+  phaseSmoother.setCurrentAndTarget(values.phase);
+
   // Reset processing state
   reset();
   isInitialized = true;
@@ -98,38 +100,48 @@ void Chorus::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &mi
     return; // Pass through audio unchanged when bypassed
   }
 
-  // Safely get parameter values at the start of the block
-  const float rate = rateParam != nullptr ? rateParam->load() : defaultRate;
-  const float depth = depthParam != nullptr ? depthParam->load() : defaultDepth;
-  const float delay = delayParam != nullptr ? delayParam->load() : defaultDelay;
-  const float mix = mixParam != nullptr ? mixParam->load() : defaultMix;
-  const float phase = phaseParam != nullptr ? phaseParam->load() : defaultPhase;
+  // Get parameter values once at the start of the block
+  snapshot.update();
+  const auto &values = snapshot.get();
 
   const int numChannels = buffer.getNumChannels();
   const int numSamples = buffer.getNumSamples();
 
+  // Ramp towards the new values over the block
+  rateSmoother.setTarget(values.rate);
+  depthSmoother.setTarget(values.depth);
+  delaySmoother.setTarget(values.delay);
+  mixSmoother.setTarget(values.mix);
+  phaseSmoother.setTarget(values.phase);
+
+  const auto rateValues = rateSmoother.processBlock(numSamples);
+  const auto depthValues = depthSmoother.processBlock(numSamples);
+  const auto delayValues = delaySmoother.processBlock(numSamples);
+  const auto mixValues = mixSmoother.processBlock(numSamples);
+  const auto phaseValues = phaseSmoother.processBlock(numSamples);
+
   // Process each channel
   for (int channel = 0; channel < numChannels; ++channel)
   {
     auto *channelData = buffer.getWritePointer(channel);
-    float phaseOffset = (channel == 1) ? phase : 0.0f; // Apply phase offset to right channel
 
     for (int sample = 0; sample < numSamples; ++sample)
     {
       const float in = channelData[sample];
+      const float phaseOffset = (channel == 1) ? phaseValues[sample] : 0.0f; // Apply phase offset to right channel
 
       // Calculate LFO value
       float lfoValue = std::sin(2.0f * M_PI * (lfoPhase + phaseOffset / 360.0f));
-      float delayTime = delay + (depth * lfoValue);
+      float delayTime = delayValues[sample] + (depthValues[sample] * lfoValue);
 
       // Process the sample
       float processed = processChannel(in, channel, delayTime);
 
       // Mix dry and wet signals
-      channelData[sample] = in * (1.0f - mix) + processed * mix;
+      channelData[sample] = in * (1.0f - mixValues[sample]) + processed * mixValues[sample];
 
       // Update LFO phase
-      lfoPhase += rate / currentSampleRate;
+      lfoPhase += rateValues[sample] / currentSampleRate;
       if (lfoPhase >= 1.0f)
         lfoPhase -= 1.0f;
     }
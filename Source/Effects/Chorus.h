@@ -11,6 +11,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
 
 class Chorus : public juce::AudioProcessor
 {
@@ -20,7 +22,7 @@ public:
 
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
-  void reset();
+  void reset() override;
 
   void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
   float processChannel(float input, int channel, float delayTime);
@@ -28,7 +30,7 @@ public:
   juce::AudioProcessorEditor *createEditor() override;
   bool hasEditor() const override { return true; }
 
-  const juce::String getName() const override { return JucePlugin_Name; }
+  const juce::String getName() const override { return "Chorus"; }
 
   bool acceptsMidi() const override { return false; }
   bool producesMidi() const override { return false; }
@@ -38,6 +40,9 @@ public:
   bool isBypassed() const { return bypassed; }
   void setBypassed(bool shouldBeBypassed) { bypassed = shouldBeBypassed; }
 
+  // Where the rack's morph writes this effect's parameters
+  ParameterOverrides &getParameterOverrides() { return snapshot; }
+
   int getNumPrograms() override { return 1; }
   int getCurrentProgram() override { return 0; }
   void setCurrentProgram(int index) override {}
@@ -48,26 +53,36 @@ public:
   void setStateInformation(const void *data, int sizeInBytes) override;
 
   // Parameter access methods with bounds checking
-  float getRate() const { return rateParam != nullptr ? rateParam->load() : defaultRate; }
-  float getDepth() const { return depthParam != nullptr ? depthParam->load() : defaultDepth; }
-  float getDelay() const { return delayParam != nullptr ? delayParam->load() : defaultDelay; }
-  float getMix() const { return mixParam != nullptr ? mixParam->load() : defaultMix; }
-  float getPhase() const { return phaseParam != nullptr ? phaseParam->load() : defaultPhase; }
+  float getRate() const { return snapshot.load(&ParameterValues::rate); }
+  float getDepth() const { return snapshot.load(&ParameterValues::depth); }
+  float getDelay() const { return snapshot.load(&ParameterValues::delay); }
+  float getMix() const { return snapshot.load(&ParameterValues::mix); }
+  float getPhase() const { return snapshot.load(&ParameterValues::phase); }
 
   // Audio processor value tree
   juce::AudioProcessorValueTreeState parameters;
 
 private:
-  // Parameter pointers
-  std::atomic<float> *rateParam = nullptr;  // LFO rate (Hz)
-  std::atomic<float> *depthParam = nullptr; // Modulation depth
-  std::atomic<float> *delayParam = nullptr; // Center delay time
-  std::atomic<float> *mixParam = nullptr;   // Wet/dry mix
-  std::atomic<float> *phaseParam = nullptr; // Stereo phase offset
+  // Parameter values, loaded once per block
+  struct alignas(64) ParameterValues
+  {
+    float rate;  // LFO rate (Hz)
+    float depth; // Modulation depth
+    float delay; // Center delay time
+    float mix;   // Wet/dry mix
+    float phase; // Stereo phase offset
+  };
+  ParameterSnapshot<ParameterValues> snapshot{parameters, {"rate", "depth", "delay", "mix", "phase"}};
 
   // Processing state
   juce::dsp::DelayLine<float> delayLine;
   float lfoPhase = 0.0f;
+
+  ParameterSmoother rateSmoother;
+  ParameterSmoother depthSmoother;
+  ParameterSmoother delaySmoother;
+  ParameterSmoother mixSmoother;
+  ParameterSmoother phaseSmoother;
   double currentSampleRate = 0.0; // Initialize to 0 to indicate not set
   bool isInitialized = false;
   bool filtersNeedUpdate = true;
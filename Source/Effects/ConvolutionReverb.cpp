@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.cpp
+    Created: 18 Oct 2026 6:02:41pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "ConvolutionReverb.h"
+
+namespace
+{
+  const juce::Identifier impulseResponseId("impulseResponse");
+
+  constexpr float minMix = 0.0f;
+  constexpr float maxMix = 1.0f;
+  constexpr float minGain = 0.0f;
+  constexpr float maxOutputGain = 2.0f;
+
+  // Decaying stereo noise, so the effect does something before a file is loaded
+  juce::AudioBuffer<float> createDefaultImpulseResponse(double sampleRate)
+  {
+    constexpr double lengthSeconds = 2.5;
+    constexpr double decaySeconds = 2.0; // Time to fall by 60 dB
+    constexpr double fadeInSeconds = 0.005;
+
+    const int length = static_cast<int>(lengthSeconds * sampleRate);
+    juce::AudioBuffer<float> impulseResponse(2, length);
+    juce::Random random(1234);
+
+    for (int channel = 0; channel < impulseResponse.getNumChannels(); ++channel)
+    {
+      float *samples = impulseResponse.getWritePointer(channel);
+      for (int i = 0; i < length; ++i)
+      {
+        const double time = i / sampleRate;
+        const double envelope = std::exp(-6.9078 * time / decaySeconds) * juce::jmin(1.0, time / fadeInSeconds);
+        samples[i] = static_cast<float>(envelope * (random.nextDouble() * 2.0 - 1.0));
+      }
+    }
+
+    return impulseResponse;
+  }
+}
+
+ConvolutionReverb::ConvolutionReverb()
+    : AudioProcessor(BusesProperties()
+                         .withInput("Input", juce::AudioChannelSet::stereo(), true)
+                         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
+      parameters(*this, nullptr, juce::Identifier("ConvolutionParameters"),
+                 {std::make_unique<juce::AudioParameterFloat>(
+                      "mix",         // parameterID
+                      "Dry/Wet Mix", // parameter name
+                      minMix,        // minimum value
+                      maxMix,        // maximum value
+                      0.35f          // default value
+                      ),
+                  std::make_unique<juce::AudioParameterFloat>(
+                      "outputGain",   // parameterID
+                      "Output Level", // parameter name
+                      minGain,        // minimum value
+                      maxOutputGain,  // maximum value
+                      1.0f            // default value
+                      )})
+{
+  setLatencySamples(convolver.getLatencySamples());
+  useDefaultImpulseResponse();
+  startTimerHz(10);
+}
+
+ConvolutionReverb::~ConvolutionReverb()
+{
+  stopTimer();
+}
+
+void ConvolutionReverb::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+  currentSampleRate = sampleRate;
+  wetBuffer.setSize(2, samplesPerBlock);
+  convolver.prepare(sampleRate, 2, maxImpulseResponseSeconds);
+
+  // Start the smoothers at the current values so playback doesn't open with a ramp
+  mixSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+  outputGainSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+
+  snapshot.update();
+  const auto &values = snapshot.get();
+  mixSmoother.setCurrentAndTarget(juce::jlimit(minMix, maxMix, values.mix));
+  outputGainSmoother.setCurrentAndTarget(juce::jlimit(minGain, maxOutputGain, values.outputGain));
+
+  // The response has to be prepared for the new rate. An offline render can't
+  // start without it, so that waits for it here.
+  updateImpulseResponse(isNonRealtime());
+}
+
+void ConvolutionReverb::releaseResources()
+{
+  convolver.reset();
+}
+
+void ConvolutionReverb::reset()
+{
+  // Runs on the audio thread when a rack is switched in, so it must not wait
+  // for the tail worker
+  convolver.resetWithoutWaiting();
+}
+
+void ConvolutionReverb::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+  juce::ScopedNoDenormals noDenormals;
+
+  const int numSamples = buffer.getNumSamples();
+  const int numChannels = juce::jmin(buffer.getNumChannels(), wetBuffer.getNumChannels());
+  if (wetBuffer.getNumSamples() == 0)
+    return;
+
+  snapshot.update();
+  const auto &values = snapshot.get();
+  mixSmoother.setTarget(juce::jlimit(minMix, maxMix, values.mix));
+  outputGainSmoother.setTarget(juce::jlimit(minGain, maxOutputGain, values.outputGain));
+
+  // Keep convolving while bypassed, so the dry signal keeps the same latency
+  // and the tail is already running when the effect comes back
+  const bool isBypassed = bypassed;
+  if (isBypassed)
+  {
+    mixSmoother.skip(numSamples);
+    outputGainSmoother.skip(numSamples);
+  }
+
+  const auto mix = isBypassed ? ParameterSmoother::Block{} : mixSmoother.processBlock(numSamples);
+  const auto outputGain = isBypassed ? ParameterSmoother::Block{} : outputGainSmoother.processBlock(numSamples);
+
+  for (int start = 0; start < numSamples; start += wetBuffer.getNumSamples())
+  {
+    const int count = juce::jmin(wetBuffer.getNumSamples(), numSamples - start);
+    convolver.process(buffer, wetBuffer, start, count, isNonRealtime());
+
+    if (isBypassed)
+      continue;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+      float *channelData = buffer.getWritePointer(channel, start);
+      const float *wetData = wetBuffer.getReadPointer(channel);
+
+      for (int sample = 0; sample < count; ++sample)
+      {
+        const float wetDry = mix[start + sample];
+        channelData[sample] = (channelData[sample] * (1.0f - wetDry) + wetData[sample] * wetDry) * outputGain[start + sample];
+      }
+    }
+  }
+}
+
+juce::AudioProcessorEditor *ConvolutionReverb::createEditor()
+{
+  return new juce::GenericAudioProcessorEditor(*this);
+}
+
+void ConvolutionReverb::getStateInformation(juce::MemoryBlock &destData)
+{
+  auto state = parameters.copyState();
+  std::unique_ptr<juce::XmlElement> xml(state.createXml());
+  copyXmlToBinary(*xml, destData);
+}
+
+void ConvolutionReverb::setStateInformation(const void *data, int sizeInBytes)
+{
+  try
+  {
+    std::unique_ptr<juce::XmlElement> xmlState(getXmlFromBinary(data, sizeInBytes));
+
+    if (xmlState != nullptr && xmlState->hasTagName(parameters.state.getType()))
+    {
+      parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+
+      // The state only stores where the response came from
+      const juce::File file(parameters.state.getProperty(impulseResponseId).toString());
+      if (!file.existsAsFile() || !loadImpulseResponse(file))
+        useDefaultImpulseResponse();
+    }
+  }
+  catch (...)
+  {
+    // If state restoration fails, fall back to the built-in response
+    useDefaultImpulseResponse();
+  }
+}
+
+bool ConvolutionReverb::loadImpulseResponse(const juce::File &file)
+{
+  auto loaded = cache->loadFile(file);
+  if (loaded == nullptr)
+    return false;
+
+  parameters.state.setProperty(impulseResponseId, file.getFullPathName(), nullptr);
+  setSource(std::move(loaded));
+  return true;
+}
+
+void ConvolutionReverb::useDefaultImpulseResponse()
+{
+  constexpr double defaultSampleRate = 48000.0;
+
+  parameters.state.removeProperty(impulseResponseId, nullptr);
+  setSource(cache->loadBuffer(createDefaultImpulseResponse(defaultSampleRate), defaultSampleRate));
+}
+
+juce::String ConvolutionReverb::getImpulseResponseName() const
+{
+  const auto path = parameters.state.getProperty(impulseResponseId).toString();
+  return path.isEmpty() ? juce::String("Default Hall") : juce::File(path).getFileNameWithoutExtension();
+}
+
+void ConvolutionReverb::setSource(std::shared_ptr<const ImpulseResponseCache::Source> newSource)
+{
+  {
+    const juce::ScopedLock sl(sourceLock);
+    source = std::move(newSource);
+  }
+
+  updateImpulseResponse(false);
+}
+
+void ConvolutionReverb::updateImpulseResponse(bool waitUntilReady)
+{
+  const juce::ScopedLock sl(sourceLock);
+
+  if (currentSampleRate <= 0.0 || source == nullptr)
+    return;
+
+  // Until the new response is ready the convolver keeps playing the old one
+  auto response = cache->getResponse(source, currentSampleRate, waitUntilReady);
+  responsePending = response == nullptr;
+
+  if (response != nullptr)
+    convolver.setImpulseResponse(std::move(response));
+}
+
+void ConvolutionReverb::timerCallback()
+{
+  // Free responses the audio thread has swapped out
+  convolver.collectGarbage();
+
+  if (responsePending)
+    updateImpulseResponse(false);
+}
@@ -0,0 +1,116 @@
+/*
+  ==============================================================================
+
+    ConvolutionReverb.h
+    Created: 18 Oct 2026 6:02:41pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ImpulseResponseCache.h"
+#include "PartitionedConvolver.h"
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
+
+// Reverb from a recorded impulse response, for rooms and halls the algorithmic
+// Reverb can't model. Responses up to maxImpulseResponseSeconds long are
+// convolved by a PartitionedConvolver, which adds one head block of latency.
+// Responses come from the shared ImpulseResponseCache, so instances using the
+// same file share one copy of it.
+class ConvolutionReverb : public juce::AudioProcessor,
+                          private juce::Timer
+{
+public:
+  ConvolutionReverb();
+  ~ConvolutionReverb() override;
+
+  // AudioProcessor methods
+  void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+  void releaseResources() override;
+  void reset() override;
+  void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+
+  // Plugin methods
+  const juce::String getName() const override { return "Convolution"; }
+  bool acceptsMidi() const override { return false; }
+  bool producesMidi() const override { return false; }
+  bool isMidiEffect() const override { return false; }
+  double getTailLengthSeconds() const override { return maxImpulseResponseSeconds; }
+
+  bool isBypassed() const { return bypassed; }
+  void setBypassed(bool shouldBeBypassed) { bypassed = shouldBeBypassed; }
+
+  // Where the rack's morph writes this effect's parameters
+  ParameterOverrides &getParameterOverrides() { return snapshot; }
+
+  // Editor methods
+  bool hasEditor() const override { return true; }
+  juce::AudioProcessorEditor *createEditor() override;
+
+  // Program methods
+  int getNumPrograms() override { return 1; }
+  int getCurrentProgram() override { return 0; }
+  void setCurrentProgram(int) override {}
+  const juce::String getProgramName(int) override { return {}; }
+  void changeProgramName(int, const juce::String &) override {}
+
+  // Bus layout methods
+  bool isBusesLayoutSupported(const BusesLayout &layouts) const override
+  {
+    // Only support stereo
+    return layouts.getMainOutputChannelSet() == juce::AudioChannelSet::stereo() &&
+           layouts.getMainInputChannelSet() == juce::AudioChannelSet::stereo();
+  }
+
+  // State management
+  void getStateInformation(juce::MemoryBlock &destData) override;
+  void setStateInformation(const void *data, int sizeInBytes) override;
+
+  // Impulse response. Loading maps and hashes the file on the calling thread,
+  // so call from the message thread; it is prepared for the current sample
+  // rate in the background. Returns false if it can't be read.
+  bool loadImpulseResponse(const juce::File &file);
+  void useDefaultImpulseResponse();
+  juce::String getImpulseResponseName() const;
+
+  static constexpr double maxImpulseResponseSeconds = ImpulseResponseCache::maximumSeconds;
+
+  juce::AudioProcessorValueTreeState parameters;
+
+private:
+  // Parameter values, loaded once per block
+  struct alignas(64) ParameterValues
+  {
+    float mix;
+    float outputGain;
+  };
+  ParameterSnapshot<ParameterValues> snapshot{parameters, {"mix", "outputGain"}};
+
+  ParameterSmoother mixSmoother;
+  ParameterSmoother outputGainSmoother{ParameterSmoother::Ramp::Multiplicative};
+
+  PartitionedConvolver convolver;
+  juce::AudioBuffer<float> wetBuffer;
+  std::atomic<bool> bypassed{false};
+
+  juce::SharedResourcePointer<ImpulseResponseCache> cache;
+
+  // The response as loaded, at its own sample rate. Kept so it can be
+  // prepared again when the host's rate changes.
+  juce::CriticalSection sourceLock;
+  std::shared_ptr<const ImpulseResponseCache::Source> source;
+  double currentSampleRate = 0.0;
+  std::atomic<bool> responsePending{false}; // The cache is still building the response
+
+  // Hands the source, prepared for the current rate, to the convolver, or
+  // leaves responsePending set for the timer to try again
+  void updateImpulseResponse(bool waitUntilReady);
+  void setSource(std::shared_ptr<const ImpulseResponseCache::Source> newSource);
+  void timerCallback() override;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
@@ -37,17 +37,11 @@ Delay::Delay()
                       0.5f           // default value
                       )})
 {
-  delayTimeParam = parameters.getRawParameterValue("delayTime");
-  feedbackParam = parameters.getRawParameterValue("feedback");
-  mixParam = parameters.getRawParameterValue("mix");
 }
 
 Delay::~Delay()
 {
   releaseResources();
-  delayTimeParam = nullptr;
-  feedbackParam = nullptr;
-  mixParam = nullptr;
 }
 
 void Delay::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -57,11 +51,26 @@ void Delay::prepareToPlay(double sampleRate, int samplesPerBlock)
   delayLine.setMaximumDelayInSamples(static_cast<int>(sampleRate * 2.0)); // Max 2 seconds delay
 
   // Initialize delay time
-  const float initialDelayTime = delayTimeParam != nullptr ? delayTimeParam->load() : 0.5f;
-  delayLine.setDelay(static_cast<int>(initialDelayTime * sampleRate));
+  snapshot.update();
+  const auto &values = snapshot.get();
+  delayLine.setDelay(static_cast<float>(values.delayTime * sampleRate));
+
+  // Start the smoothers at the current values so playback doesn't open with a ramp
+  delayTimeSmoother.prepare(sampleRate, delayTimeRampSeconds, samplesPerBlock);
+  feedbackSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+  mixSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+
+  delayTimeSmoother.setCurrentAndTarget(static_cast<float>(values.delayTime * sampleRate));
+  feedbackSmoother.setCurrentAndTarget(values.feedback);
+  mixSmoother.setCurrentAndTarget(values.mix);
 }
 
 void Delay::releaseResources()
+{
+  reset();
+}
+
+void Delay::reset()
 {
   // Clear the delay line
   delayLine.reset();
@@ -86,24 +95,21 @@ void Delay::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &mid
     return;
   }
 
-  // Safely get parameter values at the start of the block
-  const float delayTime = delayTimeParam != nullptr ? delayTimeParam->load() : 0.5f;
-  const float feedback = feedbackParam != nullptr ? feedbackParam->load() : 0.4f;
-  const float mix = mixParam != nullptr ? mixParam->load() : 0.5f;
+  // Get parameter values once at the start of the block
+  snapshot.update();
+  const auto &values = snapshot.get();
 
   const int numChannels = buffer.getNumChannels();
   const int numSamples = buffer.getNumSamples();
 
-  // Calculate new delay time in samples
-  const int newDelaySamples = static_cast<int>(delayTime * currentSampleRate);
+  // Ramp towards the new values; the delay line reads between samples while the time moves
+  delayTimeSmoother.setTarget(static_cast<float>(values.delayTime * currentSampleRate));
+  feedbackSmoother.setTarget(values.feedback);
+  mixSmoother.setTarget(values.mix);
 
-  // Only update delay time if it has changed significantly (more than 1 sample)
-  if (std::abs(newDelaySamples - delayLine.getDelay()) > 1)
-  {
-    // Clear the delay line and set new delay time
-    delayLine.reset();
-    delayLine.setDelay(newDelaySamples);
-  }
+  const auto delaySamples = delayTimeSmoother.processBlock(numSamples);
+  const auto feedbackValues = feedbackSmoother.processBlock(numSamples);
+  const auto mixValues = mixSmoother.processBlock(numSamples);
 
   // Process each channel
   for (int channel = 0; channel < numChannels; ++channel)
@@ -113,13 +119,13 @@ void Delay::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &mid
     for (int sample = 0; sample < numSamples; ++sample)
     {
       const float in = channelData[sample];
-      float delayedSample = delayLine.popSample(channel);
+      float delayedSample = delayLine.popSample(channel, delaySamples[sample]);
 
       // Push the input + feedback to the delay line
-      delayLine.pushSample(channel, in + (delayedSample * feedback));
+      delayLine.pushSample(channel, in + (delayedSample * feedbackValues[sample]));
 
       // Mix the dry and wet signals
-      channelData[sample] = in * (1.0f - mix) + delayedSample * mix;
+      channelData[sample] = in * (1.0f - mixValues[sample]) + delayedSample * mixValues[sample];
     }
   }
 }
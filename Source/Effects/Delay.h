@@ -11,6 +11,8 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
 
 class Delay : public juce::AudioProcessor
 {
@@ -20,6 +22,7 @@ public:
 
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
+  void reset() override;
   void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
 
   juce::AudioProcessorEditor *createEditor() override;
@@ -35,6 +38,9 @@ public:
   bool isBypassed() const { return bypassed; }
   void setBypassed(bool shouldBeBypassed) { bypassed = shouldBeBypassed; }
 
+  // Where the rack's morph writes this effect's parameters
+  ParameterOverrides &getParameterOverrides() { return snapshot; }
+
   int getNumPrograms() override { return 1; }
   int getCurrentProgram() override { return 0; }
   void setCurrentProgram(int) override {}
@@ -46,11 +52,22 @@ public:
   juce::AudioProcessorValueTreeState parameters;
 
 private:
-  std::atomic<float> *delayTimeParam = nullptr;
-  std::atomic<float> *feedbackParam = nullptr;
-  std::atomic<float> *mixParam = nullptr;
+  // Parameter values, loaded once per block
+  struct alignas(64) ParameterValues
+  {
+    float delayTime; // Seconds
+    float feedback;
+    float mix;
+  };
+  ParameterSnapshot<ParameterValues> snapshot{parameters, {"delayTime", "feedback", "mix"}};
 
   juce::dsp::DelayLine<float> delayLine;
+
+  // Delay time glides in samples rather than jumping, which would click
+  ParameterSmoother delayTimeSmoother;
+  ParameterSmoother feedbackSmoother;
+  ParameterSmoother mixSmoother;
+  static constexpr double delayTimeRampSeconds = 0.05;
   double currentSampleRate = 0.0;                     // Initialize to 0 to indicate not set
   static constexpr double MIN_SAMPLE_RATE = 8000.0;   // Minimum valid sample rate
   static constexpr double MAX_SAMPLE_RATE = 192000.0; // Maximum valid sample rate
@@ -11,6 +11,14 @@
 #include "Distortion.h"
 #include <memory>
 
+namespace
+{
+  const juce::Identifier transferCurveId("TRANSFER_CURVE");
+  const juce::Identifier pointId("POINT");
+  const juce::Identifier xId("x");
+  const juce::Identifier yId("y");
+}
+
 Distortion::Distortion()
     : AudioProcessor(BusesProperties()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
@@ -45,27 +53,48 @@ Distortion::Distortion()
                       1.0f            // default value
                       ),
                   std::make_unique<juce::AudioParameterChoice>(
-                      "type",                                                                          // parameterID
-                      "Distortion Type",                                                               // parameter name
-                      juce::StringArray("Soft Clip", "Hard Clip", "Fold", "Bit Crush", "Sample Rate"), // choices
-                      0                                                                                // default choice
-                      )})
+                      "type",                                                                                    // parameterID
+                      "Distortion Type",                                                                         // parameter name
+                      juce::StringArray("Soft Clip", "Hard Clip", "Fold", "Bit Crush", "Sample Rate", "Custom"), // choices
+                      0                                                                                          // default choice
+                      ),
+                  std::make_unique<juce::AudioParameterChoice>(
+                      "antialiasing",                                                      // parameterID
+                      "Anti-Aliasing",                                                     // parameter name
+                      juce::StringArray("Off", "ADAA 1st Order", "ADAA 2nd Order", "4x"), // choices
+                      0                                                                    // default choice
+                      ),
+                  std::make_unique<juce::AudioParameterInt>(
+                      "bits",      // parameterID
+                      "Bit Depth", // parameter name
+                      minBits,     // minimum value
+                      maxBits,     // maximum value
+                      defaultBits  // default value
+                      ),
+                  std::make_unique<juce::AudioParameterFloat>(
+                      "reduction",                                                // parameterID
+                      "Rate Reduction",                                           // parameter name
+                      juce::NormalisableRange<float>(minReduction, maxReduction), // range
+                      defaultReduction                                            // default value
+                      ),
+                  std::make_unique<juce::AudioParameterChoice>(
+                      "curveInterpolation",                 // parameterID
+                      "Curve Interpolation",                // parameter name
+                      juce::StringArray("Linear", "Cubic"), // choices
+                      1                                     // default choice
+                      )}),
+      oversampler(std::make_unique<juce::dsp::Oversampling<float>>(
+          maxChannels, 2, juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple, true, true))
 {
-  driveParam = parameters.getRawParameterValue("drive");
-  rangeParam = parameters.getRawParameterValue("range");
-  mixParam = parameters.getRawParameterValue("mix");
-  outputGainParam = parameters.getRawParameterValue("outputGain");
-  typeParam = parameters.getRawParameterValue("type");
+  // Start the custom curve as a straight line
+  setTransferCurve({{-1.0f, -1.0f}, {1.0f, 1.0f}});
+  startTimerHz(10);
 }
 
 Distortion::~Distortion()
 {
+  stopTimer();
   releaseResources();
-  driveParam = nullptr;
-  rangeParam = nullptr;
-  mixParam = nullptr;
-  outputGainParam = nullptr;
-  typeParam = nullptr;
 }
 
 void Distortion::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -73,9 +102,26 @@ void Distortion::prepareToPlay(double sampleRate, int samplesPerBlock)
   // Store sample rate for potential future use
   currentSampleRate = sampleRate;
 
-  // Precompute max value for BitCrush
-  const float bitDepth = 8.0f; // 8-bit reduction
-  bitCrushMaxValue = std::pow(2.0f, bitDepth) - 1.0f;
+  // Prepare the oversampling path and the dry delay that keeps it aligned
+  oversampler->initProcessing(static_cast<size_t>(samplesPerBlock));
+  oversamplingLatency = static_cast<int>(std::ceil(oversampler->getLatencyInSamples()));
+
+  dryDelay.prepare({sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(maxChannels)});
+  dryDelay.setMaximumDelayInSamples(juce::jmax(1, oversamplingLatency));
+  dryDelay.setDelay(static_cast<float>(oversamplingLatency));
+  dryBuffer.setSize(maxChannels, samplesPerBlock);
+  shapedBuffer.setSize(1, samplesPerBlock);
+
+  // Start the smoothers at the current values so playback doesn't open with a ramp
+  for (auto *smoother : {&driveSmoother, &rangeSmoother, &mixSmoother, &outputGainSmoother})
+    smoother->prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+
+  snapshot.update();
+  const auto &values = snapshot.get();
+  driveSmoother.setCurrentAndTarget(juce::jlimit(minDrive, maxDrive, values.drive));
+  rangeSmoother.setCurrentAndTarget(juce::jlimit(minRange, maxRange, values.range));
+  mixSmoother.setCurrentAndTarget(juce::jlimit(minMix, maxMix, values.mix));
+  outputGainSmoother.setCurrentAndTarget(juce::jlimit(minGain, maxOutputGain, values.outputGain));
 
   // Reset any processing state if needed
   reset();
@@ -91,54 +137,172 @@ void Distortion::reset()
 {
   // Clear any processing state
   lastSampleRate = 0.0;
+  resetShapers();
+  for (auto &decimator : decimators)
+    decimator.reset();
+  oversampler->reset();
+  dryDelay.reset();
 }
 
-float Distortion::processSample(float sample, float drive, float range)
+void Distortion::setTransferCurve(const juce::Array<juce::Point<float>> &points)
 {
-  // Ensure drive and range are within valid bounds
-  drive = std::max(1.0f, std::min(drive, 25.0f));
-  range = std::max(0.0f, std::min(range, 1.0f));
+  juce::Array<juce::Point<float>> sorted;
+  for (const auto &point : points)
+    sorted.add({juce::jlimit(-1.0f, 1.0f, point.x), juce::jlimit(-1.0f, 1.0f, point.y)});
 
-  float input = sample * drive;
-  float processed = 0.0f;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b)
+                   { return a.x < b.x; });
+
+  juce::ValueTree curve(transferCurveId);
+  for (const auto &point : sorted)
+    curve.appendChild(juce::ValueTree(pointId, {{xId, point.x}, {yId, point.y}}), nullptr);
+
+  auto existing = parameters.state.getChildWithName(transferCurveId);
+  if (existing.isValid())
+    parameters.state.removeChild(existing, nullptr);
+  parameters.state.appendChild(curve, nullptr);
+
+  rebuildTransferTable();
+}
+
+juce::Array<juce::Point<float>> Distortion::getTransferCurve() const
+{
+  juce::Array<juce::Point<float>> points;
+
+  for (const auto &point : parameters.state.getChildWithName(transferCurveId))
+    points.add({static_cast<float>(point.getProperty(xId)), static_cast<float>(point.getProperty(yId))});
+
+  return points;
+}
+
+void Distortion::rebuildTransferTable()
+{
+  auto points = getTransferCurve();
+
+  // Presets saved before the custom curve existed have no points, so fall back to a straight line
+  if (points.isEmpty())
+    points = {{-1.0f, -1.0f}, {1.0f, 1.0f}};
+
+  transferTable.publish(std::make_unique<Waveshapers::TransferTable>(points));
+}
+
+void Distortion::timerCallback()
+{
+  // Free tables the audio thread has swapped out
+  transferTable.collectGarbage();
+}
+
+void Distortion::resetShapers()
+{
+  for (auto &state : shapers)
+  {
+    state.softClip1.reset();
+    state.softClip2.reset();
+    state.hardClip1.reset();
+    state.hardClip2.reset();
+    state.fold1.reset();
+    state.fold2.reset();
+  }
+}
+
+// Hard clip threshold follows drive, from 1.0 at minimum drive down to 0.4 at maximum
+static float getHardClipLimit(float drive)
+{
+  const float normalizedDrive = (drive - 1.0f) / (25.0f - 1.0f);
+  return 1.0f - 0.6f * normalizedDrive;
+}
+
+void Distortion::updateShapers(const ParameterValues &values)
+{
+  // Quantization steps for BitCrush
+  const int bits = juce::jlimit(minBits, maxBits, juce::roundToInt(values.bits));
+  bitCrushMaxValue = static_cast<float>((1 << bits) - 1);
+
+  // Hold length for SampleRate
+  const float reduction = juce::jlimit(minReduction, maxReduction, values.reduction);
+  for (auto &decimator : decimators)
+    decimator.setReductionFactor(reduction);
+}
 
-  // Get current distortion type
-  int type = typeParam ? static_cast<int>(typeParam->load()) : 0;
+float Distortion::shapeSample(float input, float drive, DistortionType type, int channel)
+{
+  const bool useADAA = (activeAntialiasing == Antialiasing::ADAAFirst || activeAntialiasing == Antialiasing::ADAASecond) &&
+                       channel >= 0 && channel < maxChannels;
+  const bool secondOrder = activeAntialiasing == Antialiasing::ADAASecond;
 
-  switch (static_cast<DistortionType>(type))
+  switch (type)
   {
   case DistortionType::SoftClip:
   {
-    // Sigmoid function for soft clipping
-    float shape = 1.0f + 0.05f * drive;                      // tweak sensitivity
-    float shaped = 1.0f / (1.0f + std::exp(-shape * input)); // make the curve respond to the drive knob
-    processed = 2.0f * shaped - 1.0f;
-    break;
+    // Sigmoid soft clip, 2 / (1 + e^(-k * x)) - 1, which equals tanh(k * x / 2)
+    const float shape = 1.0f + 0.05f * drive; // make the curve respond to the drive knob
+    const float x = 0.5f * shape * input;
+
+    if (!useADAA)
+      return std::tanh(x);
+
+    auto &state = shapers[static_cast<size_t>(channel)];
+    return secondOrder ? state.softClip2.processSample(x) : state.softClip1.processSample(x);
   }
+
   case DistortionType::HardClip:
   {
-    // Dynamic hard clip thresholds based on drive
-    // Drive goes from 1.0 to 25.0
-    float normalizedDrive = (drive - 1.0f) / (25.0f - 1.0f); // 0 to 1
-    float clipLimit = 1.0f - 0.6f * normalizedDrive;         // From 1.0 down to 0.4
+    if (!useADAA)
+    {
+      const float clipLimit = getHardClipLimit(drive);
+      return std::clamp(input, -clipLimit, clipLimit);
+    }
 
-    processed = std::clamp(input, -clipLimit, clipLimit);
-    break;
+    // The limit follows the smoothed drive sample by sample, as above. While
+    // drive ramps, setCurve() re-derives the cached antiderivatives at the new
+    // limit, so the next difference is taken across one curve.
+    auto &state = shapers[static_cast<size_t>(channel)];
+    const Waveshapers::HardClipCurve hardClip{getHardClipLimit(drive)};
+    if (secondOrder)
+    {
+      state.hardClip2.setCurve(hardClip);
+      return state.hardClip2.processSample(input);
+    }
+
+    state.hardClip1.setCurve(hardClip);
+    return state.hardClip1.processSample(input);
   }
 
   case DistortionType::Fold:
-    // Symmetric wave folding implementation
-    {
-      float foldFactor = 2.0f; // Number of folds — can tie to drive
-      float x = input * foldFactor;
+  {
+    // Symmetric triangle folding with period 4, two folds per unit of input
+    const float foldFactor = 2.0f;
+    const float x = input * foldFactor;
 
-      processed = std::fmod(x + 3.0f, 4.0f); // keep in [0, 4]
-      if (processed >= 2.0f)
-        processed = 4.0f - processed; // reflect upper half
+    if (!useADAA)
+      return static_cast<float>(Waveshapers::FoldCurve{}.evaluate(x));
+
+    auto &state = shapers[static_cast<size_t>(channel)];
+    return secondOrder ? state.fold2.processSample(x) : state.fold1.processSample(x);
+  }
+
+  default:
+    return input;
+  }
+}
+
+float Distortion::processSample(float sample, float drive, float range, int channel)
+{
+  // Ensure drive and range are within valid bounds
+  drive = std::max(1.0f, std::min(drive, 25.0f));
+  range = std::max(0.0f, std::min(range, 1.0f));
+
+  float input = sample * drive;
+  float processed = 0.0f;
+
+  switch (activeType)
+  {
+  case DistortionType::SoftClip:
+  case DistortionType::HardClip:
+  case DistortionType::Fold:
+    processed = shapeSample(input, drive, activeType, channel);
+    break;
 
-      processed -= 1.0f; // center to [-1, 1]
-      break;
-    }
   case DistortionType::BitCrush:
     // Bit reduction implementation
     {
@@ -147,18 +311,15 @@ float Distortion::processSample(float sample, float drive, float range)
     break;
 
   case DistortionType::SampleRate:
-    // Sample rate reduction implementation
-    {
-      static float lastSample = 0.0f;
-      static int sampleCounter = 0;
-      const int reductionFactor = 4; // Reduce sample rate by factor of 4
-
-      if (sampleCounter % reductionFactor == 0)
-        lastSample = input;
+    // Sample-and-hold rate reduction with per-channel state
+    if (channel >= 0 && channel < maxChannels)
+      processed = decimators[static_cast<size_t>(channel)].processSample(input);
+    else
+      processed = input;
+    break;
 
-      processed = lastSample;
-      sampleCounter++;
-    }
+  case DistortionType::Custom:
+    processed = activeTable != nullptr ? activeTable->processSample(input, activeInterpolation) : input;
     break;
   }
 
@@ -182,18 +343,57 @@ void Distortion::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer
     return; // Pass through audio unchanged when bypassed
   }
 
-  // Check if parameters are valid
-  if (!driveParam || !rangeParam || !mixParam || !outputGainParam || !typeParam)
-    return;
+  // Get parameter values once at the start of the block
+  snapshot.update();
+  const auto &values = snapshot.get();
+
+  // Anti-aliasing state is only meaningful for the curve it was built with
+  const auto type = static_cast<DistortionType>(static_cast<int>(values.type));
+  const auto antialiasing = static_cast<Antialiasing>(static_cast<int>(values.antialiasing));
+  if (type != activeType || antialiasing != activeAntialiasing)
+  {
+    activeType = type;
+    activeAntialiasing = antialiasing;
+    reset();
+  }
+
+  // Pick up a newly drawn curve, if any
+  activeTable = transferTable.acquire();
+  activeInterpolation = static_cast<Waveshapers::TransferTable::Interpolation>(static_cast<int>(values.curveInterpolation));
 
   const int numChannels = buffer.getNumChannels();
   const int numSamples = buffer.getNumSamples();
 
-  // Get current parameter values with safe defaults if null
-  const float drive = driveParam ? driveParam->load() : 1.0f;
-  const float range = rangeParam ? rangeParam->load() : 0.8f;
-  const float mix = mixParam ? mixParam->load() : 1.0f;
-  const float outputGain = outputGainParam ? outputGainParam->load() : 1.0f;
+  // Ramp towards the current parameter values over the block
+  driveSmoother.setTarget(juce::jlimit(minDrive, maxDrive, values.drive));
+  rangeSmoother.setTarget(juce::jlimit(minRange, maxRange, values.range));
+  mixSmoother.setTarget(juce::jlimit(minMix, maxMix, values.mix));
+  outputGainSmoother.setTarget(juce::jlimit(minGain, maxOutputGain, values.outputGain));
+
+  const auto drive = driveSmoother.processBlock(numSamples);
+  const auto range = rangeSmoother.processBlock(numSamples);
+  const auto mix = mixSmoother.processBlock(numSamples);
+  const auto outputGain = outputGainSmoother.processBlock(numSamples);
+
+  // Bit crush and sample rate reduction alias by design and always run at the host rate
+  const bool isCurve = type == DistortionType::SoftClip || type == DistortionType::HardClip || type == DistortionType::Fold || type == DistortionType::Custom;
+  const bool oversampled = isCurve && antialiasing == Antialiasing::Oversample4x;
+  reportLatency(oversampled ? oversamplingLatency : 0);
+
+  if (oversampled && numSamples <= dryBuffer.getNumSamples())
+  {
+    processOversampled(buffer, drive, range, mix, outputGain);
+    return;
+  }
+
+  // The custom table is smoothed when it's built, so it takes the block path instead of ADAA
+  if (type == DistortionType::Custom && activeTable != nullptr && numSamples <= shapedBuffer.getNumSamples())
+  {
+    processCustom(buffer, drive, range, mix, outputGain);
+    return;
+  }
+
+  updateShapers(values);
 
   // Process each channel
   for (int channel = 0; channel < numChannels; ++channel)
@@ -203,12 +403,95 @@ void Distortion::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer
     for (int sample = 0; sample < numSamples; ++sample)
     {
       const float input = channelData[sample];
-      const float processed = processSample(input, drive, range);
+      const float processed = processSample(input, drive[sample], range[sample], channel);
+
+      // Mix dry and wet signals
+      const float wetDry = mix[sample];
+      channelData[sample] = (input * (1.0f - wetDry) + processed * wetDry) * outputGain[sample];
+    }
+  }
+}
+
+void Distortion::processOversampled(juce::AudioBuffer<float> &buffer, const ParameterSmoother::Block &drive, const ParameterSmoother::Block &range,
+                                    const ParameterSmoother::Block &mix, const ParameterSmoother::Block &outputGain)
+{
+  const int numChannels = juce::jmin(buffer.getNumChannels(), maxChannels);
+  const int numSamples = buffer.getNumSamples();
+
+  // Delay the dry signal by the oversampling filter latency
+  for (int channel = 0; channel < numChannels; ++channel)
+  {
+    const auto *input = buffer.getReadPointer(channel);
+    auto *dry = dryBuffer.getWritePointer(channel);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+      dryDelay.pushSample(channel, input[sample]);
+      dry[sample] = dryDelay.popSample(channel);
+    }
+  }
+
+  // Shape at 4x the host rate, holding each host-rate parameter value for its oversampled samples
+  juce::dsp::AudioBlock<float> block(buffer);
+  auto channelBlock = block.getSubsetChannelBlock(0, static_cast<size_t>(numChannels));
+  auto oversampledBlock = oversampler->processSamplesUp(channelBlock);
+  const int factor = static_cast<int>(oversampler->getOversamplingFactor());
+
+  for (size_t channel = 0; channel < oversampledBlock.getNumChannels(); ++channel)
+  {
+    auto *channelData = oversampledBlock.getChannelPointer(channel);
+
+    for (size_t sample = 0; sample < oversampledBlock.getNumSamples(); ++sample)
+    {
+      const int hostSample = static_cast<int>(sample) / factor;
+      channelData[sample] = processSample(channelData[sample], drive[hostSample], range[hostSample], static_cast<int>(channel));
+    }
+  }
+
+  oversampler->processSamplesDown(channelBlock);
+
+  // Mix dry and wet signals
+  for (int channel = 0; channel < numChannels; ++channel)
+  {
+    auto *channelData = buffer.getWritePointer(channel);
+    const auto *dry = dryBuffer.getReadPointer(channel);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+      channelData[sample] = (dry[sample] * (1.0f - mix[sample]) + channelData[sample] * mix[sample]) * outputGain[sample];
+  }
+}
+
+void Distortion::processCustom(juce::AudioBuffer<float> &buffer, const ParameterSmoother::Block &drive, const ParameterSmoother::Block &range,
+                               const ParameterSmoother::Block &mix, const ParameterSmoother::Block &outputGain)
+{
+  const int numSamples = buffer.getNumSamples();
+  auto *shaped = shapedBuffer.getWritePointer(0);
+
+  for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+  {
+    auto *channelData = buffer.getWritePointer(channel);
+
+    // Shape the whole block through the table in one pass
+    if (drive.isStatic())
+      juce::FloatVectorOperations::multiply(shaped, channelData, drive.value, numSamples);
+    else
+      juce::FloatVectorOperations::multiply(shaped, channelData, drive.values, numSamples);
+
+    activeTable->processBlock(shaped, shaped, numSamples, activeInterpolation);
+
+    for (int sample = 0; sample < numSamples; ++sample)
+    {
+      const float input = channelData[sample];
+      float processed = shaped[sample];
+
+      // Apply range control (blend between distorted and hard clipped)
+      if (range[sample] < 1.0f)
+      {
+        const float hardClipped = juce::jlimit(-1.0f, 1.0f, input * drive[sample]);
+        processed = processed * range[sample] + hardClipped * (1.0f - range[sample]);
+      }
 
-      // Mix dry and wet signals with safety bounds
-      const float wetDry = std::max(0.0f, std::min(mix, 1.0f));
-      const float gain = std::max(0.0f, std::min(outputGain, 2.0f));
-      channelData[sample] = (input * (1.0f - wetDry) + processed * wetDry) * gain;
+      channelData[sample] = (input * (1.0f - mix[sample]) + processed * mix[sample]) * outputGain[sample];
     }
   }
 }
@@ -234,6 +517,7 @@ void Distortion::setStateInformation(const void *data, int sizeInBytes)
     if (xmlState != nullptr && xmlState->hasTagName(parameters.state.getType()))
     {
       parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
+      rebuildTransferTable();
 
       // Reset processing state after parameter changes
       reset();
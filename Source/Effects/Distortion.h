@@ -11,18 +11,35 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-class Distortion : public juce::AudioProcessor
+#include "Waveshapers.h"
+#include "LatencyReporter.h"
+#include "LockFreeSwap.h"
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
+
+class Distortion : public juce::AudioProcessor,
+                   public LatencyReporter,
+                   private juce::Timer
 {
 public:
   // Add enum for distortion types
   enum class DistortionType
   {
-    SoftClip,  // Current tanh-based distortion
-    HardClip,  // Hard clipping
-    Fold,      // Wave folding
-    BitCrush,  // Bit reduction
-    SampleRate // Sample rate reduction
+    SoftClip,   // Current tanh-based distortion
+    HardClip,   // Hard clipping
+    Fold,       // Wave folding
+    BitCrush,   // Bit reduction
+    SampleRate, // Sample rate reduction
+    Custom      // User-drawn transfer curve
+  };
+
+  // How the curved modes are protected against aliasing
+  enum class Antialiasing
+  {
+    Off,          // Naive shaping at the host rate
+    ADAAFirst,    // First-order antiderivative anti-aliasing
+    ADAASecond,   // Second-order antiderivative anti-aliasing
+    Oversample4x  // Naive shaping at 4x the host rate
   };
 
   Distortion();
@@ -30,15 +47,15 @@ public:
 
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
-  void reset();
+  void reset() override;
 
   void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
-  float processSample(float sample, float drive, float range);
+  float processSample(float sample, float drive, float range, int channel);
 
   juce::AudioProcessorEditor *createEditor() override;
   bool hasEditor() const override { return true; }
 
-  const juce::String getName() const override { return JucePlugin_Name; }
+  const juce::String getName() const override { return "Distortion"; }
 
   bool acceptsMidi() const override { return false; }
   bool producesMidi() const override { return false; }
@@ -48,6 +65,9 @@ public:
   bool isBypassed() const { return bypassed; }
   void setBypassed(bool shouldBeBypassed) { bypassed = shouldBeBypassed; }
 
+  // Where the rack's morph writes this effect's parameters
+  ParameterOverrides &getParameterOverrides() { return snapshot; }
+
   int getNumPrograms() override { return 1; }
   int getCurrentProgram() override { return 0; }
   void setCurrentProgram(int index) override {}
@@ -58,21 +78,39 @@ public:
   void setStateInformation(const void *data, int sizeInBytes) override;
 
   // Parameter access methods with bounds checking
-  float getDrive() const { return driveParam != nullptr ? driveParam->load() : defaultDrive; }
-  float getRange() const { return rangeParam != nullptr ? rangeParam->load() : defaultRange; }
-  float getMix() const { return mixParam != nullptr ? mixParam->load() : defaultMix; }
-  float getOutputGain() const { return outputGainParam != nullptr ? outputGainParam->load() : defaultGain; }
+  float getDrive() const { return snapshot.load(&ParameterValues::drive); }
+  float getRange() const { return snapshot.load(&ParameterValues::range); }
+  float getMix() const { return snapshot.load(&ParameterValues::mix); }
+  float getOutputGain() const { return snapshot.load(&ParameterValues::outputGain); }
+  float getBits() const { return snapshot.load(&ParameterValues::bits); }
+  float getReduction() const { return snapshot.load(&ParameterValues::reduction); }
+  Waveshapers::TransferTable::Interpolation getCurveInterpolation() const { return static_cast<Waveshapers::TransferTable::Interpolation>(static_cast<int>(snapshot.load(&ParameterValues::curveInterpolation))); }
+  DistortionType getType() const { return static_cast<DistortionType>(static_cast<int>(snapshot.load(&ParameterValues::type))); }
+  Antialiasing getAntialiasing() const { return static_cast<Antialiasing>(static_cast<int>(snapshot.load(&ParameterValues::antialiasing))); }
+
+  // Custom transfer curve as control points sorted by x, with x and y in [-1, 1].
+  // Stored in the parameter state so it travels with presets. Message thread only.
+  void setTransferCurve(const juce::Array<juce::Point<float>> &points);
+  juce::Array<juce::Point<float>> getTransferCurve() const;
 
   // Audio processor value tree
   juce::AudioProcessorValueTreeState parameters;
 
 private:
-  // Parameter pointers
-  std::atomic<float> *driveParam = nullptr;
-  std::atomic<float> *rangeParam = nullptr;
-  std::atomic<float> *mixParam = nullptr;
-  std::atomic<float> *outputGainParam = nullptr;
-  std::atomic<float> *typeParam = nullptr; // New parameter for distortion type
+  // Parameter values, loaded once per block
+  struct alignas(64) ParameterValues
+  {
+    float drive;
+    float range;
+    float mix;
+    float outputGain;
+    float type;               // DistortionType index
+    float antialiasing;       // Antialiasing index
+    float bits;               // Bit depth for BitCrush
+    float reduction;          // Reduction factor for SampleRate
+    float curveInterpolation; // Table interpolation for Custom
+  };
+  ParameterSnapshot<ParameterValues> snapshot{parameters, {"drive", "range", "mix", "outputGain", "type", "antialiasing", "bits", "reduction", "curveInterpolation"}};
 
   // Processing state
   double currentSampleRate = 0.0; // Initialize to 0 to indicate not set
@@ -100,7 +138,63 @@ private:
   static constexpr float minGain = 0.0f;
   static constexpr float maxOutputGain = 2.0f;
   static constexpr float defaultGain = 1.0f;
-  // Bit crushing parameters
+
+  static constexpr int minBits = 1;
+  static constexpr int maxBits = 16;
+  static constexpr int defaultBits = 8;
+
+  static constexpr float minReduction = 1.0f;
+  static constexpr float maxReduction = 32.0f;
+  static constexpr float defaultReduction = 4.0f;
+
+  // Curve shaping, anti-aliased according to the current mode
+  float shapeSample(float input, float drive, DistortionType type, int channel);
+  void updateShapers(const ParameterValues &values);
+  void resetShapers();
+  void processOversampled(juce::AudioBuffer<float> &buffer, const ParameterSmoother::Block &drive, const ParameterSmoother::Block &range,
+                          const ParameterSmoother::Block &mix, const ParameterSmoother::Block &outputGain);
+  void processCustom(juce::AudioBuffer<float> &buffer, const ParameterSmoother::Block &drive, const ParameterSmoother::Block &range,
+                     const ParameterSmoother::Block &mix, const ParameterSmoother::Block &outputGain);
+
+  // Compiles the stored curve into a table and hands it to the audio thread
+  void rebuildTransferTable();
+  void timerCallback() override;
+
+  // Drive scales the signal, so it ramps by ratio
+  ParameterSmoother driveSmoother{ParameterSmoother::Ramp::Multiplicative};
+  ParameterSmoother rangeSmoother;
+  ParameterSmoother mixSmoother;
+  ParameterSmoother outputGainSmoother;
+
+  // Per-channel ADAA state, one set per curve
+  static constexpr int maxChannels = 2;
+  struct ShaperState
+  {
+    Waveshapers::FirstOrderADAA<Waveshapers::SoftClipCurve> softClip1;
+    Waveshapers::SecondOrderADAA<Waveshapers::SoftClipCurve> softClip2;
+    Waveshapers::FirstOrderADAA<Waveshapers::HardClipCurve> hardClip1;
+    Waveshapers::SecondOrderADAA<Waveshapers::HardClipCurve> hardClip2;
+    Waveshapers::FirstOrderADAA<Waveshapers::FoldCurve> fold1;
+    Waveshapers::SecondOrderADAA<Waveshapers::FoldCurve> fold2;
+  };
+  std::array<ShaperState, maxChannels> shapers;
+  std::array<Waveshapers::Decimator, maxChannels> decimators;
+  Antialiasing activeAntialiasing = Antialiasing::Off;
+  DistortionType activeType = DistortionType::SoftClip;
+
+  // 4x oversampling path; dry signal is delayed to stay aligned with the wet path
+  std::unique_ptr<juce::dsp::Oversampling<float>> oversampler;
+  juce::dsp::DelayLine<float> dryDelay;
+  juce::AudioBuffer<float> dryBuffer;
+  int oversamplingLatency = 0; // Reported while the curve is oversampled
+
+  // Custom curve table, built on the message thread and picked up once per block
+  LockFreeSwap<Waveshapers::TransferTable> transferTable;
+  const Waveshapers::TransferTable *activeTable = nullptr;
+  Waveshapers::TransferTable::Interpolation activeInterpolation = Waveshapers::TransferTable::Interpolation::Linear;
+  juce::AudioBuffer<float> shapedBuffer;
+
+  // Bit crushing quantization steps, refreshed from the bits parameter each block
   float bitCrushMaxValue = 255.0f;   // Default to 8-bit (2^8 - 1)
   std::atomic<bool> bypassed{false}; // Add bypass state
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Distortion)
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    EarlyReflections.cpp
+    Created: 18 Oct 2026 9:02:17pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "EarlyReflections.h"
+
+void EarlyReflections::prepare(double sampleRate, int maximumBlockSize)
+{
+  const double samplesPerMs = sampleRate / 1000.0;
+  maxPreDelay = static_cast<int>(std::ceil(maxPreDelaySeconds * sampleRate));
+
+  // Quieter the later they arrive, with alternating signs so they don't stack
+  // up into a tone, normalized so the reflections come out as loud as the input
+  for (size_t channel = 0; channel < taps.size(); ++channel)
+  {
+    const auto &times = channel == 0 ? leftTimes : rightTimes;
+    double energy = 0.0;
+
+    for (size_t k = 0; k < static_cast<size_t>(numTaps); ++k)
+    {
+      auto &tap = taps[channel][k];
+      const float sign = ((k + channel) & 1) != 0 ? -1.0f : 1.0f;
+
+      tap.delay = static_cast<int>(std::round(times[k] * samplesPerMs));
+      tap.channel = k % 3 == 2 ? static_cast<int>(1 - channel) : static_cast<int>(channel); // Every third from the far side
+      tap.gain = sign * static_cast<float>(1.0 - 0.7 * times[k] / times.back());
+      energy += static_cast<double>(tap.gain) * tap.gain;
+    }
+
+    for (auto &tap : taps[channel])
+      tap.gain *= static_cast<float>(1.0 / std::sqrt(energy));
+  }
+
+  // The oldest sample ever read, plus a block written ahead of it and the
+  // interpolation tap
+  const double lastReflection = juce::jmax(leftTimes.back(), rightTimes.back());
+  const int longest = maxPreDelay + static_cast<int>(std::ceil(lastReflection * samplesPerMs)) + 1;
+  const int length = juce::nextPowerOfTwo(longest + maximumBlockSize + 1);
+
+  for (auto &channel : line)
+    channel.assign(static_cast<size_t>(length), 0.0f);
+  mask = length - 1;
+
+  reset();
+}
+
+void EarlyReflections::reset()
+{
+  for (auto &channel : line)
+    std::fill(channel.begin(), channel.end(), 0.0f);
+  writeIndex = 0;
+}
+
+void EarlyReflections::process(float *left, float *right, float *earlyLeft, float *earlyRight,
+                               const ParameterSmoother::Block &preDelay, int numSamples)
+{
+  if (line[0].empty() || numSamples <= 0)
+    return;
+
+  // Write the whole block first, so even a zero delay reads the current input
+  const Channels output{left, right};
+  for (size_t channel = 0; channel < line.size(); ++channel)
+  {
+    const int first = juce::jmin(numSamples, mask + 1 - writeIndex);
+    std::copy(output[channel], output[channel] + first, line[channel].begin() + writeIndex);
+    std::copy(output[channel] + first, output[channel] + numSamples, line[channel].begin());
+  }
+
+  const Channels early{earlyLeft, earlyRight};
+  if (preDelay.isStatic())
+    processStatic(output, early, juce::jlimit(0, maxPreDelay, juce::roundToInt(preDelay.value)), numSamples);
+  else
+    processRamping(output, early, preDelay.values, numSamples);
+
+  writeIndex = (writeIndex + numSamples) & mask;
+}
+
+void EarlyReflections::processStatic(const Channels &output, const Channels &early, int preDelay, int numSamples) const
+{
+  const int start = writeIndex - preDelay;
+
+  for (size_t channel = 0; channel < line.size(); ++channel)
+  {
+    std::fill(output[channel], output[channel] + numSamples, 0.0f);
+    addRun(output[channel], static_cast<int>(channel), start, 1.0f, numSamples);
+
+    if (early[channel] == nullptr)
+      continue;
+
+    std::fill(early[channel], early[channel] + numSamples, 0.0f);
+    for (const auto &tap : taps[channel])
+      addRun(early[channel], tap.channel, start - tap.delay, tap.gain, numSamples);
+  }
+}
+
+void EarlyReflections::processRamping(const Channels &output, const Channels &early, const float *preDelay, int numSamples) const
+{
+  const float *lines[] = {line[0].data(), line[1].data()};
+  const float limit = static_cast<float>(maxPreDelay);
+
+  for (int sample = 0; sample < numSamples; ++sample)
+  {
+    // Offsetting by the line length keeps the position positive, so truncation
+    // is floor. The taps are whole samples apart, so they share the fraction.
+    const float position = static_cast<float>(writeIndex + sample + mask + 1) - juce::jlimit(0.0f, limit, preDelay[sample]);
+    const int index = static_cast<int>(position);
+    const float fraction = position - static_cast<float>(index);
+
+    for (size_t channel = 0; channel < line.size(); ++channel)
+    {
+      const float *samples = lines[channel];
+      output[channel][sample] = samples[index & mask] + (samples[(index + 1) & mask] - samples[index & mask]) * fraction;
+
+      if (early[channel] == nullptr)
+        continue;
+
+      float sum = 0.0f;
+      for (const auto &tap : taps[channel])
+      {
+        const float *source = lines[tap.channel];
+        const float a = source[(index - tap.delay) & mask];
+        const float b = source[(index - tap.delay + 1) & mask];
+        sum += (a + (b - a) * fraction) * tap.gain;
+      }
+      early[channel][sample] = sum;
+    }
+  }
+}
+
+void EarlyReflections::addRun(float *destination, int channel, int position, float gain, int numSamples) const
+{
+  const float *samples = line[static_cast<size_t>(channel)].data();
+  const int begin = position & mask;
+  const int first = juce::jmin(numSamples, mask + 1 - begin);
+
+  juce::FloatVectorOperations::addWithMultiply(destination, samples + begin, gain, first);
+  if (first < numSamples)
+    juce::FloatVectorOperations::addWithMultiply(destination + first, samples, gain, numSamples - first);
+}
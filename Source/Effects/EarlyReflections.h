@@ -0,0 +1,71 @@
+/*
+  ==============================================================================
+
+    EarlyReflections.h
+    Created: 18 Oct 2026 9:02:17pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSmoother.h"
+#include <array>
+#include <vector>
+
+// Pre-delay and early reflections in front of Reverb's tail. One short stereo
+// line, sized to the longest pre-delay plus the last reflection, feeds both:
+// the tail reads it at the pre-delay, and a sparse set of taps after that
+// stands in for the first bounces off the walls.
+//
+// While the pre-delay holds still, each tap is a contiguous run of the line,
+// so the reflections are summed a tap at a time over the whole block rather
+// than a sample at a time.
+class EarlyReflections
+{
+public:
+  static constexpr double maxPreDelaySeconds = 0.2;
+  static constexpr int numTaps = 12; // Per channel
+
+  // Allocates, so call from prepareToPlay
+  void prepare(double sampleRate, int maximumBlockSize);
+  void reset();
+
+  // Pushes numSamples of input into the line and replaces it with the input
+  // delayed by preDelay (in whole samples when static), for the tail. The
+  // reflections are written to earlyLeft and earlyRight, or skipped if they are
+  // nullptr. numSamples must not exceed the prepared block size.
+  void process(float *left, float *right, float *earlyLeft, float *earlyRight,
+               const ParameterSmoother::Block &preDelay, int numSamples);
+
+private:
+  struct Tap
+  {
+    int delay = 0;      // Samples after the pre-delay
+    int channel = 0;    // Input channel the reflection comes from
+    float gain = 0.0f;
+  };
+
+  // Reflection times in ms at each ear, roughly a small hall's first bounces
+  static constexpr std::array<double, numTaps> leftTimes{4.3, 7.9, 11.3, 17.1, 21.7, 26.9, 33.1, 39.7, 47.3, 55.9, 64.1, 73.7};
+  static constexpr std::array<double, numTaps> rightTimes{5.1, 9.1, 13.7, 15.9, 23.3, 29.3, 31.7, 42.1, 49.9, 53.3, 67.9, 77.9};
+
+  std::array<std::vector<float>, 2> line;
+  int mask = 0;
+  int writeIndex = 0;
+  int maxPreDelay = 0; // Samples
+  std::array<std::array<Tap, numTaps>, 2> taps;
+
+  using Channels = std::array<float *, 2>;
+
+  // Ramping pre-delay: interpolated reads a sample at a time
+  void processRamping(const Channels &output, const Channels &early, const float *preDelay, int numSamples) const;
+  // Static pre-delay: each tap added across the whole block at once
+  void processStatic(const Channels &output, const Channels &early, int preDelay, int numSamples) const;
+
+  // Adds gain times numSamples line samples starting at position, wrapping
+  // around the end of the line
+  void addRun(float *destination, int channel, int position, float gain, int numSamples) const;
+};
@@ -0,0 +1,211 @@
+/*
+  ==============================================================================
+
+    EffectPool.cpp
+    Created: 18 Oct 2026 6:02:48pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "EffectPool.h"
+#include "ParameterSnapshot.h"
+
+EffectPool::EffectPool()
+    : juce::Thread("Effect Pool")
+{
+}
+
+EffectPool::~EffectPool()
+{
+  stopTimer();
+  signalThreadShouldExit();
+  workReady.signal();
+  stopThread(4000);
+}
+
+void EffectPool::prepare(double sampleRate, int samplesPerBlock)
+{
+  {
+    const juce::ScopedLock sl(lock);
+    if (sampleRate == currentSampleRate && samplesPerBlock == currentBlockSize)
+      return;
+
+    currentSampleRate = sampleRate;
+    currentBlockSize = samplesPerBlock;
+    ++generation;
+
+    // Spares prepared for the old settings are prepared again
+    for (auto &spare : ready)
+      pending.push_back(std::move(spare));
+    ready.clear();
+  }
+
+  if (!isThreadRunning())
+    startThread(juce::Thread::Priority::background);
+
+  workReady.signal();
+  startTimerHz(20);
+}
+
+std::shared_ptr<juce::AudioProcessor> EffectPool::take(const juce::String &typeId)
+{
+  std::shared_ptr<juce::AudioProcessor> processor;
+  {
+    const juce::ScopedLock sl(lock);
+    if (usedTypes.insert(typeId).second)
+      startTimerHz(20); // Its first spare
+
+    auto it = std::find_if(ready.begin(), ready.end(), [&typeId](const Spare &spare)
+                           { return spare.typeId == typeId; });
+    if (it == ready.end())
+      return nullptr;
+
+    processor = std::move(it->processor);
+    std::swap(*it, ready.back());
+    ready.pop_back();
+  }
+
+  // Build its replacement
+  startTimerHz(20);
+  return processor;
+}
+
+void EffectPool::giveBack(const juce::String &typeId, std::shared_ptr<juce::AudioProcessor> processor)
+{
+  if (processor == nullptr)
+    return;
+
+  {
+    const juce::ScopedLock sl(lock);
+
+    // Without the type's defaults there is nothing to reset it to
+    if (defaultStates.count(typeId) == 0 || countSpares(typeId) >= sparesPerType)
+      return;
+
+    returned.push_back({typeId, std::move(processor), true});
+  }
+
+  startTimerHz(20);
+}
+
+int EffectPool::countSpares(const juce::String &typeId) const
+{
+  const auto isType = [&typeId](const Spare &spare)
+  { return spare.typeId == typeId; };
+
+  auto it = inProgress.find(typeId);
+  return static_cast<int>(std::count_if(ready.begin(), ready.end(), isType) +
+                          std::count_if(returned.begin(), returned.end(), isType) +
+                          std::count_if(pending.begin(), pending.end(), isType)) +
+         (it != inProgress.end() ? it->second : 0);
+}
+
+void EffectPool::timerCallback()
+{
+  {
+    const juce::ScopedLock sl(lock);
+
+    // Instances handed back can be reset once the rack and its schedules have
+    // all let go, which happens on this thread
+    for (auto it = returned.begin(); it != returned.end();)
+    {
+      if (it->processor.use_count() == 1)
+      {
+        pending.push_back(std::move(*it));
+        it = returned.erase(it);
+        workReady.signal();
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  // One instance per tick, so filling the pool never stalls the UI for long
+  for (const auto &type : EffectRegistry::getInstance().getTypes())
+  {
+    {
+      const juce::ScopedLock sl(lock);
+      if (currentSampleRate <= 0.0 || usedTypes.count(type.id) == 0 || countSpares(type.id) >= sparesPerType)
+        continue;
+    }
+
+    std::shared_ptr<juce::AudioProcessor> processor = type.create();
+    if (processor == nullptr)
+      continue;
+
+    juce::MemoryBlock defaults;
+    processor->getStateInformation(defaults);
+
+    {
+      const juce::ScopedLock sl(lock);
+      defaultStates.emplace(type.id, std::move(defaults));
+      pending.push_back({type.id, std::move(processor), false});
+    }
+
+    workReady.signal();
+    return;
+  }
+
+  const juce::ScopedLock sl(lock);
+  if (returned.empty())
+    stopTimer();
+}
+
+void EffectPool::run()
+{
+  while (!threadShouldExit())
+  {
+    workReady.wait(-1);
+
+    while (!threadShouldExit())
+    {
+      Spare spare;
+      juce::MemoryBlock defaults;
+      double sampleRate = 0.0;
+      int blockSize = 0;
+      int preparedFor = 0;
+
+      {
+        const juce::ScopedLock sl(lock);
+
+        if (pending.empty() || currentSampleRate <= 0.0)
+          break;
+
+        spare = std::move(pending.back());
+        pending.pop_back();
+        ++inProgress[spare.typeId];
+
+        if (spare.needsReset)
+          defaults = defaultStates[spare.typeId];
+        sampleRate = currentSampleRate;
+        blockSize = currentBlockSize;
+        preparedFor = generation;
+      }
+
+      if (spare.needsReset)
+      {
+        spare.processor->setStateInformation(defaults.getData(), static_cast<int>(defaults.getSize()));
+
+        // A rack's morph may have left it overridden
+        const auto *type = EffectRegistry::getInstance().findType(spare.typeId);
+        if (type != nullptr && type->overrides)
+          type->overrides(*spare.processor).clearOverrides();
+      }
+      spare.needsReset = false;
+
+      // Preparing again also clears whatever audio it held
+      spare.processor->setPlayConfigDetails(2, 2, sampleRate, blockSize);
+      spare.processor->prepareToPlay(sampleRate, blockSize);
+
+      const juce::ScopedLock sl(lock);
+      --inProgress[spare.typeId];
+      if (preparedFor == generation)
+        ready.push_back(std::move(spare));
+      else
+        pending.push_back(std::move(spare));
+    }
+  }
+}
@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    EffectPool.h
+    Created: 18 Oct 2026 6:02:48pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "EffectRegistry.h"
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+// Spare instances of registered effect types, already prepared, so a rack
+// slot can be filled without constructing or preparing anything. Only types
+// that have been asked for get spares, so effects a session never uses cost
+// nothing.
+//
+// Spares are built on the message thread, one per timer tick, since some
+// effects start timers of their own. Preparing them, and resetting instances
+// handed back to the defaults their type was built with, happens on a
+// background thread. A handed back instance waits until nothing else holds
+// it, which the timer checks on the message thread where schedules are
+// collected, so one still being run is never disturbed.
+class EffectPool : private juce::Thread,
+                   private juce::Timer
+{
+public:
+  // Spares kept ready of each type in use
+  static constexpr int sparesPerType = 1;
+
+  EffectPool();
+  ~EffectPool() override;
+
+  // Message thread. Spares are prepared for these settings from now on, and
+  // ones prepared for others are prepared again before they are handed out.
+  // Preparing again for the same settings changes nothing.
+  void prepare(double sampleRate, int samplesPerBlock);
+
+  // Message thread. A prepared instance with its type's default settings, or
+  // nullptr if none is ready. Never blocks on the background thread. From the
+  // first call for a type on, the pool keeps a spare of it.
+  std::shared_ptr<juce::AudioProcessor> take(const juce::String &typeId);
+
+  // Message thread. Resets and prepares the instance in the background for
+  // the next take(). Dropped if the type has enough spares already.
+  void giveBack(const juce::String &typeId, std::shared_ptr<juce::AudioProcessor> processor);
+
+private:
+  struct Spare
+  {
+    juce::String typeId;
+    std::shared_ptr<juce::AudioProcessor> processor;
+    bool needsReset = false; // Handed back, so not at its defaults
+  };
+
+  void run() override;
+  void timerCallback() override;
+
+  // Spares of the type ready or on their way. Call with lock held.
+  int countSpares(const juce::String &typeId) const;
+
+  juce::CriticalSection lock;
+  std::vector<Spare> ready;    // Prepared for generation
+  std::vector<Spare> returned; // Handed back and maybe still held elsewhere
+  std::vector<Spare> pending;  // Waiting to be reset or prepared
+  std::map<juce::String, int> inProgress; // Per type, taken out of pending by the background thread
+
+  // Each type's state straight from its factory, to reset instances with
+  std::map<juce::String, juce::MemoryBlock> defaultStates;
+
+  // Types that have been taken, which are the only ones given spares
+  std::set<juce::String> usedTypes;
+
+  double currentSampleRate = 0.0;
+  int currentBlockSize = 0;
+  int generation = 0; // Bumped by every prepare()
+
+  juce::WaitableEvent workReady;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectPool)
+};
@@ -11,17 +11,18 @@
 #include "EffectRack.h"
 #include <JuceHeader.h>
 
-EffectRack::EffectRack()
+EffectRack::EffectRack(EffectPool &effectPool)
+    : pool(effectPool)
 {
-  // Initialize the graph first
-  graph.enableAllBuses();
-  createBasicGraph();
+  graph.onLatencyChanged = [this]
+  { updateLatency(); };
 }
 
 EffectRack::~EffectRack()
 {
+  stopTimer();
+
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
   // First, mark all effects as being deleted to prevent any further processing
   for (auto &effect : effects)
@@ -32,43 +33,73 @@ EffectRack::~EffectRack()
   // Release resources for all processors
   for (auto &effect : effects)
   {
-    if (effect.node != nullptr && effect.node->getProcessor() != nullptr)
+    if (effect.pipeline != nullptr)
+    {
+      effect.pipeline->releaseResources();
+    }
+    else if (effect.processor != nullptr)
     {
-      effect.node->getProcessor()->releaseResources();
+      effect.processor->releaseResources();
     }
   }
 
-  // Clear the graph first to disconnect all nodes
-  graph.clear();
-
-  // Clear the effects vector
   effects.clear();
-
-  // Reset nodes
-  inputNode = nullptr;
-  outputNode = nullptr;
+  slots.clear();
 }
 
 void EffectRack::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-  const juce::ScopedLock pl(processLock);
+  const juce::ScopedWriteLock sl(effectsLock);
 
   currentSampleRate = sampleRate;
   currentBlockSize = samplesPerBlock;
+  setPlayConfigDetails(2, 2, sampleRate, samplesPerBlock);
 
-  // Configure and prepare the graph
-  graph.setPlayConfigDetails(2, 2, sampleRate, samplesPerBlock);
-  graph.prepareToPlay(sampleRate, samplesPerBlock);
+  // Parked effects have nothing to prepare. The pool prepares the spares
+  // they will be brought back with.
+  for (auto &effect : effects)
+  {
+    prepareEffect(effect);
+  }
 
-  updateGraph();
+  pool.prepare(sampleRate, samplesPerBlock);
+  graph.prepare(sampleRate, samplesPerBlock);
   isPrepared = true;
+  updateLatency();
+
+  // Frees the morph plans the audio thread has swapped out
+  startTimerHz(10);
+}
+
+void EffectRack::prepareEffect(EffectNode &effect)
+{
+  if (effect.pipeline != nullptr)
+  {
+    effect.pipeline->prepareToPlay(currentSampleRate, currentBlockSize);
+  }
+  else if (effect.processor != nullptr)
+  {
+    effect.processor->setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
+    effect.processor->prepareToPlay(currentSampleRate, currentBlockSize);
+  }
 }
 
 void EffectRack::releaseResources()
 {
-  const juce::ScopedLock pl(processLock);
+  const juce::ScopedWriteLock sl(effectsLock);
   isPrepared = false;
-  graph.releaseResources();
+
+  for (auto &effect : effects)
+  {
+    if (effect.pipeline != nullptr)
+    {
+      effect.pipeline->releaseResources();
+    }
+    else if (effect.processor != nullptr)
+    {
+      effect.processor->releaseResources();
+    }
+  }
 }
 
 void EffectRack::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
@@ -78,149 +109,116 @@ void EffectRack::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer
 
   juce::ScopedNoDenormals noDenormals;
 
-  // Check if we need to update the graph
-  if (graphUpdatePending)
-  {
-    const juce::ScopedLock pl(processLock);
-    rebuildConnections();
-    graphUpdatePending = false;
-  }
-
   // Clear any unused output channels
   for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
     buffer.clear(i, 0, buffer.getNumSamples());
 
-  // Process the effect rack
+  const auto *plan = morphPlans.acquire();
+  const float target = morph.load(std::memory_order_relaxed);
+
+  // A new plan starts from clean effects and is applied straight away
+  bool planChanged = false;
+  if (plan != nullptr && plan->id != appliedMorphPlan)
   {
-    const juce::ScopedLock sl(processLock);
-    graph.processBlock(buffer, midiMessages);
+    for (auto *overrides : plan->resets)
+      overrides->clearOverrides();
+    appliedMorphPlan = plan->id;
+    planChanged = true;
   }
 
-  // Update output levels
-  AudioLevels levels;
-  // ... rest of the processBlock implementation ...
+  // The effects pick the new values up as smoother targets when the block
+  // starts, and ramp to them sample by sample, so the routing still runs once
+  // per block and feedback and pipelines see whole blocks
+  if (plan != nullptr && (planChanged || target != currentMorph))
+    plan->apply(target);
+  currentMorph = target;
+
+  // Runs whichever schedule was compiled last, without locking
+  graph.process(buffer, midiMessages);
 }
 
-void EffectRack::createBasicGraph()
+void EffectRack::MorphPlan::apply(float position) const
 {
-  const juce::ScopedLock pl(processLock);
+  const int numSegments = static_cast<int>(values.size()) - 1;
+  if (numSegments < 1 || targets.empty())
+    return;
 
-  // Clear everything first
-  graph.clear();
-  inputNode = nullptr;
-  outputNode = nullptr;
+  const float scaled = juce::jlimit(0.0f, 1.0f, position) * static_cast<float>(numSegments);
+  const int segment = juce::jmin(static_cast<int>(scaled), numSegments - 1);
+  const float t = scaled - static_cast<float>(segment);
+  const auto &from = values[static_cast<size_t>(segment)];
 
-  // Create input node
-  auto audioInputProcessor = std::make_unique<juce::AudioProcessorGraph::AudioGraphIOProcessor>(
-      juce::AudioProcessorGraph::AudioGraphIOProcessor::audioInputNode);
-  inputNode = graph.addNode(std::move(audioInputProcessor));
+  juce::FloatVectorOperations::copy(scratch.data(), from.data(), static_cast<int>(numContinuous));
+  juce::FloatVectorOperations::addWithMultiply(scratch.data(), deltas[static_cast<size_t>(segment)].data(), t,
+                                               static_cast<int>(numContinuous));
 
-  // Create output node
-  auto audioOutputProcessor = std::make_unique<juce::AudioProcessorGraph::AudioGraphIOProcessor>(
-      juce::AudioProcessorGraph::AudioGraphIOProcessor::audioOutputNode);
-  outputNode = graph.addNode(std::move(audioOutputProcessor));
+  // Discrete parameters take the nearer snapshot's value
+  const auto &nearest = values[static_cast<size_t>(t < 0.5f ? segment : segment + 1)];
+  std::copy(nearest.begin() + static_cast<std::ptrdiff_t>(numContinuous), nearest.end(),
+            scratch.begin() + static_cast<std::ptrdiff_t>(numContinuous));
 
-  if (inputNode != nullptr && outputNode != nullptr)
-  {
-    // Create initial input to output connection
-    for (int channel = 0; channel < 2; ++channel)
-    {
-      auto sourceChannelIndex = channel;
-      auto destChannelIndex = channel;
-
-      graph.addConnection({{inputNode->nodeID, sourceChannelIndex},
-                           {outputNode->nodeID, destChannelIndex}});
-    }
-  }
+  for (size_t i = 0; i < targets.size(); ++i)
+    targets[i].overrides->setOverride(targets[i].index, scratch[i]);
 }
 
-void EffectRack::connectNodes()
+void EffectRack::reset()
 {
-  const juce::ScopedLock pl(processLock);
-
-  if (!rebuildConnections())
-  {
-    // If rebuilding fails, fall back to basic graph
-    createBasicGraph();
-  }
+  graph.reset();
 }
 
-void EffectRack::updateGraph()
+EffectRack::Handle EffectRack::addEffect(const juce::String &typeId)
 {
-  const juce::ScopedLock pl(processLock);
-
-  if (!isPrepared)
-    return;
-
-  try
-  {
-    // Ensure we have basic nodes
-    if (inputNode == nullptr || outputNode == nullptr)
-    {
-      createBasicGraph();
-      if (inputNode == nullptr || outputNode == nullptr)
-        return;
-    }
+  // A spare from the pool is prepared already
+  if (auto spare = pool.take(typeId))
+    return insertEffect(std::move(spare), typeId, false);
 
-    // Configure the graph
-    graph.setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
-
-    // Prepare all effect nodes
-    for (auto &effect : effects)
-    {
-      if (effect.node != nullptr && effect.node->getProcessor() != nullptr)
-      {
-        auto *processor = effect.node->getProcessor();
-        processor->setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
-        processor->prepareToPlay(currentSampleRate, currentBlockSize);
-      }
-    }
+  return insertEffect(EffectRegistry::getInstance().createEffect(typeId), typeId, true);
+}
 
-    // Update connections
-    connectNodes();
-  }
-  catch (...)
-  {
-    // If anything goes wrong, ensure we have a valid audio path
-    createBasicGraph();
-  }
+EffectRack::Handle EffectRack::addEffect(std::unique_ptr<juce::AudioProcessor> effect)
+{
+  // Built-in effects return their type ID as their name
+  const juce::String typeId = effect != nullptr ? effect->getName() : juce::String();
+  return insertEffect(std::move(effect), typeId, true);
 }
 
-void EffectRack::addEffect(std::unique_ptr<juce::AudioProcessor> effect)
+EffectRack::Handle EffectRack::insertEffect(std::shared_ptr<juce::AudioProcessor> effect, const juce::String &typeId,
+                                            bool needsPreparing)
 {
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
-  if (effect != nullptr)
-  {
-    EffectNode node;
-    node.node = graph.addNode(std::move(effect));
-    node.name = node.node->getProcessor()->getName();
-    node.position = static_cast<int>(effects.size()); // Add at the end
-    node.isActive = true;
+  if (effect == nullptr)
+    return invalidHandle;
 
-    effects.push_back(std::move(node));
-    updateEffectOrder();
-    graphUpdatePending = true;
-  }
+  EffectNode node;
+  node.processor = std::move(effect);
+
+  // Prepared before the schedule that runs it is published
+  if (isPrepared && needsPreparing)
+    prepareEffect(node);
+
+  node.name = typeId;
+  node.handle = nextHandle++;
+  node.position = static_cast<int>(effects.size()); // Add at the end
+  node.isActive = true;
+
+  const Handle handle = node.handle;
+  effects.push_back(std::move(node));
+  updateEffectOrder();
+  return handle;
 }
 
 void EffectRack::removeEffect(int index)
 {
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
   if (index >= 0 && index < static_cast<int>(effects.size()))
   {
-    // Set the deletion flag before removing
+    // Set the deletion flag before removing. The audio thread may still be
+    // running the effect, so it is released when the last schedule holding it
+    // is collected, and the pool waits for that before reusing it.
     effects[index].isBeingDeleted = true;
-
-    if (effects[index].node != nullptr)
-    {
-      effects[index].node->getProcessor()->releaseResources();
-      graph.removeNode(effects[index].node->nodeID);
-    }
-
+    releaseEffect(effects[index]);
     effects.erase(effects.begin() + index);
 
     // Update positions
@@ -228,42 +226,33 @@ void EffectRack::removeEffect(int index)
     {
       effects[i].position = static_cast<int>(i);
     }
+    updateSlots();
 
-    connectNodes();
+    rebuildConnections();
   }
 }
 
 void EffectRack::moveEffect(int fromIndex, int toIndex)
 {
-  // Get both locks to prevent audio processing during rearrangement
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
   if (fromIndex >= 0 && fromIndex < static_cast<int>(effects.size()) &&
       toIndex >= 0 && toIndex < static_cast<int>(effects.size()) &&
       fromIndex != toIndex)
   {
-    try
-    {
-      // Move the effect
-      auto effect = std::move(effects[fromIndex]);
-      effects.erase(effects.begin() + fromIndex);
-      effects.insert(effects.begin() + toIndex, std::move(effect));
+    // Move the effect
+    auto effect = std::move(effects[fromIndex]);
+    effects.erase(effects.begin() + fromIndex);
+    effects.insert(effects.begin() + toIndex, std::move(effect));
 
-      // Update positions
-      for (size_t i = 0; i < effects.size(); ++i)
-      {
-        effects[i].position = static_cast<int>(i);
-      }
-
-      // Rebuild connections
-      connectNodes();
-    }
-    catch (...)
+    // Update positions
+    for (size_t i = 0; i < effects.size(); ++i)
     {
-      // If something goes wrong, try to recover to a basic state
-      createBasicGraph();
+      effects[i].position = static_cast<int>(i);
     }
+    updateSlots();
+
+    rebuildConnections();
   }
 }
 
@@ -278,10 +267,7 @@ juce::AudioProcessor *EffectRack::getEffect(int index) const
   const juce::ScopedReadLock sl(effectsLock);
   if (index >= 0 && index < static_cast<int>(effects.size()))
   {
-    if (effects[index].node != nullptr)
-    {
-      return effects[index].node->getProcessor();
-    }
+    return effects[index].processor.get();
   }
   return nullptr;
 }
@@ -298,124 +284,90 @@ bool EffectRack::isEffectActive(int index) const
 
 void EffectRack::setEffectActive(int index, bool active)
 {
-  // Get both locks to ensure thread safety during state change
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
   if (index >= 0 && index < static_cast<int>(effects.size()))
   {
-    try
-    {
-      // Store old state in case we need to revert
-      bool oldState = effects[index].isActive;
-
-      // Update state
-      effects[index].isActive = active;
+    auto &effect = effects[index];
+    if (effect.isActive == active)
+      return;
 
-      // If we're enabling an effect, make sure it's prepared
-      if (active && isPrepared && effects[index].node != nullptr && effects[index].node->getProcessor() != nullptr)
-      {
-        auto *processor = effects[index].node->getProcessor();
-        processor->setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
-        processor->prepareToPlay(currentSampleRate, currentBlockSize);
-      }
+    effect.isActive = active;
+    if (!active)
+      parkEffect(effect);
+    else if (isParked(effect))
+      unparkEffect(effect);
 
-      // Try to rebuild connections with new state
-      if (!rebuildConnections())
-      {
-        // If rebuilding fails, revert to old state
-        effects[index].isActive = oldState;
-        rebuildConnections();
-      }
-    }
-    catch (...)
-    {
-      // If anything goes wrong, try to restore to a working state
-      createBasicGraph();
-      if (isPrepared)
-      {
-        graph.setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
-        graph.prepareToPlay(currentSampleRate, currentBlockSize);
-      }
-    }
+    rebuildConnections();
   }
 }
 
 bool EffectRack::rebuildConnections()
 {
-  if (inputNode == nullptr || outputNode == nullptr)
-    return false;
+  const juce::ScopedWriteLock sl(effectsLock);
 
-  try
+  const auto resolveEffect = [this](int handle) -> std::shared_ptr<juce::AudioProcessor>
   {
-    // Clear all existing connections
-    graph.getConnections().clear();
-
-    // Start with input node
-    juce::AudioProcessorGraph::Node::Ptr previousNode = inputNode;
-    bool anyConnectionFailed = false;
-
-    // Connect through active effects
-    for (auto &effect : effects)
+    auto it = slots.find(handle);
+    if (it == slots.end())
+      return nullptr;
+
+    const auto &effect = effects[static_cast<size_t>(it->second)];
+    if (!effect.isActive || effect.isBeingDeleted)
+      return nullptr;
+    if (effect.pipeline != nullptr)
+      return effect.pipeline;
+    return effect.processor;
+  };
+
+  bool routed = false;
+  if (customRouting != nullptr)
+  {
+    routed = graph.setGraph(*customRouting, resolveEffect);
+  }
+  else
+  {
+    // Serial routing through the active effects in slot order
+    std::vector<int> chain;
+    for (const auto &effect : effects)
     {
-      if (effect.isActive && effect.node != nullptr && effect.node->getProcessor() != nullptr)
+      if (effect.isActive && effect.processor != nullptr)
       {
-        bool allConnectionsSucceeded = true;
+        chain.push_back(effect.handle);
+      }
+    }
+    routed = graph.setGraph(EffectGraphManager::Graph::serial(chain), resolveEffect);
+  }
 
-        // Connect all channels
-        for (int channel = 0; channel < 2; ++channel)
-        {
-          bool success = graph.addConnection({{previousNode->nodeID, channel},
-                                              {effect.node->nodeID, channel}});
+  updateLatency();
+  rebuildMorph();
+  return routed;
+}
 
-          if (!success)
-          {
-            allConnectionsSucceeded = false;
-            anyConnectionFailed = true;
-            break;
-          }
-        }
+bool EffectRack::setRouting(const EffectGraphManager::Graph &routing)
+{
+  const juce::ScopedWriteLock sl(effectsLock);
 
-        if (allConnectionsSucceeded)
-        {
-          previousNode = effect.node;
-        }
-      }
-    }
+  auto previous = std::move(customRouting);
+  customRouting = std::make_unique<EffectGraphManager::Graph>(routing);
+  if (rebuildConnections())
+    return true;
 
-    // Always connect the last node to the output
-    if (previousNode != nullptr)
-    {
-      for (int channel = 0; channel < 2; ++channel)
-      {
-        if (!graph.addConnection({{previousNode->nodeID, channel},
-                                  {outputNode->nodeID, channel}}))
-        {
-          anyConnectionFailed = true;
-          break;
-        }
-      }
-    }
-    else
-    {
-      // If no effects are active, connect input directly to output
-      for (int channel = 0; channel < 2; ++channel)
-      {
-        if (!graph.addConnection({{inputNode->nodeID, channel},
-                                  {outputNode->nodeID, channel}}))
-        {
-          anyConnectionFailed = true;
-          break;
-        }
-      }
-    }
+  customRouting = std::move(previous);
+  return false;
+}
 
-    return !anyConnectionFailed;
-  }
-  catch (...)
-  {
-    return false;
-  }
+void EffectRack::clearRouting()
+{
+  const juce::ScopedWriteLock sl(effectsLock);
+  customRouting.reset();
+  rebuildConnections();
+}
+
+bool EffectRack::hasCustomRouting() const
+{
+  const juce::ScopedReadLock sl(effectsLock);
+  return customRouting != nullptr;
 }
 
 juce::String EffectRack::getEffectName(int index) const
@@ -428,49 +380,160 @@ juce::String EffectRack::getEffectName(int index) const
   return {};
 }
 
-int EffectRack::findEffectPosition(const juce::String &name) const
+EffectRack::Handle EffectRack::getEffectHandle(int index) const
 {
   const juce::ScopedReadLock sl(effectsLock);
-  for (size_t i = 0; i < effects.size(); ++i)
+  if (index >= 0 && index < static_cast<int>(effects.size()))
   {
-    if (effects[i].name == name)
-    {
-      return static_cast<int>(i);
-    }
+    return effects[index].handle;
   }
-  return -1;
+  return invalidHandle;
 }
 
-void EffectRack::clearEffects()
+int EffectRack::findEffectSlot(Handle handle) const
+{
+  const juce::ScopedReadLock sl(effectsLock);
+  auto it = slots.find(handle);
+  return it != slots.end() ? it->second : -1;
+}
+
+bool EffectRack::isEffectPipelined(int index) const
+{
+  const juce::ScopedReadLock sl(effectsLock);
+  if (index >= 0 && index < static_cast<int>(effects.size()))
+  {
+    const auto &effect = effects[index];
+    if (isParked(effect))
+      return effect.parkedPipelined;
+    return effect.pipeline != nullptr && effect.pipeline->isPipelined();
+  }
+  return false;
+}
+
+void EffectRack::setEffectPipelined(int index, bool shouldPipeline)
 {
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
-  // Mark all effects as being deleted
-  for (auto &effect : effects)
+  if (index < 0 || index >= static_cast<int>(effects.size()))
+    return;
+
+  auto &effect = effects[index];
+  if (isParked(effect))
   {
-    effect.isBeingDeleted = true;
+    // Applied when it is brought back
+    effect.parkedPipelined = shouldPipeline;
+    return;
   }
 
-  // First release all processors
-  for (auto &effect : effects)
+  if (effect.pipeline != nullptr)
   {
-    if (effect.node != nullptr && effect.node->getProcessor() != nullptr)
-    {
-      effect.node->getProcessor()->releaseResources();
-    }
+    // Already routed through the pipeline, which can switch while playing.
+    // Rerouting lines the other branches up with its new latency.
+    effect.pipeline->setPipelined(shouldPipeline);
+    rebuildConnections();
+    return;
   }
 
-  // Clear the graph
-  graph.clear();
-  effects.clear();
+  if (!shouldPipeline)
+    return;
 
-  // Reset nodes
-  inputNode = nullptr;
-  outputNode = nullptr;
+  // The effect may be playing, so only the new pipeline is prepared. It takes
+  // over when the rerouted schedule is swapped in, and stays for good so the
+  // effect is never run from two places.
+  effect.pipeline = std::make_shared<PipelinedProcessor>(effect.processor);
+  effect.pipeline->setPipelined(true);
+  if (isPrepared)
+    effect.pipeline->preparePipeline(currentBlockSize);
 
-  // Recreate basic structure
-  createBasicGraph();
+  rebuildConnections();
+}
+
+void EffectRack::parkEffect(EffectNode &effect)
+{
+  // Only types the registry can make again give up their instance
+  if (isParked(effect) || EffectRegistry::getInstance().findType(effect.name) == nullptr)
+    return;
+
+  effect.parkedState.reset();
+  effect.processor->getStateInformation(effect.parkedState);
+  effect.parkedPipelined = effect.pipeline != nullptr && effect.pipeline->isPipelined();
+  releaseEffect(effect);
+}
+
+void EffectRack::unparkEffect(EffectNode &effect)
+{
+  bool needsPreparing = false;
+  effect.processor = pool.take(effect.name);
+  if (effect.processor == nullptr)
+  {
+    effect.processor = EffectRegistry::getInstance().createEffect(effect.name);
+    needsPreparing = true;
+  }
+
+  if (effect.processor == nullptr)
+    return;
+
+  if (effect.parkedState.getSize() > 0)
+  {
+    effect.processor->setStateInformation(effect.parkedState.getData(),
+                                          static_cast<int>(effect.parkedState.getSize()));
+  }
+  effect.parkedState.reset();
+
+  if (effect.parkedPipelined)
+  {
+    effect.pipeline = std::make_shared<PipelinedProcessor>(effect.processor);
+    effect.pipeline->setPipelined(true);
+  }
+
+  if (isPrepared && needsPreparing)
+    prepareEffect(effect);
+  else if (isPrepared && effect.pipeline != nullptr)
+    effect.pipeline->preparePipeline(currentBlockSize);
+}
+
+void EffectRack::releaseEffect(EffectNode &effect)
+{
+  // Schedules may still be running it. The pool only resets it once they have
+  // all been collected.
+  effect.pipeline.reset();
+  pool.giveBack(effect.name, std::move(effect.processor));
+}
+
+void EffectRack::updateLatency()
+{
+  // The graph delays every other path to match its slowest one, which in the
+  // serial routing is the sum of the active effects
+  const int latency = graph.getLatencySamples();
+  if (latencySamples.exchange(latency, std::memory_order_relaxed) != latency && onLatencyChanged)
+    onLatencyChanged();
+}
+
+void EffectRack::updateSlots()
+{
+  slots.clear();
+  for (size_t i = 0; i < effects.size(); ++i)
+  {
+    slots[effects[i].handle] = static_cast<int>(i);
+  }
+}
+
+void EffectRack::clearEffects()
+{
+  const juce::ScopedWriteLock sl(effectsLock);
+
+  // Mark all effects as being deleted. Each is released once the audio
+  // thread has let go of it.
+  for (auto &effect : effects)
+  {
+    effect.isBeingDeleted = true;
+    releaseEffect(effect);
+  }
+
+  effects.clear();
+  slots.clear();
+  customRouting.reset();
+  rebuildConnections();
 }
 
 void EffectRack::getStateInformation(juce::MemoryBlock &destData)
@@ -484,21 +547,24 @@ void EffectRack::getStateInformation(juce::MemoryBlock &destData)
 
   for (int i = 0; i < static_cast<int>(effects.size()); ++i)
   {
-    // Add additional null checks
-    if (effects[i].node != nullptr &&
-        effects[i].node->getProcessor() != nullptr &&
-        !effects[i].isBeingDeleted) // Use the flag instead of isBeingDeleted()
+    // Parked effects save the settings they were parked with
+    if (!effects[i].isBeingDeleted) // Use the flag instead of isBeingDeleted()
     {
       juce::ValueTree effectState("EFFECT" + juce::String(i));
       effectState.setProperty("name", effects[i].name, nullptr);
+      effectState.setProperty("handle", effects[i].handle, nullptr);
       effectState.setProperty("active", effects[i].isActive, nullptr);
       effectState.setProperty("position", effects[i].position, nullptr);
+      effectState.setProperty("pipelined", effects[i].pipeline != nullptr ? effects[i].pipeline->isPipelined() : effects[i].parkedPipelined, nullptr);
 
       // Get processor state safely with try-catch
       try
       {
         juce::MemoryBlock processorData;
-        effects[i].node->getProcessor()->getStateInformation(processorData);
+        if (isParked(effects[i]))
+          processorData = effects[i].parkedState;
+        else
+          effects[i].processor->getStateInformation(processorData);
         if (processorData.getSize() > 0)
         {
           effectState.setProperty("processorState", processorData.toBase64Encoding(), nullptr);
@@ -513,6 +579,28 @@ void EffectRack::getStateInformation(juce::MemoryBlock &destData)
     }
   }
 
+  if (customRouting != nullptr)
+    state.addChild(customRouting->toValueTree(), -1, nullptr);
+
+  if (!morphSnapshots.empty())
+  {
+    juce::ValueTree morphState("MORPH");
+    for (const auto &snapshot : morphSnapshots)
+    {
+      juce::ValueTree snapshotState("SNAPSHOT");
+      for (const auto &[handle, values] : snapshot)
+      {
+        juce::ValueTree effectValues("VALUES");
+        effectValues.setProperty("handle", handle, nullptr);
+        for (const auto &[parameterID, value] : values)
+          effectValues.setProperty(parameterID, value, nullptr);
+        snapshotState.addChild(effectValues, -1, nullptr);
+      }
+      morphState.addChild(snapshotState, -1, nullptr);
+    }
+    state.addChild(morphState, -1, nullptr);
+  }
+
   std::unique_ptr<juce::XmlElement> xml(state.createXml());
   juce::AudioProcessor::copyXmlToBinary(*xml, destData);
 }
@@ -520,120 +608,120 @@ void EffectRack::getStateInformation(juce::MemoryBlock &destData)
 void EffectRack::setStateInformation(const void *data, int sizeInBytes)
 {
   const juce::ScopedWriteLock sl(effectsLock);
-  const juce::ScopedLock pl(processLock);
 
-  // Store current state in case restoration fails
-  auto oldEffects = effects;
+  // The new effects are built aside, so a failed restore leaves the rack as it was
+  std::vector<EffectNode> restoredEffects;
+  std::unordered_map<Handle, int> restoredSlots;
+  std::unique_ptr<EffectGraphManager::Graph> restoredRouting;
+  std::vector<MorphSnapshot> restoredSnapshots;
 
   try
   {
-    // Clear existing effects first
-    effects.clear();
-    graph.clear();
-    inputNode = nullptr;
-    outputNode = nullptr;
-
     std::unique_ptr<juce::XmlElement> xml(juce::AudioProcessor::getXmlFromBinary(data, sizeInBytes));
-    if (xml != nullptr && xml->hasTagName("EFFECTRACK"))
+    if (xml == nullptr || !xml->hasTagName("EFFECTRACK"))
     {
-      juce::ValueTree state = juce::ValueTree::fromXml(*xml);
-
-      currentSampleRate = state.getProperty("sampleRate", 44100.0);
-      currentBlockSize = state.getProperty("blockSize", 512);
+      throw std::runtime_error("Invalid state data");
+    }
 
-      // Recreate the basic graph structure
-      createBasicGraph();
+    juce::ValueTree state = juce::ValueTree::fromXml(*xml);
 
-      // Restore effects
-      for (int i = 0; i < state.getNumChildren(); ++i)
+    // Restore effects
+    for (int i = 0; i < state.getNumChildren(); ++i)
+    {
+      juce::ValueTree effectState = state.getChild(i);
+      if (effectState.hasType("EFFECT" + juce::String(i)))
       {
-        juce::ValueTree effectState = state.getChild(i);
-        if (effectState.hasType("EFFECT" + juce::String(i)))
+        juce::String name = effectState.getProperty("name");
+        bool active = effectState.getProperty("active", true);
+
+        if (EffectRegistry::getInstance().findType(name) != nullptr)
         {
-          juce::String name = effectState.getProperty("name");
-          bool active = effectState.getProperty("active", true);
-
-          // Create appropriate processor
-          std::unique_ptr<juce::AudioProcessor> processor;
-          if (name == "Delay")
-            processor = std::make_unique<Delay>();
-          else if (name == "Reverb")
-            processor = std::make_unique<Reverb>();
-          else if (name == "Distortion")
-            processor = std::make_unique<Distortion>();
-          else if (name == "Chorus")
-            processor = std::make_unique<Chorus>();
-          else if (name == "EQ")
-            processor = std::make_unique<Equalizer>();
-
-          if (processor != nullptr)
+          // Every effect starts out parked with its saved settings, and the
+          // active ones are given an instance from the pool
+          EffectNode effectNode;
+          effectNode.name = name;
+          effectNode.isActive = active;
+          effectNode.position = effectState.getProperty("position");
+          effectNode.parkedPipelined = effectState.getProperty("pipelined", false);
+
+          juce::String processorStateBase64 = effectState.getProperty("processorState");
+          if (processorStateBase64.isNotEmpty())
           {
-            // Restore processor state if available
-            juce::String processorStateBase64 = effectState.getProperty("processorState");
-            if (processorStateBase64.isNotEmpty())
-            {
-              juce::MemoryBlock processorData;
-              processorData.fromBase64Encoding(processorStateBase64);
-              processor->setStateInformation(processorData.getData(),
-                                             static_cast<int>(processorData.getSize()));
-            }
-
-            // Add to rack
-            auto node = graph.addNode(std::move(processor));
-            if (node != nullptr)
-            {
-              EffectNode effectNode;
-              effectNode.name = name;
-              effectNode.isActive = active;
-              effectNode.position = effectState.getProperty("position");
-              effectNode.node = node;
-              effects.push_back(std::move(effectNode));
-            }
+            effectNode.parkedState.fromBase64Encoding(processorStateBase64);
           }
+
+          if (active)
+          {
+            unparkEffect(effectNode);
+          }
+
+          // Keep saved handles so anything holding one still finds its
+          // effect. Older states have none, and duplicates get new ones.
+          const Handle handle = effectState.getProperty("handle", invalidHandle);
+          if (handle > invalidHandle && restoredSlots.count(handle) == 0)
+          {
+            effectNode.handle = handle;
+            restoredSlots[handle] = static_cast<int>(restoredEffects.size());
+          }
+          restoredEffects.push_back(std::move(effectNode));
         }
       }
+    }
 
-      // Prepare if needed
-      if (isPrepared)
+    auto routingState = state.getChildWithName("ROUTING");
+    if (routingState.isValid())
+    {
+      restoredRouting = std::make_unique<EffectGraphManager::Graph>(EffectGraphManager::Graph::fromValueTree(routingState));
+    }
+
+    // Snapshots find their effects by handle, like the routing
+    for (const auto &snapshotState : state.getChildWithName("MORPH"))
+    {
+      MorphSnapshot snapshot;
+      for (const auto &effectValues : snapshotState)
       {
-        graph.setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
-        graph.prepareToPlay(currentSampleRate, currentBlockSize);
-        if (!rebuildConnections())
+        auto &values = snapshot[static_cast<Handle>(effectValues.getProperty("handle", invalidHandle))];
+        for (int i = 0; i < effectValues.getNumProperties(); ++i)
         {
-          throw std::runtime_error("Failed to rebuild connections");
+          const auto name = effectValues.getPropertyName(i);
+          if (name != juce::Identifier("handle"))
+            values[name.toString()] = effectValues.getProperty(name);
         }
       }
-    }
-    else
-    {
-      throw std::runtime_error("Invalid state data");
+      restoredSnapshots.push_back(std::move(snapshot));
     }
   }
   catch (...)
   {
-    // Restore old state if anything goes wrong
-    effects = std::move(oldEffects);
-
-    // Clear and rebuild the graph
-    graph.clear();
-    createBasicGraph();
+    // Keep the current effects if anything goes wrong
+    return;
+  }
 
-    // Restore the nodes to the graph
-    for (auto &effect : effects)
-    {
-      if (effect.node != nullptr && effect.node->getProcessor() != nullptr)
-      {
-        auto processor = std::unique_ptr<juce::AudioProcessor>(effect.node->getProcessor());
-        effect.node = graph.addNode(std::move(processor));
-      }
-    }
+  // Old effects stay alive until the audio thread has moved on to the new
+  // schedule, then go back to the pool
+  for (auto &effect : effects)
+  {
+    effect.isBeingDeleted = true;
+    releaseEffect(effect);
+  }
+  effects = std::move(restoredEffects);
+  customRouting = std::move(restoredRouting);
+  morphSnapshots = std::move(restoredSnapshots);
+
+  // Hand out new handles above any that were restored
+  nextHandle = invalidHandle + 1;
+  for (const auto &effect : effects)
+    nextHandle = juce::jmax(nextHandle, effect.handle + 1);
+  for (auto &effect : effects)
+    if (effect.handle == invalidHandle)
+      effect.handle = nextHandle++;
+  updateSlots();
 
-    if (isPrepared)
-    {
-      graph.setPlayConfigDetails(2, 2, currentSampleRate, currentBlockSize);
-      graph.prepareToPlay(currentSampleRate, currentBlockSize);
-      rebuildConnections();
-    }
+  // A routing that no longer compiles falls back to serial
+  if (!rebuildConnections() && customRouting != nullptr)
+  {
+    customRouting.reset();
+    rebuildConnections();
   }
 }
 
@@ -654,7 +742,6 @@ void EffectRack::setEffectOrder(int index, int newOrder)
   {
     effects[index].position = newOrder;
     updateEffectOrder();
-    graphUpdatePending = true;
   }
 }
 
@@ -674,6 +761,8 @@ void EffectRack::updateEffectOrder()
   {
     effects[i].position = static_cast<int>(i);
   }
+  updateSlots();
+  rebuildConnections();
 }
 
 std::vector<juce::AudioProcessor *> EffectRack::getEffectOrder() const
@@ -681,15 +770,132 @@ std::vector<juce::AudioProcessor *> EffectRack::getEffectOrder() const
   return effectOrder;
 }
 
-void EffectRack::updateGraphConnections()
+int EffectRack::addMorphSnapshot()
 {
-  // This should be called from the message thread
-  jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+  const juce::ScopedWriteLock sl(effectsLock);
 
-  if (graphUpdatePending)
+  // Parked effects are left out, and held where they are once brought back
+  MorphSnapshot snapshot;
+  for (const auto &effect : effects)
   {
-    const juce::ScopedLock pl(processLock);
-    rebuildConnections();
-    graphUpdatePending = false;
+    if (!effect.isActive || isParked(effect))
+      continue;
+
+    auto &values = snapshot[effect.handle];
+    for (auto *parameter : effect.processor->getParameters())
+    {
+      if (auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter))
+        values[ranged->paramID] = ranged->convertFrom0to1(ranged->getValue());
+    }
+  }
+
+  morphSnapshots.push_back(std::move(snapshot));
+  rebuildMorph();
+  return static_cast<int>(morphSnapshots.size());
+}
+
+void EffectRack::clearMorphSnapshots()
+{
+  const juce::ScopedWriteLock sl(effectsLock);
+  morphSnapshots.clear();
+  rebuildMorph();
+}
+
+int EffectRack::getNumMorphSnapshots() const
+{
+  const juce::ScopedReadLock sl(effectsLock);
+  return static_cast<int>(morphSnapshots.size());
+}
+
+void EffectRack::rebuildMorph()
+{
+  auto plan = std::make_unique<MorphPlan>();
+  plan->id = nextMorphPlanId++;
+
+  // Each target's value in every snapshot, continuous and discrete apart
+  std::vector<MorphPlan::Target> discreteTargets;
+  std::vector<std::vector<float>> continuousValues, discreteValues;
+
+  for (const auto &effect : effects)
+  {
+    const auto *type = EffectRegistry::getInstance().findType(effect.name);
+    if (isParked(effect) || effect.isBeingDeleted || type == nullptr || !type->overrides)
+      continue;
+
+    auto &overrides = type->overrides(*effect.processor);
+    plan->resets.push_back(&overrides);
+    plan->processors.push_back(effect.processor);
+
+    if (morphSnapshots.size() < 2 || !effect.isActive)
+      continue;
+
+    for (auto *parameter : effect.processor->getParameters())
+    {
+      auto *ranged = dynamic_cast<juce::RangedAudioParameter *>(parameter);
+      const int index = ranged != nullptr ? overrides.findParameter(ranged->paramID) : -1;
+      if (index < 0)
+        continue;
+
+      // Snapshots without the effect hold it where it is now
+      const float current = ranged->convertFrom0to1(ranged->getValue());
+      std::vector<float> values;
+      values.reserve(morphSnapshots.size());
+      for (const auto &snapshot : morphSnapshots)
+      {
+        float value = current;
+        auto effectValues = snapshot.find(effect.handle);
+        if (effectValues != snapshot.end())
+        {
+          auto found = effectValues->second.find(ranged->paramID);
+          if (found != effectValues->second.end())
+            value = found->second;
+        }
+        values.push_back(value);
+      }
+
+      if (std::all_of(values.begin(), values.end(), [&values](float value)
+                      { return value == values.front(); }))
+        continue;
+
+      if (ranged->isDiscrete() || ranged->isBoolean())
+      {
+        discreteTargets.push_back({&overrides, index});
+        discreteValues.push_back(std::move(values));
+      }
+      else
+      {
+        plan->targets.push_back({&overrides, index});
+        continuousValues.push_back(std::move(values));
+      }
+    }
   }
+
+  plan->numContinuous = plan->targets.size();
+  plan->targets.insert(plan->targets.end(), discreteTargets.begin(), discreteTargets.end());
+  auto targetValues = std::move(continuousValues);
+  targetValues.insert(targetValues.end(), discreteValues.begin(), discreteValues.end());
+
+  // Laid out per snapshot, so each block reads two contiguous vectors
+  const size_t numTargets = plan->targets.size();
+  const size_t numSnapshots = numTargets > 0 ? morphSnapshots.size() : 0;
+  plan->values.assign(numSnapshots, std::vector<float>(numTargets));
+  for (size_t target = 0; target < numTargets; ++target)
+    for (size_t snapshot = 0; snapshot < numSnapshots; ++snapshot)
+      plan->values[snapshot][target] = targetValues[target][snapshot];
+
+  for (size_t snapshot = 0; snapshot + 1 < numSnapshots; ++snapshot)
+  {
+    std::vector<float> delta(plan->numContinuous);
+    for (size_t target = 0; target < plan->numContinuous; ++target)
+      delta[target] = plan->values[snapshot + 1][target] - plan->values[snapshot][target];
+    plan->deltas.push_back(std::move(delta));
+  }
+
+  plan->scratch.resize(numTargets);
+  morphPlans.publish(std::move(plan));
+}
+
+void EffectRack::timerCallback()
+{
+  morphPlans.collectGarbage();
 }
@@ -11,17 +11,29 @@
 #pragma once
 
 #include <JuceHeader.h>
-#include "Delay.h"
-#include "Reverb.h"
-#include "Distortion.h"
-#include "Chorus.h"
-#include "Equalizer.h"
+#include "EffectPool.h"
+#include "EffectRegistry.h"
+#include "LockFreeSwap.h"
+#include "ParameterSnapshot.h"
+#include "PipelinedProcessor.h"
+#include "../Graph/EffectGraphManager.h"
+#include <atomic>
+#include <map>
+#include <unordered_map>
 
 //==============================================================================
-class EffectRack : juce::AudioProcessor
+class EffectRack : juce::AudioProcessor,
+                   private juce::Timer
 {
 public:
-  EffectRack();
+  // Along the slowest path through the routing. Any thread.
+  int getLatencySamples() const { return latencySamples.load(std::memory_order_relaxed); }
+
+  // Message thread, whenever getLatencySamples() changes
+  std::function<void()> onLatencyChanged;
+
+  // Racks that play at the same settings can share one pool of spares
+  explicit EffectRack(EffectPool &effectPool);
   ~EffectRack();
 
   // AudioProcessor overrides
@@ -45,32 +57,69 @@ public:
   void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages);
   void releaseResources();
 
-  // Effect management
-  void addEffect(std::unique_ptr<juce::AudioProcessor> effect);
+  // Audio thread. Silences whatever the effects and routing still hold, e.g.
+  // before a rack that has been idle is heard again.
+  void reset() override;
+
+  // Effects are addressed by handles, which stay with an effect while it is
+  // moved and are never reused, so a rack can hold any number of one type
+  using Handle = int;
+  static constexpr Handle invalidHandle = 0;
+
+  // Effect management. Effects of registered types come from the rack's
+  // EffectPool when it has one ready, and go back to it when removed.
+  Handle addEffect(std::unique_ptr<juce::AudioProcessor> effect);
+  Handle addEffect(const juce::String &typeId); // Created through the EffectRegistry
   void removeEffect(int index);
   void moveEffect(int fromIndex, int toIndex);
   int getNumEffects() const;
   juce::AudioProcessor *getEffect(int index) const;
   void clearEffects();
 
-  // Effect state queries
+  // Effect state queries. An inactive effect of a registered type keeps only
+  // its settings and hands its instance back to the pool; getEffect() returns
+  // nullptr for it until it is made active again with a ready instance.
   bool isEffectActive(int index) const;
   void setEffectActive(int index, bool active);
   juce::String getEffectName(int index) const;
-  int findEffectPosition(const juce::String &name) const;
+  Handle getEffectHandle(int index) const;
+  int findEffectSlot(Handle handle) const; // -1 if the handle is not in the rack
+
+  // Pipelined effects run one block behind on a thread of their own, which
+  // adds a block of latency but lets a heavy effect use another core
+  bool isEffectPipelined(int index) const;
+  void setEffectPipelined(int index, bool shouldPipeline);
 
   // State management
   bool rebuildConnections();
 
+  // Routing. By default the active effects run one after another in slot
+  // order. A custom routing addresses effects by handle in its Effect nodes;
+  // inactive or missing effects pass audio through. Returns false and keeps
+  // the current routing if the graph can't be compiled.
+  bool setRouting(const EffectGraphManager::Graph &routing);
+  void clearRouting();
+  bool hasCustomRouting() const;
+
   // Effect order management
   int getEffectOrder(int index) const;
   void setEffectOrder(int index, int newOrder);
   void updateEffectOrder();
   std::vector<juce::AudioProcessor *> getEffectOrder() const;
 
-  // Graph management
-  void updateGraphConnections();
-  bool isGraphUpdatePending() const { return graphUpdatePending; }
+  // Morphing. A morph snapshot records the settings of every active effect,
+  // and with two or more the morph position moves through them in the order
+  // they were added. Continuous parameters glide between neighbouring
+  // snapshots and discrete ones switch halfway. Only parameters that differ
+  // between snapshots are driven, the rest stay under the user's control.
+  int addMorphSnapshot(); // Returns the number of snapshots
+  void clearMorphSnapshots();
+  int getNumMorphSnapshots() const;
+
+  // Any thread. 0 is the first snapshot and 1 the last. Applied from the next
+  // block, through each effect's own parameter smoothing.
+  void setMorph(float position) { morph.store(juce::jlimit(0.0f, 1.0f, position), std::memory_order_relaxed); }
+  float getMorph() const { return morph.load(std::memory_order_relaxed); }
 
   // Audio levels structure
   struct AudioLevels
@@ -82,41 +131,103 @@ public:
 private:
   struct EffectNode
   {
-    juce::AudioProcessorGraph::Node::Ptr node;
+    // Shared with the compiled schedules, which keep a removed effect alive
+    // until the audio thread is done with it
+    std::shared_ptr<juce::AudioProcessor> processor;
+    std::shared_ptr<PipelinedProcessor> pipeline; // Runs the processor once it has been pipelined
     bool isActive = true;
-    juce::String name;
+    juce::String name; // EffectRegistry type ID
+    Handle handle = invalidHandle;
     int position;
     bool isBeingDeleted = false;
+
+    // While parked the processor is back in the pool, and these bring it back
+    juce::MemoryBlock parkedState;
+    bool parkedPipelined = false;
   };
 
-  // Graph management
-  void updateGraph();
-  void rebuildGraph();
-  void createBasicGraph();
-  void connectNodes();
-  juce::AudioProcessorGraph::Node::Ptr addNodeToGraph(std::unique_ptr<juce::AudioProcessor> processor);
+  void prepareEffect(EffectNode &effect);
+
+  // Swap an inactive effect's instance for its settings and back. Unparking
+  // takes a ready instance from the pool, or makes one if there is none.
+  void parkEffect(EffectNode &effect);
+  void unparkEffect(EffectNode &effect);
+  bool isParked(const EffectNode &effect) const { return effect.processor == nullptr; }
 
-  // The main audio processing graph
-  juce::AudioProcessorGraph graph;
+  // Hands every instance the effect holds back to the pool
+  void releaseEffect(EffectNode &effect);
+  void updateLatency();
+  Handle insertEffect(std::shared_ptr<juce::AudioProcessor> effect, const juce::String &typeId, bool needsPreparing);
 
-  // Input/Output nodes
-  juce::AudioProcessorGraph::Node::Ptr inputNode;
-  juce::AudioProcessorGraph::Node::Ptr outputNode;
+  // Rebuilds the handle to slot index. Call whenever effects changes order.
+  void updateSlots();
+
+  // Raw parameter values by parameter ID, per effect handle
+  using MorphSnapshot = std::map<Handle, std::map<juce::String, float>>;
+
+  // The snapshots compiled for the audio thread: one value per driven
+  // parameter per snapshot, and the steps between neighbouring snapshots
+  struct MorphPlan
+  {
+    struct Target
+    {
+      ParameterOverrides *overrides;
+      int index;
+    };
+
+    // Audio thread. Writes the values at the position into the effects.
+    void apply(float position) const;
+
+    int id = 0;
+    std::vector<Target> targets; // Continuous parameters first, then discrete
+    size_t numContinuous = 0;
+    std::vector<std::vector<float>> values; // Per snapshot, per target
+    std::vector<std::vector<float>> deltas; // Per pair of snapshots, continuous targets only
+    mutable std::vector<float> scratch;
+
+    // Every effect the rack runs, cleared when the plan takes over so the
+    // ones it no longer drives follow their own parameters again
+    std::vector<ParameterOverrides *> resets;
+    std::vector<std::shared_ptr<juce::AudioProcessor>> processors; // Kept alive while the plan may run
+  };
+
+  // Publishes a plan for the current effects. Call with effectsLock held.
+  void rebuildMorph();
+  void timerCallback() override;
+
+  // Runs the effects. Changes are compiled on the message thread and swapped
+  // in, so the audio thread never waits on effectsLock.
+  EffectGraphManager graph;
+  EffectPool &pool;
+  std::unique_ptr<EffectGraphManager::Graph> customRouting; // Null for serial
 
   // Thread safety
   mutable juce::ReadWriteLock effectsLock;
-  juce::CriticalSection processLock;
-  std::atomic<bool> graphUpdatePending{false};
 
   // State tracking
   double currentSampleRate = 44100.0;
   int currentBlockSize = 512;
   bool isPrepared = false;
+  std::atomic<int> latencySamples{0}; // Set on the message thread, read by the audio thread
 
   // Effect storage
   std::vector<EffectNode> effects;
   std::vector<juce::AudioProcessor *> effectOrder;
 
+  // Where each handle currently sits in effects
+  std::unordered_map<Handle, int> slots;
+  Handle nextHandle = invalidHandle + 1;
+
+  // Morphing
+  std::vector<MorphSnapshot> morphSnapshots;
+  LockFreeSwap<MorphPlan> morphPlans;
+  int nextMorphPlanId = 1;
+  std::atomic<float> morph{0.0f};
+
+  // Audio thread
+  int appliedMorphPlan = 0;
+  float currentMorph = 0.0f;
+
   // Prevent copying
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectRack)
 };
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    EffectRegistry.cpp
+    Created: 18 Oct 2026 11:52:06pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "EffectRegistry.h"
+#include "Delay.h"
+#include "Distortion.h"
+#include "Reverb.h"
+#include "ConvolutionReverb.h"
+#include "Chorus.h"
+#include "Equalizer.h"
+
+namespace
+{
+  template <typename Effect>
+  ParameterOverrides &overridesOf(juce::AudioProcessor &processor)
+  {
+    return static_cast<Effect &>(processor).getParameterOverrides();
+  }
+}
+
+EffectRegistry::EffectRegistry()
+{
+  // Costs are estimates: the largest buffers each effect allocates, and its
+  // per-sample work against a Delay's
+  registerType({"Delay", "Delay", "delay.svg", []
+                { return std::make_unique<Delay>(); },
+                800 * 1024, 1.0f, overridesOf<Delay>}); // Two seconds of stereo delay line
+
+  registerType({"Distortion", "Distortion", "distortion.svg", []
+                { return std::make_unique<Distortion>(); },
+                128 * 1024, 3.0f, overridesOf<Distortion>}); // Oversampling filters and buffers
+
+  registerType({"Reverb", "Reverb", "reverb.svg", []
+                { return std::make_unique<Reverb>(); },
+                1536 * 1024, 4.0f, overridesOf<Reverb>}); // Feedback network and pre-delay
+
+  registerType({"Convolution", "Convolution", "reverb.svg", []
+                { return std::make_unique<ConvolutionReverb>(); },
+                8 * 1024 * 1024, 6.0f, overridesOf<ConvolutionReverb>}); // Partitioned spectra of a long response
+
+  registerType({"Chorus", "Chorus", "chorus.svg", []
+                { return std::make_unique<Chorus>(); },
+                32 * 1024, 1.5f, overridesOf<Chorus>});
+
+  registerType({"EQ", "EQ", "eq.svg", []
+                { return std::make_unique<Equalizer>(); },
+                256 * 1024, 2.0f, overridesOf<Equalizer>}); // Mostly the linear phase kernels
+}
+
+const EffectRegistry &EffectRegistry::getInstance()
+{
+  static const EffectRegistry registry;
+  return registry;
+}
+
+void EffectRegistry::registerType(Type type)
+{
+  // IDs are how states find their effects again, so they must be unique
+  jassert(index.count(type.id) == 0);
+
+  index[type.id] = types.size();
+  types.push_back(std::move(type));
+}
+
+const EffectRegistry::Type *EffectRegistry::findType(const juce::String &id) const
+{
+  auto it = index.find(id);
+  return it != index.end() ? &types[it->second] : nullptr;
+}
+
+std::unique_ptr<juce::AudioProcessor> EffectRegistry::createEffect(const juce::String &id) const
+{
+  if (auto *type = findType(id))
+    return type->create();
+
+  return nullptr;
+}
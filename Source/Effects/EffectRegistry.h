@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    EffectRegistry.h
+    Created: 18 Oct 2026 11:52:06pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+class ParameterOverrides;
+
+// Every effect type the plugin offers. Racks, saved states, the toolbar and
+// the icons all resolve types through here, by ID, so adding an effect is one
+// registerType() call in EffectRegistry.cpp.
+class EffectRegistry
+{
+public:
+  using Factory = std::function<std::unique_ptr<juce::AudioProcessor>()>;
+
+  // The snapshot an instance of the type reads its parameters through
+  using OverridesAccessor = std::function<ParameterOverrides &(juce::AudioProcessor &)>;
+
+  struct Type
+  {
+    juce::String id;          // Saved in states, so never change one
+    juce::String displayName; // Shown on buttons and panels
+    juce::String iconFile;    // In Assets/Icons
+    Factory create;
+
+    // Rough cost of one instance at 48 kHz stereo
+    size_t memoryBytes = 0;
+    float cpuCost = 1.0f; // Relative to a Delay
+
+    OverridesAccessor overrides;
+  };
+
+  // The built-in types, in toolbar order
+  static const EffectRegistry &getInstance();
+
+  // nullptr if no type has this ID
+  const Type *findType(const juce::String &id) const;
+
+  // A new instance of the type, or nullptr if no type has this ID
+  std::unique_ptr<juce::AudioProcessor> createEffect(const juce::String &id) const;
+
+  const std::vector<Type> &getTypes() const { return types; }
+
+private:
+  EffectRegistry();
+
+  void registerType(Type type);
+
+  std::vector<Type> types;
+  std::unordered_map<juce::String, size_t> index; // ID to position in types
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectRegistry)
+};
@@ -10,59 +10,129 @@
 
 #include "Equalizer.h"
 
+namespace
+{
+  // Bands 1-3 start where the old fixed low shelf, mid peak and high shelf were
+  struct BandDefaults
+  {
+    Equalizer::BandType type;
+    float freq;
+    float q;
+  };
+  constexpr BandDefaults fixedBandDefaults[] = {{Equalizer::BandType::LowShelf, 100.0f, 1.0f},
+                                                {Equalizer::BandType::Bell, 1000.0f, 1.0f},
+                                                {Equalizer::BandType::HighShelf, 10000.0f, 1.0f}};
+
+  // Sessions saved before the bands were configurable stored those three
+  // bands under their own IDs
+  const std::pair<const char *, const char *> legacyParameterIDs[] = {
+      {"lowGain", "band1Gain"}, {"lowFreq", "band1Freq"}, {"midGain", "band2Gain"}, {"midFreq", "band2Freq"},
+      {"midQ", "band2Q"}, {"highGain", "band3Gain"}, {"highFreq", "band3Freq"}};
+
+  // Field names in the order of Equalizer::BandValues
+  const char *const bandFieldNames[] = {"Type", "Freq", "Gain", "Q", "Slope", "Dynamic", "Threshold", "Ratio", "Attack", "Release"};
+}
+
 Equalizer::Equalizer()
     : AudioProcessor(BusesProperties()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
-                         .withOutput("Output", juce::AudioChannelSet::stereo(), true)),
-      parameters(*this, nullptr, "PARAMETERS",
-                 {std::make_unique<juce::AudioParameterFloat>(
-                      "lowGain", "Low Gain",
-                      juce::NormalisableRange<float>(minGain, maxGain),
-                      defaultLowGain),
-                  std::make_unique<juce::AudioParameterFloat>(
-                      "lowFreq", "Low Freq",
-                      juce::NormalisableRange<float>(minLowFreq, maxLowFreq),
-                      defaultLowFreq),
-                  std::make_unique<juce::AudioParameterFloat>(
-                      "midGain", "Mid Gain",
-                      juce::NormalisableRange<float>(minGain, maxGain),
-                      defaultMidGain),
-                  std::make_unique<juce::AudioParameterFloat>(
-                      "midFreq", "Mid Freq",
-                      juce::NormalisableRange<float>(minMidFreq, maxMidFreq),
-                      defaultMidFreq),
-                  std::make_unique<juce::AudioParameterFloat>(
-                      "midQ", "Mid Q",
-                      juce::NormalisableRange<float>(minQ, maxQ),
-                      defaultMidQ),
-                  std::make_unique<juce::AudioParameterFloat>(
-                      "highGain", "High Gain",
-                      juce::NormalisableRange<float>(minGain, maxGain),
-                      defaultHighGain),
-                  std::make_unique<juce::AudioParameterFloat>(
-                      "highFreq", "High Freq",
-                      juce::NormalisableRange<float>(minHighFreq, maxHighFreq),
-                      defaultHighFreq)})
-{
-  lowGainParam = parameters.getRawParameterValue("lowGain");
-  lowFreqParam = parameters.getRawParameterValue("lowFreq");
-  midGainParam = parameters.getRawParameterValue("midGain");
-  midFreqParam = parameters.getRawParameterValue("midFreq");
-  midQParam = parameters.getRawParameterValue("midQ");
-  highGainParam = parameters.getRawParameterValue("highGain");
-  highFreqParam = parameters.getRawParameterValue("highFreq");
+                         .withOutput("Output", juce::AudioChannelSet::stereo(), true)
+                         .withInput("Sidechain", juce::AudioChannelSet::stereo(), false)),
+      parameters(*this, nullptr, "PARAMETERS", createParameterLayout())
+{
+}
+
+juce::AudioProcessorValueTreeState::ParameterLayout Equalizer::createParameterLayout()
+{
+  juce::AudioProcessorValueTreeState::ParameterLayout layout;
+
+  juce::NormalisableRange<float> freqRange(minFreq, maxFreq);
+  freqRange.setSkewForCentre(1000.0f);
+  juce::NormalisableRange<float> qRange(minQ, maxQ);
+  qRange.setSkewForCentre(1.0f);
+  juce::NormalisableRange<float> ratioRange(1.0f, 20.0f);
+  ratioRange.setSkewForCentre(4.0f);
+  juce::NormalisableRange<float> attackRange(0.1f, 200.0f);
+  attackRange.setSkewForCentre(10.0f);
+  juce::NormalisableRange<float> releaseRange(5.0f, 2000.0f);
+  releaseRange.setSkewForCentre(150.0f);
+
+  for (int band = 0; band < numBands; ++band)
+  {
+    const juce::String name = "Band " + juce::String(band + 1) + " ";
+
+    // The rest start switched off, spread evenly across the spectrum
+    const auto defaults = band < static_cast<int>(std::size(fixedBandDefaults))
+                              ? fixedBandDefaults[band]
+                              : BandDefaults{BandType::Off, minFreq * std::pow(maxFreq / minFreq, (band + 0.5f) / numBands), 0.707f};
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>(
+                   getParameterID(band, "Type"), name + "Type",
+                   juce::StringArray("Off", "Bell", "Low Shelf", "High Shelf", "High Pass", "Low Pass", "Notch", "Band Pass"),
+                   static_cast<int>(defaults.type)),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Freq"), name + "Freq",
+                   freqRange,
+                   defaults.freq),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Gain"), name + "Gain",
+                   juce::NormalisableRange<float>(minGain, maxGain),
+                   0.0f),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Q"), name + "Q",
+                   qRange,
+                   defaults.q),
+               std::make_unique<juce::AudioParameterChoice>(
+                   getParameterID(band, "Slope"), name + "Slope",
+                   juce::StringArray("12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct"),
+                   0),
+               std::make_unique<juce::AudioParameterBool>(
+                   getParameterID(band, "Dynamic"), name + "Dynamic",
+                   false),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Threshold"), name + "Threshold",
+                   juce::NormalisableRange<float>(-60.0f, 0.0f),
+                   -20.0f),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Ratio"), name + "Ratio",
+                   ratioRange,
+                   2.0f),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Attack"), name + "Attack",
+                   attackRange,
+                   10.0f),
+               std::make_unique<juce::AudioParameterFloat>(
+                   getParameterID(band, "Release"), name + "Release",
+                   releaseRange,
+                   150.0f));
+  }
+
+  layout.add(std::make_unique<juce::AudioParameterChoice>(
+                 "phase", "Phase",
+                 juce::StringArray("Minimum", "Linear"),
+                 0),
+             std::make_unique<juce::AudioParameterChoice>(
+                 "sidechain", "Sidechain",
+                 juce::StringArray("Internal", "External"),
+                 0));
+
+  return layout;
+}
+
+juce::StringArray Equalizer::getParameterIDs()
+{
+  juce::StringArray ids;
+  for (int band = 0; band < numBands; ++band)
+    for (const auto *field : bandFieldNames)
+      ids.add(getParameterID(band, field));
+  ids.add("phase");
+  ids.add("sidechain");
+  return ids;
 }
 
 Equalizer::~Equalizer()
 {
   releaseResources();
-  lowGainParam = nullptr;
-  lowFreqParam = nullptr;
-  midGainParam = nullptr;
-  midFreqParam = nullptr;
-  midQParam = nullptr;
-  highGainParam = nullptr;
-  highFreqParam = nullptr;
 }
 
 void Equalizer::prepareToPlay(double sampleRate, int samplesPerBlock)
@@ -70,15 +140,21 @@ void Equalizer::prepareToPlay(double sampleRate, int samplesPerBlock)
   // Store sample rate and initialize processing
   currentSampleRate = sampleRate;
 
-  // Configure filters
-  juce::dsp::ProcessSpec spec;
-  spec.sampleRate = sampleRate;
-  spec.maximumBlockSize = static_cast<juce::uint32>(samplesPerBlock);
-  spec.numChannels = 2;
+  // Start the smoothers at the current values so playback doesn't open with a ramp
+  for (auto &band : bands)
+    for (auto *smoother : {&band.freq, &band.gain, &band.q})
+      smoother->prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
 
-  lowShelf.prepare(spec);
-  midPeak.prepare(spec);
-  highShelf.prepare(spec);
+  snapshot.update();
+  setSmootherTargets(snapshot.get());
+  for (auto &band : bands)
+    for (auto *smoother : {&band.freq, &band.gain, &band.q})
+      smoother->setCurrentAndTarget(smoother->getTargetValue());
+
+  // Linear phase starts from a kernel for the current settings
+  linearPhase.prepare(sampleRate, getTotalNumOutputChannels());
+  linearPhaseActive = snapshot.get().phase >= 0.5f;
+  reportLatency(linearPhaseActive ? linearPhase.getLatencySamples() : 0);
 
   // Reset state and update filters
   reset();
@@ -93,15 +169,74 @@ void Equalizer::releaseResources()
 
 void Equalizer::reset()
 {
+  linearPhase.reset();
   resetFilters();
   filtersNeedUpdate = true;
+  layoutNeedsUpdate = true;
 }
 
 void Equalizer::resetFilters()
 {
-  lowShelf.reset();
-  midPeak.reset();
-  highShelf.reset();
+  cascade.reset();
+
+  for (auto &band : bands)
+  {
+    band.detectorState[0] = band.detectorState[1] = 0.0;
+    band.envelope = minLevel;
+    band.dynamicGain = 0.0f;
+  }
+}
+
+int Equalizer::getNumStages(BandType type, int slope)
+{
+  switch (type)
+  {
+  case BandType::Off:
+    return 0;
+  case BandType::HighPass:
+  case BandType::LowPass:
+    return juce::jlimit(1, maxStages, slope + 1); // 12 dB/oct per stage
+  default:
+    return 1;
+  }
+}
+
+bool Equalizer::isBandActive(const Band &band) const
+{
+  if (band.type == BandType::Off)
+    return false;
+
+  // A bell or shelf sitting at 0 dB passes the signal straight through, unless
+  // its dynamics can cut
+  return !hasGain(band.type) || band.gain.getCurrentValue() != 0.0f || band.gain.getTargetValue() != 0.0f ||
+         band.dynamic || band.dynamicGain != 0.0f;
+}
+
+void Equalizer::updateLayout()
+{
+  // Bands that were already running with the same type and slope keep their
+  // filter state; the rest start from silence
+  int previous[BiquadCascade::maxSections];
+  int numSections = 0;
+
+  for (auto &band : bands)
+  {
+    const int stages = isBandActive(band) ? getNumStages(band.type, band.slope) : 0;
+    const bool unchanged = band.numStages == stages && band.builtType == band.type && band.builtSlope == band.slope;
+
+    for (int stage = 0; stage < stages; ++stage)
+      previous[numSections + stage] = unchanged ? band.firstSection + stage : -1;
+
+    band.firstSection = numSections;
+    band.numStages = stages;
+    band.builtType = band.type;
+    band.builtSlope = band.slope;
+    numSections += stages;
+  }
+
+  cascade.setLayout(previous, numSections);
+  layoutNeedsUpdate = false;
+  filtersNeedUpdate = true;
 }
 
 void Equalizer::updateFilters()
@@ -109,30 +244,246 @@ void Equalizer::updateFilters()
   if (!isInitialized)
     return;
 
-  const float sampleRate = static_cast<float>(currentSampleRate);
+  computeCoefficients();
+  for (int section = 0; section < cascade.getNumSections(); ++section)
+    cascade.setCoefficients(section, targetCoefficients[static_cast<size_t>(section)]);
 
-  // Get parameter values with bounds checking
-  const float lowGain = juce::jlimit(minGain, maxGain, getLowGain());
-  const float lowFreq = juce::jlimit(minLowFreq, maxLowFreq, getLowFreq());
-  const float midGain = juce::jlimit(minGain, maxGain, getMidGain());
-  const float midFreq = juce::jlimit(minMidFreq, maxMidFreq, getMidFreq());
-  const float midQ = juce::jlimit(minQ, maxQ, getMidQ());
-  const float highGain = juce::jlimit(minGain, maxGain, getHighGain());
-  const float highFreq = juce::jlimit(minHighFreq, maxHighFreq, getHighFreq());
+  filtersNeedUpdate = false;
+}
 
-  // Update low shelf filter
-  *lowShelf.state = *juce::dsp::IIR::Coefficients<float>::makeLowShelf(
-      sampleRate, lowFreq, 1.0f, juce::Decibels::decibelsToGain(lowGain));
+void Equalizer::computeCoefficients()
+{
+  for (const auto &band : bands)
+  {
+    if (band.numStages == 0)
+      continue;
 
-  // Update mid peak filter
-  *midPeak.state = *juce::dsp::IIR::Coefficients<float>::makePeakFilter(
-      sampleRate, midFreq, midQ, juce::Decibels::decibelsToGain(midGain));
+    // Use the smoothed values, which are bounds checked when their targets are set
+    designBand(band.builtType, band.numStages, currentSampleRate, band.freq.getCurrentValue(), band.q.getCurrentValue(),
+               juce::jmax(minGain, band.gain.getCurrentValue() + band.dynamicGain), targetCoefficients.data() + band.firstSection);
+  }
+}
 
-  // Update high shelf filter
-  *highShelf.state = *juce::dsp::IIR::Coefficients<float>::makeHighShelf(
-      sampleRate, highFreq, 1.0f, juce::Decibels::decibelsToGain(highGain));
+void Equalizer::designBand(BandType type, int numStages, double sampleRate, double freq, double q, double gainDb,
+                           BiquadCascade::Coefficients *sections)
+{
+  using Design = juce::dsp::IIR::ArrayCoefficients<double>;
+  freq = juce::jmin(freq, 0.48 * sampleRate);
+  const double gain = juce::Decibels::decibelsToGain(gainDb);
 
-  filtersNeedUpdate = false;
+  // The array designs return plain values, so nothing is allocated here
+  switch (type)
+  {
+  case BandType::Bell:
+    sections[0] = BiquadCascade::Coefficients::fromArray(Design::makePeakFilter(sampleRate, freq, q, gain));
+    break;
+  case BandType::LowShelf:
+    sections[0] = BiquadCascade::Coefficients::fromArray(Design::makeLowShelf(sampleRate, freq, q, gain));
+    break;
+  case BandType::HighShelf:
+    sections[0] = BiquadCascade::Coefficients::fromArray(Design::makeHighShelf(sampleRate, freq, q, gain));
+    break;
+  case BandType::Notch:
+    sections[0] = BiquadCascade::Coefficients::fromArray(Design::makeNotch(sampleRate, freq, q));
+    break;
+  case BandType::BandPass:
+    sections[0] = BiquadCascade::Coefficients::fromArray(Design::makeBandPass(sampleRate, freq, q));
+    break;
+  case BandType::HighPass:
+  case BandType::LowPass:
+  {
+    // A single stage takes the band's Q as its resonance. Steeper slopes are
+    // Butterworth, each stage taking one conjugate pole pair.
+    for (int stage = 0; stage < numStages; ++stage)
+    {
+      const double angle = juce::MathConstants<double>::pi * (2 * stage + 1) / (4.0 * numStages);
+      const double stageQ = numStages == 1 ? q : 1.0 / (2.0 * std::cos(angle));
+
+      sections[stage] = BiquadCascade::Coefficients::fromArray(type == BandType::HighPass
+                                                                   ? Design::makeHighPass(sampleRate, freq, stageQ)
+                                                                   : Design::makeLowPass(sampleRate, freq, stageQ));
+    }
+    break;
+  }
+  case BandType::Off:
+    break;
+  }
+}
+
+void Equalizer::getMagnitudeResponse(const ParameterValues &values, double sampleRate, const double *frequencies,
+                                     float *magnitudes, int count)
+{
+  // Every section needs the same cos(w) and cos(2w), so they are worked out
+  // once and the sections multiply their power responses together
+  std::vector<double> cosW(static_cast<size_t>(count));
+  std::vector<double> cos2W(static_cast<size_t>(count));
+  std::vector<double> power(static_cast<size_t>(count), 1.0);
+  for (int i = 0; i < count; ++i)
+  {
+    const double w = juce::MathConstants<double>::twoPi * frequencies[i] / sampleRate;
+    cosW[static_cast<size_t>(i)] = std::cos(w);
+    cos2W[static_cast<size_t>(i)] = std::cos(2.0 * w);
+  }
+
+  for (const auto &band : values.bands)
+  {
+    const auto type = static_cast<BandType>(juce::jlimit(0, static_cast<int>(BandType::BandPass), static_cast<int>(band.type)));
+    const int numStages = getNumStages(type, static_cast<int>(band.slope));
+    if (numStages == 0)
+      continue;
+
+    BiquadCascade::Coefficients sections[maxStages];
+    designBand(type, numStages, sampleRate, juce::jlimit(minFreq, maxFreq, band.freq), juce::jlimit(minQ, maxQ, band.q),
+               juce::jlimit(minGain, maxGain, band.gain), sections);
+
+    for (int stage = 0; stage < numStages; ++stage)
+      sections[stage].multiplyPowerResponse(cosW.data(), cos2W.data(), power.data(), count);
+  }
+
+  for (int i = 0; i < count; ++i)
+    magnitudes[i] = static_cast<float>(std::sqrt(power[static_cast<size_t>(i)]));
+}
+
+void Equalizer::setLinearPhase(bool shouldBeLinear)
+{
+  if (shouldBeLinear == linearPhaseActive)
+    return;
+
+  // Each path starts from silence, as its state is stale. The new latency is
+  // reported straight away so the rack can realign.
+  linearPhaseActive = shouldBeLinear;
+  if (linearPhaseActive)
+  {
+    linearPhase.reset();
+    linearPhase.requestDesign();
+  }
+  else
+  {
+    resetFilters();
+    filtersNeedUpdate = true;
+  }
+
+  reportLatency(linearPhaseActive ? linearPhase.getLatencySamples() : 0);
+}
+
+void Equalizer::setSmootherTargets(const ParameterValues &values)
+{
+  for (int index = 0; index < numBands; ++index)
+  {
+    auto &band = bands[static_cast<size_t>(index)];
+    const auto &value = values.bands[index];
+
+    const auto type = static_cast<BandType>(juce::jlimit(0, static_cast<int>(BandType::BandPass), static_cast<int>(value.type)));
+    const int slope = juce::jlimit(0, maxStages - 1, static_cast<int>(value.slope));
+    if (type != band.type || slope != band.slope)
+    {
+      band.type = type;
+      band.slope = slope;
+      layoutNeedsUpdate = true;
+    }
+
+    band.freq.setTarget(juce::jlimit(minFreq, maxFreq, value.freq));
+    band.gain.setTarget(juce::jlimit(minGain, maxGain, value.gain));
+    band.q.setTarget(juce::jlimit(minQ, maxQ, value.q));
+
+    band.dynamic = value.dynamic >= 0.5f && hasGain(type);
+    band.threshold = juce::jlimit(-60.0f, 0.0f, value.threshold);
+    band.ratio = juce::jlimit(1.0f, 20.0f, value.ratio);
+    band.attackMs = juce::jlimit(0.1f, 200.0f, value.attack);
+    band.releaseMs = juce::jlimit(5.0f, 2000.0f, value.release);
+  }
+}
+
+bool Equalizer::hasDynamics() const
+{
+  for (const auto &band : bands)
+    if (band.numStages > 0 && (band.dynamic || band.dynamicGain != 0.0f))
+      return true;
+
+  return false;
+}
+
+void Equalizer::updateDynamics(const juce::AudioBuffer<float> &source, int start, int length)
+{
+  // The detectors share one mono mix of the level source
+  const int numChannels = juce::jmin(2, source.getNumChannels());
+  std::fill(detectorInput.begin(), detectorInput.begin() + length, 0.0f);
+  for (int channel = 0; channel < numChannels; ++channel)
+    juce::FloatVectorOperations::addWithMultiply(detectorInput.data(), source.getReadPointer(channel, start),
+                                                 1.0f / numChannels, length);
+
+  const double subBlockMs = 1000.0 * length / currentSampleRate;
+
+  for (auto &band : bands)
+  {
+    if (band.numStages == 0)
+      continue;
+
+    // A band that stops being dynamic lets go of its cut at the release rate
+    if (!band.dynamic)
+    {
+      band.dynamicGain *= static_cast<float>(std::exp(-subBlockMs / band.releaseMs));
+      if (std::abs(band.dynamicGain) < 0.01f)
+        band.dynamicGain = 0.0f;
+      continue;
+    }
+
+    // Shelves listen below or above their corner, bells around their centre
+    const float freq = band.freq.getCurrentValue();
+    const float q = band.q.getCurrentValue();
+    if (freq != band.detectorFreq || q != band.detectorQ)
+    {
+      using Design = juce::dsp::IIR::ArrayCoefficients<double>;
+      const double f = juce::jmin(static_cast<double>(freq), 0.48 * currentSampleRate);
+      band.detector = BiquadCascade::Coefficients::fromArray(
+          band.type == BandType::LowShelf    ? Design::makeLowPass(currentSampleRate, f)
+          : band.type == BandType::HighShelf ? Design::makeHighPass(currentSampleRate, f)
+                                             : Design::makeBandPass(currentSampleRate, f, q));
+      band.detectorFreq = freq;
+      band.detectorQ = q;
+    }
+
+    // Mean square of the band's part of the source over the sub-block
+    const auto &c = band.detector;
+    double s1 = band.detectorState[0];
+    double s2 = band.detectorState[1];
+    double sum = 0.0;
+    for (int i = 0; i < length; ++i)
+    {
+      const double x = detectorInput[static_cast<size_t>(i)];
+      const double y = c.b0 * x + s1;
+      s1 = c.b1 * x - c.a1 * y + s2;
+      s2 = c.b2 * x - c.a2 * y;
+      sum += y * y;
+    }
+    band.detectorState[0] = s1;
+    band.detectorState[1] = s2;
+
+    // Follow the level in dB, one step per sub-block, and compress what is
+    // over the threshold
+    const float level = juce::jmax(minLevel, static_cast<float>(10.0 * std::log10(sum / length + 1.0e-20)));
+    const float timeMs = level > band.envelope ? band.attackMs : band.releaseMs;
+    band.envelope = level + (band.envelope - level) * static_cast<float>(std::exp(-subBlockMs / timeMs));
+
+    const float over = band.envelope - band.threshold;
+    band.dynamicGain = over > 0.0f ? -over * (1.0f - 1.0f / band.ratio) : 0.0f;
+  }
+}
+
+void Equalizer::advanceSmoothers(int numSamples)
+{
+  for (auto &band : bands)
+    for (auto *smoother : {&band.freq, &band.gain, &band.q})
+      smoother->skip(numSamples);
+}
+
+bool Equalizer::isSmoothing() const
+{
+  for (const auto &band : bands)
+    if (band.numStages > 0 && (band.freq.isSmoothing() || band.gain.isSmoothing() || band.q.isSmoothing()))
+      return true;
+
+  return false;
 }
 
 void Equalizer::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
@@ -145,20 +496,75 @@ void Equalizer::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer
     return; // Pass through audio unchanged when bypassed
   }
 
-  // Update filters if needed
-  if (filtersNeedUpdate)
+  // Filter the main bus only; the sidechain is just listened to
+  auto mainBuffer = getBusBuffer(buffer, false, 0);
+  juce::dsp::AudioBlock<float> block(mainBuffer);
+  const int numSamples = buffer.getNumSamples();
+
+  // New targets only when a parameter actually moved
+  if (snapshot.update())
   {
-    updateFilters();
-    filtersNeedUpdate = false;
+    setSmootherTargets(snapshot.get());
+    setLinearPhase(snapshot.get().phase >= 0.5f);
+
+    if (linearPhaseActive)
+      linearPhase.requestDesign();
   }
 
-  // Create an AudioBlock that references the entire buffer
-  juce::dsp::AudioBlock<float> block(buffer);
+  // Linear phase applies the response designed from the targets, so the
+  // smoothers only need to keep up for a switch back
+  if (linearPhaseActive)
+  {
+    advanceSmoothers(numSamples);
+    linearPhase.process(mainBuffer, numSamples);
+    return;
+  }
+
+  // Bands join and leave the cascade as they are switched on and off, and as
+  // bells and shelves move away from or settle at 0 dB
+  for (const auto &band : bands)
+    if ((band.numStages > 0) != isBandActive(band))
+      layoutNeedsUpdate = true;
+
+  if (layoutNeedsUpdate)
+    updateLayout();
+
+  // Static parameters: one coefficient update at most, then the whole block in one go
+  const bool dynamics = hasDynamics();
+  if (!isSmoothing() && !dynamics)
+  {
+    advanceSmoothers(numSamples);
+    if (filtersNeedUpdate)
+      updateFilters();
+
+    cascade.process(block);
+    return;
+  }
 
-  // Process through each filter
-  lowShelf.process(juce::dsp::ProcessContextReplacing<float>(block));
-  midPeak.process(juce::dsp::ProcessContextReplacing<float>(block));
-  highShelf.process(juce::dsp::ProcessContextReplacing<float>(block));
+  // Ramping parameters: work out where the coefficients should be at the end of
+  // each short sub-block and glide there across it. After a reset the glide
+  // starts from the values before this block rather than from a flat filter.
+  // Dynamic bands are measured on the same sub-blocks, from the input before
+  // it is filtered, or from the sidechain when it is selected and connected.
+  if (filtersNeedUpdate)
+    updateFilters();
+
+  auto *sidechainBus = getBus(true, 1);
+  const bool external = snapshot.get().sidechain >= 0.5f && sidechainBus != nullptr && sidechainBus->isEnabled() &&
+                        sidechainBus->getNumberOfChannels() > 0;
+  const auto levelSource = getBusBuffer(buffer, true, external ? 1 : 0);
+
+  for (int start = 0; start < numSamples; start += coefficientUpdateInterval)
+  {
+    const int length = juce::jmin(coefficientUpdateInterval, numSamples - start);
+    auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+    advanceSmoothers(length);
+    if (dynamics)
+      updateDynamics(levelSource, start, length);
+    computeCoefficients();
+    cascade.process(subBlock, targetCoefficients.data());
+  }
 }
 
 juce::AudioProcessorEditor *Equalizer::createEditor()
@@ -181,6 +587,11 @@ void Equalizer::setStateInformation(const void *data, int sizeInBytes)
 
     if (xmlState != nullptr && xmlState->hasTagName(parameters.state.getType()))
     {
+      for (auto *parameter : xmlState->getChildIterator())
+        for (const auto &[legacyID, bandID] : legacyParameterIDs)
+          if (parameter->getStringAttribute("id") == legacyID)
+            parameter->setAttribute("id", bandID);
+
       parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
 
       // Mark filters for update and reset processing state
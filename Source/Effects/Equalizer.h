@@ -11,32 +11,70 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-class Equalizer : public juce::AudioProcessor
+#include "BiquadCascade.h"
+#include "LatencyReporter.h"
+#include "LinearPhaseFilter.h"
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
+
+// Parametric EQ with up to numBands bands of any type. Every active band runs
+// in one BiquadCascade pass, and bands that currently do nothing (switched
+// off, or a bell or shelf at 0 dB) are left out of it altogether.
+//
+// Bells and shelves can also be dynamic: they cut further as the level in
+// their own range rises above a threshold, like a compressor on that band. The
+// level comes from the input, or from the sidechain bus when that is enabled
+// and selected. It is measured once per sub-block, and the band's coefficients
+// glide from one measurement to the next.
+//
+// In linear phase mode the bands' static response is applied by a
+// LinearPhaseFilter instead, which adds latency and reports it to the host.
+class Equalizer : public juce::AudioProcessor,
+                  public LatencyReporter
 {
 public:
+  enum class BandType
+  {
+    Off,
+    Bell,
+    LowShelf,
+    HighShelf,
+    HighPass, // 12 to 48 dB/oct
+    LowPass,  // 12 to 48 dB/oct
+    Notch,
+    BandPass
+  };
+
+  static constexpr int numBands = 16;
+  static constexpr int maxStages = 4; // Biquads per band, for 48 dB/oct
+
   Equalizer();
   ~Equalizer() override;
 
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
-  void reset();
+  void reset() override;
 
   void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
 
   juce::AudioProcessorEditor *createEditor() override;
   bool hasEditor() const override { return true; }
 
-  const juce::String getName() const override { return JucePlugin_Name; }
+  const juce::String getName() const override { return "EQ"; }
 
   bool acceptsMidi() const override { return false; }
   bool producesMidi() const override { return false; }
   bool isMidiEffect() const override { return false; }
   double getTailLengthSeconds() const override { return 0.0; }
 
+  bool isLinearPhase() const { return linearPhaseActive; }
+
   bool isBypassed() const { return bypassed; }
   void setBypassed(bool shouldBeBypassed) { bypassed = shouldBeBypassed; }
 
+  // Where the rack's morph writes this effect's parameters
+  ParameterOverrides &getParameterOverrides() { return sharedOverrides; }
+
   int getNumPrograms() override { return 1; }
   int getCurrentProgram() override { return 0; }
   void setCurrentProgram(int index) override {}
@@ -46,70 +84,163 @@ public:
   void getStateInformation(juce::MemoryBlock &destData) override;
   void setStateInformation(const void *data, int sizeInBytes) override;
 
-  // Parameter access methods with bounds checking
-  float getLowGain() const { return lowGainParam != nullptr ? lowGainParam->load() : defaultLowGain; }
-  float getLowFreq() const { return lowFreqParam != nullptr ? lowFreqParam->load() : defaultLowFreq; }
-  float getMidGain() const { return midGainParam != nullptr ? midGainParam->load() : defaultMidGain; }
-  float getMidFreq() const { return midFreqParam != nullptr ? midFreqParam->load() : defaultMidFreq; }
-  float getMidQ() const { return midQParam != nullptr ? midQParam->load() : defaultMidQ; }
-  float getHighGain() const { return highGainParam != nullptr ? highGainParam->load() : defaultHighGain; }
-  float getHighFreq() const { return highFreqParam != nullptr ? highFreqParam->load() : defaultHighFreq; }
+  // Parameter IDs are "band1Type", "band1Freq" and so on, counting bands from 1
+  static juce::String getParameterID(int band, const juce::String &name) { return "band" + juce::String(band + 1) + name; }
+
+  // Parameter values, as loaded by a ParameterSnapshot over getParameterIDs()
+  struct BandValues
+  {
+    float type;      // BandType index
+    float freq;      // Hz
+    float gain;      // dB, for bells and shelves
+    float q;         // Width, or resonance for 12 dB/oct passes
+    float slope;     // Index into 12, 24, 36, 48 dB/oct
+    float dynamic;   // 0 or 1
+    float threshold; // dB
+    float ratio;     // Above the threshold
+    float attack;    // ms
+    float release;   // ms
+  };
+  struct alignas(64) ParameterValues
+  {
+    BandValues bands[numBands];
+    float phase;     // 0 minimum, 1 linear
+    float sidechain; // 0 internal, 1 external
+  };
+  static juce::StringArray getParameterIDs();
+
+  // Fills magnitudes with the linear gain of the bands' static settings at
+  // count frequencies. Any thread.
+  static void getMagnitudeResponse(const ParameterValues &values, double sampleRate, const double *frequencies,
+                                   float *magnitudes, int count);
 
   // Audio processor value tree
   juce::AudioProcessorValueTreeState parameters;
 
 private:
-  // Parameter pointers
-  std::atomic<float> *lowGainParam = nullptr;  // Low shelf gain
-  std::atomic<float> *lowFreqParam = nullptr;  // Low shelf frequency
-  std::atomic<float> *midGainParam = nullptr;  // Mid peak gain
-  std::atomic<float> *midFreqParam = nullptr;  // Mid peak frequency
-  std::atomic<float> *midQParam = nullptr;     // Mid peak Q
-  std::atomic<float> *highGainParam = nullptr; // High shelf gain
-  std::atomic<float> *highFreqParam = nullptr; // High shelf frequency
-
-  // Filter processors
-  juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> lowShelf;
-  juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> midPeak;
-  juce::dsp::ProcessorDuplicator<juce::dsp::IIR::Filter<float>, juce::dsp::IIR::Coefficients<float>> highShelf;
+  // Loaded once per block
+  ParameterSnapshot<ParameterValues> snapshot{parameters, getParameterIDs()};
+
+  // The linear phase designer reads the parameters on its own thread
+  ParameterSnapshot<ParameterValues> designSnapshot{parameters, getParameterIDs()};
+  LinearPhaseFilter linearPhase{[this](const double *frequencies, float *magnitudes, int count)
+                                {
+                                  designSnapshot.update();
+                                  getMagnitudeResponse(designSnapshot.get(), currentSampleRate, frequencies, magnitudes, count);
+                                }};
+
+  // Overrides go to both snapshots, so a linear phase response is designed
+  // from the same values the audio thread sees
+  struct SharedOverrides : ParameterOverrides
+  {
+    SharedOverrides(ParameterOverrides &audio, ParameterOverrides &design) : audioOverrides(audio), designOverrides(design) {}
+
+    int findParameter(const juce::String &parameterID) const override { return audioOverrides.findParameter(parameterID); }
+
+    void setOverride(int index, float value) override
+    {
+      audioOverrides.setOverride(index, value);
+      designOverrides.setOverride(index, value);
+    }
+
+    void clearOverrides() override
+    {
+      audioOverrides.clearOverrides();
+      designOverrides.clearOverrides();
+    }
+
+    ParameterOverrides &audioOverrides;
+    ParameterOverrides &designOverrides;
+  };
+  SharedOverrides sharedOverrides{snapshot, designSnapshot};
+  bool linearPhaseActive = false;
+
+  static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
+
+  struct Band
+  {
+    // Gain ramps in dB, frequency and Q by ratio
+    ParameterSmoother freq{ParameterSmoother::Ramp::Multiplicative};
+    ParameterSmoother gain;
+    ParameterSmoother q{ParameterSmoother::Ramp::Multiplicative};
+    BandType type = BandType::Off;
+    int slope = 0;
+
+    // Where the band sits in the cascade, and what its sections were built
+    // for. No stages when it is left out.
+    int firstSection = 0;
+    int numStages = 0;
+    BandType builtType = BandType::Off;
+    int builtSlope = 0;
+
+    // Dynamics. The detector filters the band's range out of the level source,
+    // and its output level follows in dB with the attack and release times.
+    bool dynamic = false;
+    float threshold = 0.0f;
+    float ratio = 1.0f;
+    float attackMs = 10.0f;
+    float releaseMs = 100.0f;
+    BiquadCascade::Coefficients detector;
+    double detectorState[2] = {};
+    float detectorFreq = 0.0f; // Settings the detector was designed for
+    float detectorQ = 0.0f;
+    float envelope = minLevel;
+    float dynamicGain = 0.0f; // dB added to the band's gain
+  };
+  std::array<Band, numBands> bands;
+
+  BiquadCascade cascade;
+
+  // Coefficients for the current smoothed values, computed in place, one per
+  // cascade section
+  std::array<BiquadCascade::Coefficients, BiquadCascade::maxSections> targetCoefficients;
+
+  // While any value ramps or any band is dynamic, coefficients are recomputed
+  // this often and glide from one update to the next in between
+  static constexpr int coefficientUpdateInterval = 32;
+
+  // Mono level source for the current sub-block
+  std::array<float, coefficientUpdateInterval> detectorInput{};
 
   // Processing state
   double currentSampleRate = 0.0; // Initialize to 0 to indicate not set
   bool isInitialized = false;
   bool filtersNeedUpdate = true;
+  bool layoutNeedsUpdate = true;
 
   // Sample rate validation
   static constexpr double MIN_SAMPLE_RATE = 8000.0;   // Minimum valid sample rate
   static constexpr double MAX_SAMPLE_RATE = 192000.0; // Maximum valid sample rate
   bool isSampleRateValid() const { return currentSampleRate >= MIN_SAMPLE_RATE && currentSampleRate <= MAX_SAMPLE_RATE; }
 
-  // Parameter ranges and defaults
+  // Parameter ranges
   static constexpr float minGain = -24.0f;
   static constexpr float maxGain = 24.0f;
-  static constexpr float defaultLowGain = 0.0f;
-  static constexpr float defaultMidGain = 0.0f;
-  static constexpr float defaultHighGain = 0.0f;
-
-  static constexpr float minLowFreq = 20.0f;
-  static constexpr float maxLowFreq = 1000.0f;
-  static constexpr float defaultLowFreq = 100.0f;
-
-  static constexpr float minMidFreq = 200.0f;
-  static constexpr float maxMidFreq = 5000.0f;
-  static constexpr float defaultMidFreq = 1000.0f;
-
-  static constexpr float minHighFreq = 1000.0f;
-  static constexpr float maxHighFreq = 20000.0f;
-  static constexpr float defaultHighFreq = 10000.0f;
-
+  static constexpr float minFreq = 20.0f;
+  static constexpr float maxFreq = 20000.0f;
   static constexpr float minQ = 0.1f;
   static constexpr float maxQ = 10.0f;
-  static constexpr float defaultMidQ = 1.0f;
+  static constexpr float minLevel = -100.0f; // dB, the detector's floor
 
   std::atomic<bool> bypassed{false}; // Add bypass state
 
   void updateFilters();
+  void computeCoefficients();
+  void setLinearPhase(bool shouldBeLinear);
+  void updateLayout();
   void resetFilters();
+  void setSmootherTargets(const ParameterValues &values);
+  void advanceSmoothers(int numSamples);
+  bool isSmoothing() const;
+  bool isBandActive(const Band &band) const;
+  bool hasDynamics() const;
+  void updateDynamics(const juce::AudioBuffer<float> &source, int start, int length);
+  static bool hasGain(BandType type) { return type == BandType::Bell || type == BandType::LowShelf || type == BandType::HighShelf; }
+  static int getNumStages(BandType type, int slope);
+
+  // Fills numStages sections for a band with the given settings
+  static void designBand(BandType type, int numStages, double sampleRate, double freq, double q, double gainDb,
+                         BiquadCascade::Coefficients *sections);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Equalizer)
 };
@@ -0,0 +1,240 @@
+/*
+  ==============================================================================
+
+    FeedbackDelayNetwork.cpp
+    Created: 18 Oct 2026 7:36:12pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "FeedbackDelayNetwork.h"
+
+namespace
+{
+  // Same dry scaling as juce::Reverb, with the wet scaled to match its loudness
+  constexpr float dryScale = 2.0f;
+  constexpr float wetScale = 1.2f;
+
+  // Entry of a Sylvester Hadamard matrix, so distinct rows are orthogonal
+  float hadamardSign(int row, int column)
+  {
+    int bits = row & column;
+    int parity = 0;
+    for (; bits != 0; bits &= bits - 1)
+      parity ^= 1;
+    return parity != 0 ? -1.0f : 1.0f;
+  }
+}
+
+void FeedbackDelayNetwork::prepare(double newSampleRate, int maximumBlockSize)
+{
+  sampleRate = newSampleRate;
+  const double scale = sampleRate / 48000.0;
+
+  modulationDepth = static_cast<float>(modulationDepthSeconds * sampleRate);
+
+  // Room for the longest line plus its modulation and the interpolation tap
+  const int longest = static_cast<int>(std::ceil(baseLengths.back() * scale + modulationDepth)) + 2;
+  const int memoryLength = juce::nextPowerOfTwo(longest);
+  memory.assign(static_cast<size_t>(memoryLength * numVectors), Vector::expand(0.0f));
+  memoryMask = memoryLength - 1;
+
+  for (int line = 0; line < numLines; ++line)
+  {
+    lengths[static_cast<size_t>(line)] = static_cast<int>(std::round(baseLengths[static_cast<size_t>(line)] * scale));
+
+    setLane(inputSigns, line, hadamardSign(15, line));
+    setLane(leftSigns, line, hadamardSign(3, line));
+    setLane(rightSigns, line, hadamardSign(12, line));
+  }
+
+  // Each modulated line wobbles at its own slow rate, starting at its own phase
+  for (size_t lane = 0; lane < static_cast<size_t>(lanes); ++lane)
+  {
+    const double rate = 0.3 + 0.6 * static_cast<double>(lane) / (lanes - 1);
+    const double phase = juce::MathConstants<double>::twoPi * static_cast<double>(lane) / lanes;
+    const double step = juce::MathConstants<double>::twoPi * rate / sampleRate;
+    modulatedLengths.set(lane, static_cast<float>(lengths[lane]));
+    modulationSin.set(lane, static_cast<float>(std::sin(phase)));
+    modulationCos.set(lane, static_cast<float>(std::cos(phase)));
+    rotationSin.set(lane, static_cast<float>(std::sin(step)));
+    rotationCos.set(lane, static_cast<float>(std::cos(step)));
+  }
+
+  for (auto *smoother : {&wet1Smoother, &wet2Smoother, &dryLevelSmoother})
+    smoother->prepare(sampleRate, ParameterSmoother::defaultRampSeconds, maximumBlockSize);
+  hasParameters = false;
+
+  reset();
+}
+
+void FeedbackDelayNetwork::reset()
+{
+  std::fill(memory.begin(), memory.end(), Vector::expand(0.0f));
+  absorptionState.fill(Vector::expand(0.0f));
+  writeIndex = 0;
+}
+
+void FeedbackDelayNetwork::setParameters(const juce::Reverb::Parameters &parameters)
+{
+  const bool freeze = parameters.freezeMode >= 0.5f;
+
+  // Room size sets the low-frequency decay time, 0.2 s to 10 s. Damping
+  // shortens the decay at Nyquist relative to it, down to a tenth.
+  const double decaySeconds = 0.2 * std::pow(50.0, static_cast<double>(parameters.roomSize));
+  const double nyquistRatio = 1.0 - 0.9 * static_cast<double>(parameters.damping);
+
+  for (int line = 0; line < numLines; ++line)
+  {
+    const double length = lengths[static_cast<size_t>(line)];
+    const double gain = freeze ? 1.0 : std::pow(10.0, -3.0 * length / (sampleRate * decaySeconds));
+
+    // Jot's one-pole absorption filter for the requested high-frequency decay
+    const double pole = freeze ? 0.0 : std::log(10.0) / 4.0 * std::log10(gain) * (1.0 - 1.0 / (nyquistRatio * nyquistRatio));
+
+    setLane(feedbackGains, line, static_cast<float>(gain));
+    setLane(absorption, line, static_cast<float>(juce::jlimit(0.0, 0.95, pole)));
+  }
+
+  lineInputGain = freeze ? 0.0f : inputGain;
+
+  const float wet = parameters.wetLevel * wetScale;
+  const float wet1 = wet * (parameters.width * 0.5f + 0.5f);
+  const float wet2 = wet * (1.0f - parameters.width) * 0.5f;
+  const float dry = parameters.dryLevel * dryScale;
+
+  if (hasParameters)
+  {
+    wet1Smoother.setTarget(wet1);
+    wet2Smoother.setTarget(wet2);
+    dryLevelSmoother.setTarget(dry);
+  }
+  else
+  {
+    wet1Smoother.setCurrentAndTarget(wet1);
+    wet2Smoother.setCurrentAndTarget(wet2);
+    dryLevelSmoother.setCurrentAndTarget(dry);
+    hasParameters = true;
+  }
+}
+
+void FeedbackDelayNetwork::processStereo(float *left, float *right, int numSamples)
+{
+  if (memory.empty())
+    return;
+
+  const auto wet1 = wet1Smoother.processBlock(numSamples);
+  const auto wet2 = wet2Smoother.processBlock(numSamples);
+  const auto dry = dryLevelSmoother.processBlock(numSamples);
+
+  const float *samples = reinterpret_cast<const float *>(memory.data());
+  const float hadamardScale = 1.0f / std::sqrt(static_cast<float>(numVectors));
+  const float householderScale = 2.0f / lanes;
+  alignas(sizeof(Vector)) float delays[lanes];
+  alignas(sizeof(Vector)) float delayed[numLines];
+
+  // Work on local copies so the compiler can keep them in registers instead of
+  // reloading them after every store to left and right
+  const auto lineLengths = lengths;
+  const auto centreLengths = modulatedLengths;
+  const auto gains = feedbackGains;
+  const auto poles = absorption;
+  const auto stepSin = rotationSin;
+  const auto stepCos = rotationCos;
+  const auto inputPattern = inputSigns;
+  const auto leftPattern = leftSigns;
+  const auto rightPattern = rightSigns;
+  auto sine = modulationSin;
+  auto cosine = modulationCos;
+  auto filters = absorptionState;
+  const float depth = modulationDepth;
+  const float gainIn = lineInputGain;
+  const int mask = memoryMask;
+  int position = writeIndex;
+
+  for (int sample = 0; sample < numSamples; ++sample)
+  {
+    const float input = (left[sample] + right[sample]) * 0.5f * gainIn;
+
+    // Step the oscillators and work out the modulated read positions
+    const auto lastSine = sine;
+    sine = lastSine * stepCos + cosine * stepSin;
+    cosine = cosine * stepCos - lastSine * stepSin;
+    (centreLengths + sine * depth).copyToRawArray(delays);
+
+    // The scalar step: gather each line's output. The modulated lines are
+    // interpolated; offsetting by the memory length keeps their positions
+    // positive, so truncation is floor and no libm call is needed.
+    const float base = static_cast<float>(position + mask + 1);
+    for (int line = 0; line < lanes; ++line)
+    {
+      const float readPosition = base - delays[line];
+      const int index = static_cast<int>(readPosition);
+      const float fraction = readPosition - static_cast<float>(index);
+
+      const float a = samples[(index & mask) * numLines + line];
+      const float b = samples[((index + 1) & mask) * numLines + line];
+      delayed[line] = a + (b - a) * fraction;
+    }
+
+    for (int line = lanes; line < numLines; ++line)
+      delayed[line] = samples[((position - lineLengths[static_cast<size_t>(line)]) & mask) * numLines + line];
+
+    // Absorb and decay, collecting the outputs on the way
+    LineVectors decayed;
+    auto leftSum = Vector::expand(0.0f);
+    auto rightSum = Vector::expand(0.0f);
+
+    for (size_t v = 0; v < numVectors; ++v)
+    {
+      const auto x = Vector::fromRawArray(delayed + v * lanes);
+      filters[v] = x + (filters[v] - x) * poles[v];
+      decayed[v] = filters[v] * gains[v];
+
+      leftSum = leftSum + decayed[v] * leftPattern[v];
+      rightSum = rightSum + decayed[v] * rightPattern[v];
+    }
+
+    // Mix: a Hadamard transform across the vectors, then a Householder
+    // reflection within each one. Both are orthogonal, so no energy is gained
+    // or lost, and every line reaches every other line on each pass.
+    for (size_t half = 1; half < numVectors; half *= 2)
+      for (size_t first = 0; first < numVectors; first += 2 * half)
+        for (size_t v = first; v < first + half; ++v)
+        {
+          const auto a = decayed[v];
+          const auto b = decayed[v + half];
+          decayed[v] = a + b;
+          decayed[v + half] = a - b;
+        }
+
+    Vector *destination = memory.data() + position * numVectors;
+    for (size_t v = 0; v < numVectors; ++v)
+    {
+      const auto scaled = decayed[v] * hadamardScale;
+      destination[v] = scaled - Vector::expand(scaled.sum() * householderScale) + inputPattern[v] * input;
+    }
+
+    position = (position + 1) & mask;
+
+    const float outLeft = leftSum.sum();
+    const float outRight = rightSum.sum();
+    const float dryLevel = dry[sample];
+    left[sample] = outLeft * wet1[sample] + outRight * wet2[sample] + left[sample] * dryLevel;
+    right[sample] = outRight * wet1[sample] + outLeft * wet2[sample] + right[sample] * dryLevel;
+  }
+
+  writeIndex = position;
+  absorptionState = filters;
+
+  // Keep the oscillators from drifting off the unit circle
+  for (size_t lane = 0; lane < static_cast<size_t>(lanes); ++lane)
+  {
+    const float s = sine.get(lane);
+    const float c = cosine.get(lane);
+    const float norm = 1.0f / std::sqrt(s * s + c * c);
+    modulationSin.set(lane, s * norm);
+    modulationCos.set(lane, c * norm);
+  }
+}
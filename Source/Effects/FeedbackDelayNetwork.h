@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    FeedbackDelayNetwork.h
+    Created: 18 Oct 2026 7:36:12pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSmoother.h"
+#include <array>
+#include <vector>
+
+// A 16-line feedback delay network reverb. Each pass through the feedback
+// matrix sends every line into every other line, so echo density builds far
+// faster than in juce::Reverb's parallel combs. The lines are processed
+// together as SIMD vectors: their samples are stored interleaved, so a sample
+// of all 16 lines is written with a few vector stores and only the reads are
+// gathered one line at a time.
+//
+// The first vector's worth of lines have slowly modulated lengths to break up
+// metallic resonances, and every line has a one-pole absorption filter so high
+// frequencies die away faster than lows. Takes the same parameters as
+// juce::Reverb so it can stand in for it.
+class FeedbackDelayNetwork
+{
+public:
+  static constexpr int numLines = 16;
+
+  // Allocates, so call from prepareToPlay
+  void prepare(double sampleRate, int maximumBlockSize);
+  void reset();
+
+  // Recomputes the per-line gains and filters. Doesn't allocate.
+  void setParameters(const juce::Reverb::Parameters &parameters);
+
+  void processStereo(float *left, float *right, int numSamples);
+
+private:
+  using Vector = juce::dsp::SIMDRegister<float>;
+  static constexpr int lanes = static_cast<int>(Vector::SIMDNumElements);
+  static constexpr int numVectors = numLines / lanes;
+  static_assert(numLines % lanes == 0, "Lines must fill whole SIMD vectors");
+
+  using LineVectors = std::array<Vector, numVectors>;
+
+  // Line lengths in samples at 48 kHz: primes spread geometrically over 10-45 ms
+  static constexpr std::array<int, numLines> baseLengths{487, 541, 587, 653, 719, 797, 877, 971,
+                                                         1087, 1187, 1319, 1447, 1601, 1777, 1973, 2161};
+  static constexpr double modulationDepthSeconds = 0.00012;
+  static constexpr float inputGain = 0.3f;
+
+  double sampleRate = 48000.0;
+  float modulationDepth = 0.0f;
+
+  // Interleaved delay memory: one group of vectors per sample, numLines floats wide
+  std::vector<Vector> memory;
+  int memoryMask = 0;
+  int writeIndex = 0;
+
+  std::array<int, numLines> lengths{};
+  LineVectors feedbackGains{};
+  LineVectors absorption{};      // One-pole coefficient per line
+  LineVectors absorptionState{}; // One-pole memory per line
+
+  // Quadrature oscillators modulating the first vector of lines
+  Vector modulatedLengths{};
+  Vector modulationSin{};
+  Vector modulationCos{};
+  Vector rotationSin{};
+  Vector rotationCos{};
+
+  // Orthogonal +/-1 patterns spreading the input and collecting each output
+  LineVectors inputSigns{};
+  LineVectors leftSigns{};
+  LineVectors rightSigns{};
+
+  float lineInputGain = inputGain;
+  ParameterSmoother wet1Smoother;
+  ParameterSmoother wet2Smoother;
+  ParameterSmoother dryLevelSmoother;
+  bool hasParameters = false; // The first parameters after prepare() apply without a ramp
+
+  static void setLane(LineVectors &vectors, int line, float value) { vectors[static_cast<size_t>(line / lanes)].set(static_cast<size_t>(line % lanes), value); }
+};
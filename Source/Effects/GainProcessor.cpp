@@ -23,14 +23,13 @@ GainProcessor::GainProcessor(bool isInput)
                      juce::String(), // Label
                      juce::AudioProcessorParameter::genericParameter,
                      [](float value, int)
-                     { return juce::String(value, 1) + " dB"; })})
+                     { return juce::String(value, 1) + " dB"; })}),
+      snapshot(parameters, {isInput ? "input_gain" : "output_gain"})
 {
-    gainParam = parameters.getRawParameterValue(isInput ? "input_gain" : "output_gain");
 }
 
 GainProcessor::~GainProcessor()
 {
-    gainParam = nullptr;
 }
 
 //=============================================
@@ -85,6 +84,11 @@ void GainProcessor::changeProgramName(int index, const juce::String &newName)
 void GainProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     currentSampleRate = sampleRate;
+
+    // Start at the current gain so playback doesn't open with a ramp
+    gainSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, samplesPerBlock);
+    snapshot.update();
+    gainSmoother.setCurrentAndTarget(juce::Decibels::decibelsToGain(snapshot.get().gain));
 }
 
 void GainProcessor::releaseResources()
@@ -117,20 +121,65 @@ void GainProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuf
     }
 
     // Get the current gain value in dB
-    float gainDB = gainParam != nullptr ? gainParam->load() : defaultGain;
+    snapshot.update();
+    float gainDB = snapshot.get().gain;
 
-    // Convert dB to linear gain
-    float linearGain = juce::Decibels::decibelsToGain(gainDB);
+    // Convert dB to linear gain and ramp towards it
+    gainSmoother.setTarget(juce::Decibels::decibelsToGain(gainDB));
+    const int numSamples = buffer.getNumSamples();
+    const auto gain = gainSmoother.processBlock(numSamples);
 
-    // Apply gain to all channels
+    // Apply gain to all channels, metering as it goes
     for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
     {
-        float *channelData = buffer.getWritePointer(channel);
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            channelData[sample] *= linearGain;
-        }
+        const float sumOfSquares = applyGainAndMeasure(buffer.getWritePointer(channel), gain.value, gain.values, numSamples);
+
+        if (channel < static_cast<int>(rmsLevels.size()))
+            rmsLevels[static_cast<size_t>(channel)].store(numSamples > 0 ? std::sqrt(sumOfSquares / numSamples) : 0.0f,
+                                                          std::memory_order_relaxed);
+    }
+}
+
+float GainProcessor::applyGainAndMeasure(float *samples, float gain, const float *gains, int numSamples)
+{
+    // Each lane keeps its own sum, so the loop needs no reordering of float
+    // additions to vectorize
+    constexpr int lanes = 8;
+    float sums[lanes] = {};
+    int i = 0;
+
+    if (gains == nullptr)
+    {
+        for (; i + lanes <= numSamples; i += lanes)
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                const float y = samples[i + lane] * gain;
+                samples[i + lane] = y;
+                sums[lane] += y * y;
+            }
+    }
+    else
+    {
+        for (; i + lanes <= numSamples; i += lanes)
+            for (int lane = 0; lane < lanes; ++lane)
+            {
+                const float y = samples[i + lane] * gains[i + lane];
+                samples[i + lane] = y;
+                sums[lane] += y * y;
+            }
     }
+
+    for (; i < numSamples; ++i)
+    {
+        const float y = samples[i] * (gains != nullptr ? gains[i] : gain);
+        samples[i] = y;
+        sums[0] += y * y;
+    }
+
+    float total = 0.0f;
+    for (float sum : sums)
+        total += sum;
+    return total;
 }
 
 bool GainProcessor::hasEditor() const
@@ -11,7 +11,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
 
+// A smoothed gain stage that meters its own output. Gain and metering run as
+// one pass over each channel, so the buffer is read and written once.
 class GainProcessor final : public juce::AudioProcessor
 {
 public:
@@ -19,6 +23,9 @@ public:
 
   juce::AudioProcessorValueTreeState &getAPVTS() { return parameters; }
 
+  // RMS of the last block after the gain, for channels 0 and 1. Any thread.
+  float getRmsLevel(int channel) const { return rmsLevels[static_cast<size_t>(juce::jlimit(0, 1, channel))].load(std::memory_order_relaxed); }
+
   ~GainProcessor() override;
 
   //===============================================================
@@ -66,8 +73,20 @@ private:
   bool isSampleRateValid() const { return currentSampleRate >= MIN_SAMPLE_RATE && currentSampleRate <= MAX_SAMPLE_RATE; }
 
   juce::AudioProcessorValueTreeState parameters;
-  std::atomic<float> *gainParam = nullptr;
+
+  // Parameter values, loaded once per block
+  struct alignas(64) ParameterValues
+  {
+    float gain; // dB
+  };
+  ParameterSnapshot<ParameterValues> snapshot;
+  ParameterSmoother gainSmoother{ParameterSmoother::Ramp::Multiplicative}; // Linear gain, ramped by ratio
   double currentSampleRate = 0.0; // Initialize to 0 to indicate not set
+  std::array<std::atomic<float>, 2> rmsLevels{};
+
+  // Multiplies by gain, or by gains[i] per sample when gains isn't null, and
+  // returns the sum of the squared results
+  static float applyGainAndMeasure(float *samples, float gain, const float *gains, int numSamples);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GainProcessor)
 };
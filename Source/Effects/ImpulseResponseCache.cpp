@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    ImpulseResponseCache.cpp
+    Created: 18 Oct 2026 8:24:51pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "ImpulseResponseCache.h"
+
+namespace
+{
+  // 64-bit FNV-1a. Not cryptographic, but together with the size it is plenty
+  // to tell impulse responses apart.
+  juce::uint64 hashBytes(const void *data, size_t size)
+  {
+    const auto *bytes = static_cast<const juce::uint8 *>(data);
+    juce::uint64 hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; ++i)
+      hash = (hash ^ bytes[i]) * 1099511628211ull;
+
+    return hash;
+  }
+}
+
+juce::AudioBuffer<float> ImpulseResponseCache::Source::read() const
+{
+  juce::AudioBuffer<float> buffer(numChannels, length);
+
+  if (mappedReader == nullptr)
+  {
+    for (int channel = 0; channel < numChannels; ++channel)
+      buffer.copyFrom(channel, 0, decoded, channel, 0, length);
+    return buffer;
+  }
+
+  // The reader keeps its own state, so only one thread may read at a time
+  const juce::ScopedLock sl(readLock);
+  if (!mappedReader->read(&buffer, 0, length, 0, true, numChannels > 1))
+    buffer.clear();
+
+  return buffer;
+}
+
+ImpulseResponseCache::ImpulseResponseCache() = default;
+
+ImpulseResponseCache::~ImpulseResponseCache()
+{
+  pool.removeAllJobs(true, 10000);
+}
+
+std::shared_ptr<const ImpulseResponseCache::Source> ImpulseResponseCache::loadFile(const juce::File &file)
+{
+  // Identify the file by its contents before decoding anything
+  const juce::MemoryMappedFile mappedFile(file, juce::MemoryMappedFile::readOnly);
+  if (mappedFile.getData() == nullptr || mappedFile.getSize() == 0)
+    return nullptr;
+
+  const Key key{hashBytes(mappedFile.getData(), mappedFile.getSize()), static_cast<juce::int64>(mappedFile.getSize())};
+  {
+    const juce::ScopedLock sl(lock);
+    auto existing = sources.find(key);
+    if (existing != sources.end())
+      if (auto source = existing->second.lock())
+        return source;
+  }
+
+  juce::AudioFormatManager formatManager;
+  formatManager.registerBasicFormats();
+
+  auto source = std::make_shared<Source>();
+  std::unique_ptr<juce::AudioFormatReader> reader;
+
+  if (auto *format = formatManager.findFormatForFileExtension(file.getFileExtension()))
+  {
+    source->mappedReader.reset(format->createMemoryMappedReader(file));
+    if (source->mappedReader != nullptr && !source->mappedReader->mapEntireFile())
+      source->mappedReader.reset();
+  }
+
+  if (source->mappedReader == nullptr)
+    reader.reset(formatManager.createReaderFor(file));
+
+  auto *activeReader = source->mappedReader != nullptr ? static_cast<juce::AudioFormatReader *>(source->mappedReader.get()) : reader.get();
+  if (activeReader == nullptr || activeReader->sampleRate <= 0.0 || activeReader->lengthInSamples <= 0)
+    return nullptr;
+
+  // True-stereo files use their first pair
+  const auto maxLength = static_cast<juce::int64>(maximumSeconds * activeReader->sampleRate);
+  source->sampleRate = activeReader->sampleRate;
+  source->length = static_cast<int>(juce::jmin(activeReader->lengthInSamples, maxLength));
+  source->numChannels = juce::jlimit(1, 2, static_cast<int>(activeReader->numChannels));
+
+  if (reader != nullptr)
+  {
+    source->decoded.setSize(source->numChannels, source->length);
+    if (!reader->read(&source->decoded, 0, source->length, 0, true, source->numChannels > 1))
+      return nullptr;
+  }
+
+  return findOrAdd(key, std::move(source));
+}
+
+std::shared_ptr<const ImpulseResponseCache::Source> ImpulseResponseCache::loadBuffer(juce::AudioBuffer<float> buffer, double sampleRate)
+{
+  if (sampleRate <= 0.0 || buffer.getNumChannels() == 0 || buffer.getNumSamples() == 0)
+    return nullptr;
+
+  auto source = std::make_shared<Source>();
+  source->sampleRate = sampleRate;
+  source->length = juce::jmin(buffer.getNumSamples(), static_cast<int>(maximumSeconds * sampleRate));
+  source->numChannels = juce::jmin(2, buffer.getNumChannels());
+  source->decoded = std::move(buffer);
+
+  // Hash the samples and the rate they were generated at
+  juce::uint64 hash = hashBytes(&sampleRate, sizeof(sampleRate));
+  for (int channel = 0; channel < source->numChannels; ++channel)
+    hash ^= hashBytes(source->decoded.getReadPointer(channel), sizeof(float) * static_cast<size_t>(source->length)) + static_cast<juce::uint64>(channel);
+
+  const Key key{hash, static_cast<juce::int64>(source->numChannels) * source->length};
+  return findOrAdd(key, std::move(source));
+}
+
+std::shared_ptr<const ImpulseResponseCache::Source> ImpulseResponseCache::findOrAdd(const Key &key, std::shared_ptr<Source> source)
+{
+  const juce::ScopedLock sl(lock);
+
+  // Another instance may have loaded the same contents in the meantime
+  auto &entry = sources[key];
+  if (auto existing = entry.lock())
+    return existing;
+
+  // Drop entries whose sources have been freed
+  for (auto it = sources.begin(); it != sources.end();)
+    it = it->second.expired() && &it->second != &entry ? sources.erase(it) : std::next(it);
+
+  entry = source;
+  return source;
+}
+
+std::shared_ptr<const ImpulseResponseCache::Response> ImpulseResponseCache::getResponse(const std::shared_ptr<const Source> &source,
+                                                                                        double sampleRate, bool waitUntilReady)
+{
+  if (source == nullptr || sampleRate <= 0.0)
+    return nullptr;
+
+  {
+    const juce::ScopedLock sl(lock);
+
+    // Once collected, a response is only kept alive by the convolvers using it
+    auto finished = source->finished.find(sampleRate);
+    if (finished != source->finished.end())
+    {
+      auto response = std::move(finished->second);
+      source->finished.erase(finished);
+      source->shared[sampleRate] = response;
+      return response;
+    }
+
+    auto shared = source->shared.find(sampleRate);
+    if (shared != source->shared.end())
+      if (auto response = shared->second.lock())
+        return response;
+
+    if (!waitUntilReady)
+    {
+      if (source->building.insert(sampleRate).second)
+      {
+        pool.addJob([this, source, sampleRate]
+                    {
+                      auto response = build(*source, sampleRate);
+
+                      const juce::ScopedLock jobLock(lock);
+                      source->building.erase(sampleRate);
+                      source->finished[sampleRate] = std::move(response);
+                    });
+      }
+
+      return nullptr;
+    }
+  }
+
+  auto response = build(*source, sampleRate);
+
+  // Keep the first copy if a background build finished while this one ran
+  const juce::ScopedLock sl(lock);
+  auto shared = source->shared.find(sampleRate);
+  if (shared != source->shared.end())
+    if (auto existing = shared->second.lock())
+      return existing;
+
+  source->shared[sampleRate] = response;
+  return response;
+}
+
+std::shared_ptr<const ImpulseResponseCache::Response> ImpulseResponseCache::build(const Source &source, double sampleRate)
+{
+  const auto original = source.read();
+
+  // Resample to the processing rate
+  const double ratio = source.getSampleRate() / sampleRate;
+  const int length = static_cast<int>(std::ceil(original.getNumSamples() / ratio));
+  juce::AudioBuffer<float> resampled(original.getNumChannels(), length);
+
+  for (int channel = 0; channel < resampled.getNumChannels(); ++channel)
+  {
+    if (ratio == 1.0)
+    {
+      resampled.copyFrom(channel, 0, original, channel, 0, length);
+      continue;
+    }
+
+    // Feed zeros past the end so the interpolator can finish the last samples
+    juce::AudioBuffer<float> padded(1, original.getNumSamples() + 8);
+    padded.clear();
+    padded.copyFrom(0, 0, original, channel, 0, original.getNumSamples());
+
+    juce::LagrangeInterpolator interpolator;
+    interpolator.process(ratio, padded.getReadPointer(0), resampled.getWritePointer(channel), length);
+  }
+
+  // Normalize to unit energy so loud and quiet files sit at the same level
+  double energy = 0.0;
+  for (int channel = 0; channel < resampled.getNumChannels(); ++channel)
+  {
+    const float *samples = resampled.getReadPointer(channel);
+    for (int i = 0; i < length; ++i)
+      energy += static_cast<double>(samples[i]) * samples[i];
+  }
+  energy /= resampled.getNumChannels();
+
+  if (energy > 0.0)
+    resampled.applyGain(static_cast<float>(1.0 / std::sqrt(energy)));
+
+  return std::make_shared<const Response>(resampled);
+}
@@ -0,0 +1,103 @@
+/*
+  ==============================================================================
+
+    ImpulseResponseCache.h
+    Created: 18 Oct 2026 8:24:51pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+#include <map>
+#include <memory>
+#include <set>
+
+// Process-wide store of impulse responses, used through
+// juce::SharedResourcePointer so every ConvolutionReverb in a session shares
+// it. Sources are keyed by a hash of their contents, so a file loaded by any
+// number of instances, or under different names, is held once. Each source is
+// resampled, normalized and partitioned once per sample rate on a background
+// thread, and the result is shared immutably by every convolver at that rate.
+//
+// The cache only keeps weak references to what it has handed out, so a
+// response is freed as soon as the last instance using it lets go.
+class ImpulseResponseCache
+{
+public:
+  using Response = PartitionedConvolver::ImpulseResponse;
+
+  // Anything longer is cut off
+  static constexpr double maximumSeconds = 10.0;
+
+  // A response as loaded, at its own sample rate. WAV and AIFF files stay
+  // memory-mapped instead of being copied onto the heap; other formats are
+  // decoded once.
+  class Source
+  {
+  public:
+    double getSampleRate() const { return sampleRate; }
+    int getNumChannels() const { return numChannels; }
+    int getLength() const { return length; }
+
+  private:
+    friend class ImpulseResponseCache;
+
+    // Decodes the whole response
+    juce::AudioBuffer<float> read() const;
+
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader;
+    juce::AudioBuffer<float> decoded; // Only used when the format can't be mapped
+    juce::CriticalSection readLock;
+    double sampleRate = 0.0;
+    int numChannels = 0;
+    int length = 0;
+
+    // Per sample rate, guarded by the cache's lock. Finished responses are
+    // held strongly until they are first collected.
+    mutable std::map<double, std::weak_ptr<const Response>> shared;
+    mutable std::map<double, std::shared_ptr<const Response>> finished;
+    mutable std::set<double> building;
+  };
+
+  ImpulseResponseCache();
+  ~ImpulseResponseCache();
+
+  // Maps and hashes the file on the calling thread. Returns the already loaded
+  // source if the contents match one, or nullptr if the file can't be read.
+  std::shared_ptr<const Source> loadFile(const juce::File &file);
+
+  // Wraps a response generated in memory
+  std::shared_ptr<const Source> loadBuffer(juce::AudioBuffer<float> buffer, double sampleRate);
+
+  // Returns the source prepared for sampleRate. If it hasn't been built yet,
+  // starts building it in the background and returns nullptr; call again later
+  // to collect it. With waitUntilReady set it is built on the calling thread
+  // instead, for offline rendering.
+  std::shared_ptr<const Response> getResponse(const std::shared_ptr<const Source> &source, double sampleRate, bool waitUntilReady);
+
+private:
+  struct Key
+  {
+    juce::uint64 hash;
+    juce::int64 size;
+
+    bool operator<(const Key &other) const { return hash != other.hash ? hash < other.hash : size < other.size; }
+  };
+
+  std::shared_ptr<const Source> findOrAdd(const Key &key, std::shared_ptr<Source> source);
+
+  // Resamples to sampleRate, normalizes to unit energy and partitions
+  static std::shared_ptr<const Response> build(const Source &source, double sampleRate);
+
+  juce::CriticalSection lock;
+  std::map<Key, std::weak_ptr<const Source>> sources;
+
+  // One thread, so builds never compete with each other for the CPU
+  juce::ThreadPool pool{1};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImpulseResponseCache)
+};
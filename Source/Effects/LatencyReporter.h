@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    LatencyReporter.h
+    Created: 18 Oct 2026 7:14:26pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+// Latency that changes while playing. juce::AudioProcessor keeps its latency
+// in a plain int, which the audio thread can't write while the message thread
+// reads it, so effects that change latency from processBlock() report it here
+// instead, and whoever runs them reads it through getLatency().
+class LatencyReporter
+{
+public:
+  virtual ~LatencyReporter() = default;
+
+  // Any thread
+  int getReportedLatency() const { return reportedLatency.load(std::memory_order_relaxed); }
+
+  // Any thread for processors that report, otherwise the thread that sets the
+  // processor's latency
+  static int getLatency(const juce::AudioProcessor &processor)
+  {
+    if (const auto *reporter = dynamic_cast<const LatencyReporter *>(&processor))
+      return reporter->getReportedLatency();
+    return processor.getLatencySamples();
+  }
+
+protected:
+  void reportLatency(int samples) { reportedLatency.store(samples, std::memory_order_relaxed); }
+
+private:
+  std::atomic<int> reportedLatency{0};
+};
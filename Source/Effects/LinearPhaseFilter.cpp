@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.cpp
+    Created: 18 Oct 2026 10:58:14pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseFilter.h"
+
+LinearPhaseFilter::LinearPhaseFilter(ResponseFunction responseFunction)
+    : juce::Thread("Linear Phase Design"), response(std::move(responseFunction))
+{
+}
+
+LinearPhaseFilter::~LinearPhaseFilter()
+{
+  signalThreadShouldExit();
+  designWanted.signal();
+  stopThread(4000);
+}
+
+void LinearPhaseFilter::prepare(double sampleRate, int numChannels)
+{
+  // The designer reads the rate and length, so it sits this out
+  signalThreadShouldExit();
+  designWanted.signal();
+  stopThread(4000);
+
+  currentSampleRate = sampleRate;
+  kernelLength = juce::jmax(blockSize, juce::nextPowerOfTwo(static_cast<int>(std::ceil(kernelSeconds * sampleRate))));
+
+  channels = std::vector<ChannelState>(static_cast<size_t>(juce::jmax(0, numChannels)));
+  for (auto &state : channels)
+  {
+    state.convolver.prepare(blockSize, kernelLength / blockSize);
+    state.input.assign(blockSize, 0.0f);
+    state.output.assign(blockSize, 0.0f);
+    state.fade.assign(blockSize, 0.0f);
+  }
+
+  // Start with a kernel already in place rather than a block of silence
+  kernels.publish(design());
+  activeKernel = kernels.acquire();
+  kernels.collectGarbage();
+  designRequested = false;
+
+  reset();
+  startThread(juce::Thread::Priority::low);
+}
+
+void LinearPhaseFilter::reset()
+{
+  for (auto &state : channels)
+  {
+    state.convolver.reset();
+    std::fill(state.input.begin(), state.input.end(), 0.0f);
+    std::fill(state.output.begin(), state.output.end(), 0.0f);
+  }
+  position = 0;
+}
+
+void LinearPhaseFilter::requestDesign()
+{
+  designRequested.store(true, std::memory_order_release);
+  designWanted.signal();
+}
+
+void LinearPhaseFilter::process(juce::AudioBuffer<float> &buffer, int numSamples)
+{
+  const int numChannels = juce::jmin(buffer.getNumChannels(), static_cast<int>(channels.size()));
+  int done = 0;
+
+  while (done < numSamples)
+  {
+    const int count = juce::jmin(numSamples - done, blockSize - position);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+      auto &state = channels[static_cast<size_t>(channel)];
+      float *io = buffer.getWritePointer(channel, done);
+
+      std::copy(io, io + count, state.input.data() + position);
+      std::copy(state.output.data() + position, state.output.data() + position + count, io);
+    }
+
+    position += count;
+    done += count;
+
+    if (position == blockSize)
+    {
+      processBlock();
+      position = 0;
+    }
+  }
+}
+
+void LinearPhaseFilter::processBlock()
+{
+  if (activeKernel == nullptr)
+    return;
+
+  // The old kernel's output comes first, while it is certain not to have been
+  // collected. It stays valid until acquire() retires it.
+  for (auto &state : channels)
+  {
+    state.convolver.push(state.input.data());
+    state.convolver.convolve(state.output.data(), activeKernel->partitions.data(), activeKernel->numPartitions);
+  }
+
+  const auto *next = kernels.acquire();
+  if (next == activeKernel || next == nullptr)
+    return;
+
+  // Both kernels see the same input history, so the new one picks up mid-stream
+  // and only the output needs to fade across
+  for (auto &state : channels)
+  {
+    state.convolver.convolve(state.fade.data(), next->partitions.data(), next->numPartitions);
+
+    for (int i = 0; i < blockSize; ++i)
+    {
+      const float amount = static_cast<float>(i + 1) / blockSize;
+      state.output[static_cast<size_t>(i)] += (state.fade[static_cast<size_t>(i)] - state.output[static_cast<size_t>(i)]) * amount;
+    }
+  }
+
+  activeKernel = next;
+}
+
+std::unique_ptr<LinearPhaseFilter::Kernel> LinearPhaseFilter::design() const
+{
+  const int numBins = kernelLength / 2 + 1;
+
+  std::vector<double> frequencies(static_cast<size_t>(numBins));
+  for (int bin = 0; bin < numBins; ++bin)
+    frequencies[static_cast<size_t>(bin)] = bin * currentSampleRate / kernelLength;
+
+  std::vector<float> magnitudes(static_cast<size_t>(numBins), 1.0f);
+  if (response)
+    response(frequencies.data(), magnitudes.data(), numBins);
+
+  // Zero phase delayed by half the kernel, which flips the sign of every odd
+  // bin and centres the symmetric impulse in the kernel
+  std::vector<float> buffer(static_cast<size_t>(2 * kernelLength), 0.0f);
+  for (int bin = 0; bin < numBins; ++bin)
+    buffer[static_cast<size_t>(2 * bin)] = (bin & 1) != 0 ? -magnitudes[static_cast<size_t>(bin)] : magnitudes[static_cast<size_t>(bin)];
+  for (int bin = numBins; bin < kernelLength; ++bin)
+    buffer[static_cast<size_t>(2 * bin)] = buffer[static_cast<size_t>(2 * (kernelLength - bin))];
+
+  juce::dsp::FFT fft(juce::roundToInt(std::log2(static_cast<double>(kernelLength))));
+  fft.performRealOnlyInverseTransform(buffer.data());
+
+  // A Hann window trades some resolution at the bottom for low ripple
+  for (int i = 0; i < kernelLength; ++i)
+    buffer[static_cast<size_t>(i)] *= static_cast<float>(0.5 - 0.5 * std::cos(juce::MathConstants<double>::twoPi * i / kernelLength));
+
+  auto kernel = std::make_unique<Kernel>();
+  kernel->partitions = UniformConvolver::transformPartitions(buffer.data(), kernelLength, blockSize);
+  kernel->numPartitions = kernelLength / blockSize;
+  return kernel;
+}
+
+void LinearPhaseFilter::run()
+{
+  while (!threadShouldExit())
+  {
+    designWanted.wait(100);
+    kernels.collectGarbage();
+
+    if (threadShouldExit())
+      return;
+
+    if (!designRequested.exchange(false, std::memory_order_acq_rel))
+      continue;
+
+    kernels.publish(design());
+
+    // Requests made during a sweep pile up here and are met by one design
+    wait(minimumDesignIntervalMs);
+  }
+}
@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    LinearPhaseFilter.h
+    Created: 18 Oct 2026 10:58:14pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LockFreeSwap.h"
+#include "PartitionedConvolver.h"
+#include <functional>
+#include <vector>
+
+// Filters with a linear-phase FIR that matches a magnitude response, for when
+// phase shift matters more than latency. The owner supplies the response as a
+// function. Kernels are designed from it on a background thread, at most one
+// every minimumDesignIntervalMs, and convolved in blockSize partitions. A new
+// kernel crossfades in over one block, so sweeping a control never stalls or
+// clicks.
+class LinearPhaseFilter : private juce::Thread
+{
+public:
+  static constexpr int blockSize = 256;
+  static constexpr double kernelSeconds = 0.08; // Rounded up to a power of two samples
+  static constexpr int minimumDesignIntervalMs = 40;
+
+  // Fills magnitudes with the linear gain wanted at each of count frequencies.
+  // Called on the designer thread, or from prepare().
+  using ResponseFunction = std::function<void(const double *frequencies, float *magnitudes, int count)>;
+
+  explicit LinearPhaseFilter(ResponseFunction responseFunction);
+  ~LinearPhaseFilter() override;
+
+  // Allocates, designs the first kernel from the current response and starts
+  // the designer. Must not run at the same time as process().
+  void prepare(double sampleRate, int numChannels);
+
+  // Clears the convolution state. Must not run at the same time as process().
+  void reset();
+
+  // Any thread. Designs a new kernel once the rate limit allows.
+  void requestDesign();
+
+  // Audio thread. Filters numSamples in place, delayed by getLatencySamples().
+  void process(juce::AudioBuffer<float> &buffer, int numSamples);
+
+  // One block of buffering, plus the kernel's centre
+  int getLatencySamples() const { return blockSize + kernelLength / 2; }
+
+private:
+  struct Kernel
+  {
+    std::vector<float> partitions;
+    int numPartitions = 0;
+  };
+
+  struct ChannelState
+  {
+    UniformConvolver convolver;
+    std::vector<float> input;  // Input collected for the next block
+    std::vector<float> output; // Output of the last block, being played
+    std::vector<float> fade;   // The incoming kernel's output while crossfading
+  };
+
+  void run() override;
+
+  std::unique_ptr<Kernel> design() const;
+  void processBlock();
+
+  ResponseFunction response;
+
+  std::vector<ChannelState> channels;
+  double currentSampleRate = 0.0;
+  int kernelLength = 0;
+  int position = 0;
+
+  LockFreeSwap<Kernel> kernels;
+  const Kernel *activeKernel = nullptr;
+
+  std::atomic<bool> designRequested{false};
+  juce::WaitableEvent designWanted;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseFilter)
+};
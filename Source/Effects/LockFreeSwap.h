@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    LockFreeSwap.h
+    Created: 18 Oct 2026 2:05:18pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+// Hands immutable objects built on the message thread over to the audio thread
+// without locks, and without the audio thread ever freeing memory.
+//
+// The message thread publishes into the pending slot. The audio thread takes the
+// pending object only once the previous current object has been collected, and
+// parks the object it replaces in the retired slot. The message thread frees
+// retired objects from collectGarbage(), which should also be called
+// periodically so a swap is never held up waiting for collection.
+template <typename ObjectType>
+class LockFreeSwap
+{
+public:
+  LockFreeSwap() = default;
+
+  ~LockFreeSwap()
+  {
+    delete pending.exchange(nullptr);
+    delete retired.exchange(nullptr);
+    delete current;
+  }
+
+  // Message thread. Replaces any pending object the audio thread hasn't taken yet.
+  void publish(std::unique_ptr<ObjectType> next)
+  {
+    collectGarbage();
+    delete pending.exchange(next.release(), std::memory_order_acq_rel);
+  }
+
+  // Audio thread. Returns the newest object it is safe to use, or nullptr if
+  // nothing has been published yet. Call once per block and keep the pointer.
+  const ObjectType *acquire()
+  {
+    if (pending.load(std::memory_order_relaxed) != nullptr && retired.load(std::memory_order_acquire) == nullptr)
+    {
+      if (auto *next = pending.exchange(nullptr, std::memory_order_acq_rel))
+      {
+        retired.store(current, std::memory_order_release);
+        current = next;
+      }
+    }
+
+    return current;
+  }
+
+  // Message thread. Frees the object the audio thread last swapped out.
+  void collectGarbage()
+  {
+    delete retired.exchange(nullptr, std::memory_order_acq_rel);
+  }
+
+private:
+  std::atomic<ObjectType *> pending{nullptr};
+  std::atomic<ObjectType *> retired{nullptr};
+  ObjectType *current = nullptr; // Only touched by the audio thread
+
+  LockFreeSwap(const LockFreeSwap &) = delete;
+  LockFreeSwap &operator=(const LockFreeSwap &) = delete;
+};
@@ -0,0 +1,149 @@
+/*
+  ==============================================================================
+
+    ParameterSmoother.h
+    Created: 18 Oct 2026 3:40:52pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Ramps a parameter towards its latest value over a fixed time so automation
+// doesn't step. Give it the new target once per block, then ask process() for
+// the block's per-sample values. When the value is static process() returns
+// nullptr and the effect can keep using a scalar, so steady state costs nothing.
+class ParameterSmoother
+{
+public:
+  enum class Ramp
+  {
+    Linear,        // Fixed step per sample, for mixes, times and levels in dB
+    Multiplicative // Fixed ratio per sample, for linear gains and frequencies
+  };
+
+  // Long enough to hide zipper noise, short enough to feel immediate
+  static constexpr double defaultRampSeconds = 0.02;
+
+  // One block's values, indexable per sample. values is nullptr when static.
+  struct Block
+  {
+    const float *values = nullptr;
+    float value = 0.0f; // Value at the end of the block
+
+    bool isStatic() const { return values == nullptr; }
+    float operator[](int sample) const { return values != nullptr ? values[sample] : value; }
+  };
+
+  explicit ParameterSmoother(Ramp rampType = Ramp::Linear) : type(rampType) {}
+
+  // Allocates the ramp buffer, so call from prepareToPlay
+  void prepare(double sampleRate, double rampSeconds, int maximumBlockSize)
+  {
+    rampLength = std::max(1, static_cast<int>(std::floor(rampSeconds * sampleRate)));
+    ramp.assign(static_cast<size_t>(std::max(0, maximumBlockSize)), 0.0f);
+    setCurrentAndTarget(target);
+  }
+
+  // Jumps straight to a value, e.g. after loading state
+  void setCurrentAndTarget(float value)
+  {
+    current = target = value;
+    countdown = 0;
+  }
+
+  void setTarget(float value)
+  {
+    if (value == target)
+      return;
+
+    target = value;
+    countdown = rampLength;
+
+    // A multiplicative ramp can't start at, end at or cross zero
+    if (type == Ramp::Multiplicative && current > 0.0f && target > 0.0f)
+      step = std::log(target / current) / static_cast<float>(countdown);
+    else
+      step = (target - current) / static_cast<float>(countdown);
+
+    useLogStep = type == Ramp::Multiplicative && current > 0.0f && target > 0.0f;
+  }
+
+  bool isSmoothing() const { return countdown > 0; }
+  float getCurrentValue() const { return current; }
+  float getTargetValue() const { return target; }
+
+  // Advances by numSamples and returns the value for each of them, or nullptr if
+  // the value held still for the whole block. Blocks longer than the prepared
+  // size jump to the target rather than allocate.
+  const float *process(int numSamples)
+  {
+    if (countdown <= 0)
+      return nullptr;
+
+    if (numSamples > static_cast<int>(ramp.size()))
+    {
+      setCurrentAndTarget(target);
+      return nullptr;
+    }
+
+    const int rampSamples = std::min(numSamples, countdown);
+    const float start = useLogStep ? std::log(current) : current;
+    float *values = ramp.data();
+
+    // Both loops are branch-free so they vectorize
+    for (int i = 0; i < rampSamples; ++i)
+      values[i] = start + step * static_cast<float>(i + 1);
+
+    if (useLogStep)
+      for (int i = 0; i < rampSamples; ++i)
+        values[i] = std::exp(values[i]);
+
+    countdown -= rampSamples;
+    current = countdown > 0 ? values[rampSamples - 1] : target;
+
+    std::fill(values + rampSamples, values + numSamples, target);
+    if (countdown == 0 && rampSamples > 0)
+      values[rampSamples - 1] = target;
+
+    return values;
+  }
+
+  Block processBlock(int numSamples)
+  {
+    const float *values = process(numSamples);
+    return {values, current};
+  }
+
+  // Advances without producing values, e.g. while bypassed
+  void skip(int numSamples)
+  {
+    if (countdown <= 0)
+      return;
+
+    if (numSamples >= countdown)
+    {
+      setCurrentAndTarget(target);
+      return;
+    }
+
+    countdown -= numSamples;
+    current = useLogStep ? current * std::exp(step * static_cast<float>(numSamples))
+                         : current + step * static_cast<float>(numSamples);
+  }
+
+private:
+  Ramp type;
+  std::vector<float> ramp;
+  float current = 0.0f;
+  float target = 0.0f;
+  float step = 0.0f;
+  bool useLogStep = false;
+  int countdown = 0;
+  int rampLength = 1;
+};
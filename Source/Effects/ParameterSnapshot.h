@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Created: 18 Oct 2026 4:52:07pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+// The parts of a snapshot that code outside the effect can drive without
+// knowing its Values, e.g. the rack's morph. Overrides are atomic, so any
+// thread may set them, including while a pipelined effect runs elsewhere.
+class ParameterOverrides
+{
+public:
+  virtual ~ParameterOverrides() = default;
+
+  // Message thread. The field bound to the parameter, or -1 if none is.
+  virtual int findParameter(const juce::String &parameterID) const = 0;
+
+  // Replaces the field's value from the next update() on, in the parameter's
+  // own range, the same as getRawParameterValue
+  virtual void setOverride(int index, float value) = 0;
+  virtual void clearOverrides() = 0;
+};
+
+// Copies an effect's parameters into a plain struct once per block, so the DSP
+// reads ordinary floats instead of atomics and "did anything change" is one
+// compare. Values is a struct of floats, one per parameter, declared
+// alignas(64) so the snapshot is cache-line aligned and contiguous. Choice and
+// bool parameters arrive as their raw float values, the same as
+// getRawParameterValue.
+template <typename Values>
+class ParameterSnapshot : public ParameterOverrides
+{
+public:
+  static_assert(std::is_standard_layout_v<Values> && std::is_trivially_copyable_v<Values>,
+                "Snapshot values must be a plain struct of floats");
+
+  static constexpr size_t maxFields = sizeof(Values) / sizeof(float);
+
+  // Binds the fields of Values, in declaration order, to these parameter IDs
+  ParameterSnapshot(juce::AudioProcessorValueTreeState &state, std::initializer_list<const char *> parameterIDs)
+  {
+    for (const auto *id : parameterIDs)
+      bind(state, id);
+
+    update();
+  }
+
+  // The same, for IDs generated at run time, e.g. one set per band
+  ParameterSnapshot(juce::AudioProcessorValueTreeState &state, const juce::StringArray &parameterIDs)
+  {
+    for (const auto &id : parameterIDs)
+      bind(state, id);
+
+    update();
+  }
+
+  // Audio thread, once per block. Returns true if any value differs from the last block.
+  bool update()
+  {
+    std::array<float, maxFields> loaded{};
+
+    for (size_t i = 0; i < numFields; ++i)
+      loaded[i] = overridden[i].load(std::memory_order_relaxed) ? overrides[i].load(std::memory_order_relaxed)
+                                                                 : (sources[i] != nullptr ? sources[i]->load(std::memory_order_relaxed) : 0.0f);
+
+    Values next{};
+    std::memcpy(&next, loaded.data(), numFields * sizeof(float));
+
+    const bool changed = std::memcmp(&next, &values, sizeof(Values)) != 0;
+    values = next;
+    return changed;
+  }
+
+  // The values loaded by the last update(). Audio thread only.
+  const Values &get() const { return values; }
+
+  // Reads one parameter straight from its atomic, so it is safe from any thread
+  float load(float Values::*field) const
+  {
+    const auto *source = sources[indexOf(field)];
+    return source != nullptr ? source->load() : 0.0f;
+  }
+
+  // Hook for modulation: replaces a parameter's value from the next update() on
+  void setOverride(float Values::*field, float value) { setOverride(static_cast<int>(indexOf(field)), value); }
+  void clearOverride(float Values::*field) { overridden[indexOf(field)].store(false, std::memory_order_relaxed); }
+
+  int findParameter(const juce::String &parameterID) const override { return ids.indexOf(parameterID); }
+
+  void setOverride(int index, float value) override
+  {
+    jassert(index >= 0 && static_cast<size_t>(index) < numFields);
+    overrides[static_cast<size_t>(index)].store(value, std::memory_order_relaxed);
+    overridden[static_cast<size_t>(index)].store(true, std::memory_order_relaxed);
+  }
+
+  void clearOverrides() override
+  {
+    for (size_t i = 0; i < numFields; ++i)
+      overridden[i].store(false, std::memory_order_relaxed);
+  }
+
+private:
+  void bind(juce::AudioProcessorValueTreeState &state, const juce::String &id)
+  {
+    jassert(numFields < maxFields);
+    if (numFields >= maxFields)
+      return;
+
+    auto *parameter = state.getRawParameterValue(id);
+    jassert(parameter != nullptr); // Unknown parameter ID
+    sources[numFields++] = parameter;
+    ids.add(id);
+  }
+
+  size_t indexOf(float Values::*field) const
+  {
+    const auto offset = reinterpret_cast<const char *>(&(values.*field)) - reinterpret_cast<const char *>(&values);
+    const auto index = static_cast<size_t>(offset) / sizeof(float);
+    jassert(index < numFields);
+    return index;
+  }
+
+  Values values{};
+  std::array<std::atomic<float> *, maxFields> sources{};
+  std::array<std::atomic<float>, maxFields> overrides{};
+  std::array<std::atomic<bool>, maxFields> overridden{};
+  juce::StringArray ids; // In field order
+  size_t numFields = 0;
+
+  JUCE_DECLARE_NON_COPYABLE(ParameterSnapshot)
+};
@@ -0,0 +1,431 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+    Created: 18 Oct 2026 6:14:33pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+namespace
+{
+  int fftOrderFor(int blockSize)
+  {
+    // Overlap-save needs an FFT twice the block size
+    return juce::roundToInt(std::log2(2.0 * blockSize));
+  }
+}
+
+//==============================================================================
+void UniformConvolver::prepare(int newBlockSize, int maximumPartitions)
+{
+  jassert(juce::isPowerOfTwo(newBlockSize));
+
+  blockSize = newBlockSize;
+  numBins = blockSize + 1;
+  maxPartitions = juce::jmax(1, maximumPartitions);
+  fft = std::make_unique<juce::dsp::FFT>(fftOrderFor(blockSize));
+
+  history.assign(static_cast<size_t>(maxPartitions * getPartitionSize()), 0.0f);
+  window.assign(static_cast<size_t>(2 * blockSize), 0.0f);
+  fftBuffer.assign(static_cast<size_t>(4 * blockSize), 0.0f);
+  accumulator.assign(static_cast<size_t>(getPartitionSize()), 0.0f);
+  historyIndex = 0;
+}
+
+void UniformConvolver::reset()
+{
+  std::fill(history.begin(), history.end(), 0.0f);
+  std::fill(window.begin(), window.end(), 0.0f);
+  historyIndex = 0;
+}
+
+void UniformConvolver::process(const float *input, float *output, const float *partitions, int numPartitions)
+{
+  push(input);
+  convolve(output, partitions, numPartitions);
+}
+
+void UniformConvolver::push(const float *input)
+{
+  const int fftSize = 2 * blockSize;
+  const int partitionSize = getPartitionSize();
+
+  // Slide the window on by one block and transform it
+  std::copy(window.begin() + blockSize, window.end(), window.begin());
+  std::copy(input, input + blockSize, window.begin() + blockSize);
+
+  std::copy(window.begin(), window.end(), fftBuffer.begin());
+  std::fill(fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+  fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+  // Push the spectrum onto the delay line
+  historyIndex = historyIndex + 1 < maxPartitions ? historyIndex + 1 : 0;
+  float *newestReal = history.data() + historyIndex * partitionSize;
+  float *newestImag = newestReal + numBins;
+  for (int bin = 0; bin < numBins; ++bin)
+  {
+    newestReal[bin] = fftBuffer[static_cast<size_t>(2 * bin)];
+    newestImag[bin] = fftBuffer[static_cast<size_t>(2 * bin + 1)];
+  }
+}
+
+void UniformConvolver::convolve(float *output, const float *partitions, int numPartitions)
+{
+  const int fftSize = 2 * blockSize;
+  const int partitionSize = getPartitionSize();
+
+  // Multiply each partition with the input spectrum from that many blocks ago
+  std::fill(accumulator.begin(), accumulator.end(), 0.0f);
+  float *sumReal = accumulator.data();
+  float *sumImag = sumReal + numBins;
+  int slot = historyIndex;
+
+  for (int partition = 0; partition < juce::jmin(numPartitions, maxPartitions); ++partition)
+  {
+    const float *inputReal = history.data() + slot * partitionSize;
+    const float *inputImag = inputReal + numBins;
+    const float *irReal = partitions + partition * partitionSize;
+    const float *irImag = irReal + numBins;
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+      sumReal[bin] += inputReal[bin] * irReal[bin] - inputImag[bin] * irImag[bin];
+      sumImag[bin] += inputReal[bin] * irImag[bin] + inputImag[bin] * irReal[bin];
+    }
+
+    slot = slot > 0 ? slot - 1 : maxPartitions - 1;
+  }
+
+  // Back to interleaved, mirroring the negative frequencies for the inverse
+  for (int bin = 0; bin < numBins; ++bin)
+  {
+    fftBuffer[static_cast<size_t>(2 * bin)] = sumReal[bin];
+    fftBuffer[static_cast<size_t>(2 * bin + 1)] = sumImag[bin];
+  }
+  for (int bin = numBins; bin < fftSize; ++bin)
+  {
+    fftBuffer[static_cast<size_t>(2 * bin)] = sumReal[fftSize - bin];
+    fftBuffer[static_cast<size_t>(2 * bin + 1)] = -sumImag[fftSize - bin];
+  }
+  fft->performRealOnlyInverseTransform(fftBuffer.data());
+
+  // Only the second half of the circular result is free of wrap-around
+  std::copy(fftBuffer.begin() + blockSize, fftBuffer.begin() + fftSize, output);
+}
+
+std::vector<float> UniformConvolver::transformPartitions(const float *impulseResponse, int length, int blockSize)
+{
+  const int numBins = blockSize + 1;
+  const int partitionSize = 2 * numBins;
+  const int numPartitions = (length + blockSize - 1) / blockSize;
+
+  juce::dsp::FFT fft(fftOrderFor(blockSize));
+  std::vector<float> buffer(static_cast<size_t>(4 * blockSize));
+  std::vector<float> spectra(static_cast<size_t>(numPartitions * partitionSize));
+
+  for (int partition = 0; partition < numPartitions; ++partition)
+  {
+    const int offset = partition * blockSize;
+    const int count = juce::jmin(blockSize, length - offset);
+
+    std::fill(buffer.begin(), buffer.end(), 0.0f);
+    std::copy(impulseResponse + offset, impulseResponse + offset + count, buffer.begin());
+    fft.performRealOnlyForwardTransform(buffer.data(), true);
+
+    float *real = spectra.data() + partition * partitionSize;
+    float *imag = real + numBins;
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+      real[bin] = buffer[static_cast<size_t>(2 * bin)];
+      imag[bin] = buffer[static_cast<size_t>(2 * bin + 1)];
+    }
+  }
+
+  return spectra;
+}
+
+//==============================================================================
+PartitionedConvolver::ImpulseResponse::ImpulseResponse(const juce::AudioBuffer<float> &impulseResponse)
+{
+  const int length = impulseResponse.getNumSamples();
+  const int headSamples = juce::jmin(length, headLength);
+  const int tailSamples = juce::jmax(0, length - headLength);
+  jassert(impulseResponse.getNumChannels() > 0);
+
+  numHeadPartitions = (headSamples + headBlockSize - 1) / headBlockSize;
+  numTailPartitions = (tailSamples + tailBlockSize - 1) / tailBlockSize;
+
+  for (int channel = 0; channel < impulseResponse.getNumChannels(); ++channel)
+  {
+    const float *samples = impulseResponse.getReadPointer(channel);
+    head.push_back(UniformConvolver::transformPartitions(samples, headSamples, headBlockSize));
+    tail.push_back(UniformConvolver::transformPartitions(samples + headSamples, tailSamples, tailBlockSize));
+  }
+}
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver()
+    : juce::Thread("Convolution Tail")
+{
+}
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+  signalThreadShouldExit();
+  jobReady.signal();
+  stopThread(4000);
+}
+
+void PartitionedConvolver::prepare(double sampleRate, int numChannels, double maximumSeconds)
+{
+  waitForWorker(true);
+
+  const int maxLength = static_cast<int>(std::ceil(maximumSeconds * sampleRate));
+  maxHeadPartitions = headLength / headBlockSize;
+  maxTailPartitions = juce::jmax(0, (maxLength - headLength + tailBlockSize - 1) / tailBlockSize);
+
+  channels = std::vector<ChannelState>(static_cast<size_t>(juce::jmax(0, numChannels)));
+  for (auto &state : channels)
+  {
+    state.head.prepare(headBlockSize, maxHeadPartitions);
+    state.tail.prepare(tailBlockSize, maxTailPartitions);
+
+    state.headInput.assign(headBlockSize, 0.0f);
+    state.headOutput.assign(headBlockSize, 0.0f);
+    state.delayedDry.assign(headBlockSize, 0.0f);
+
+    state.tailInput.assign(tailBlockSize, 0.0f);
+    state.jobInput.assign(tailBlockSize, 0.0f);
+    for (auto &result : state.tailResults)
+      result.assign(tailBlockSize, 0.0f);
+  }
+
+  reset();
+
+  // Real-time, below the graph workers and pipelined slots: a tail job has a
+  // whole tail block to finish, a graph job only part of one audio block
+  if (!isThreadRunning())
+    startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(8));
+}
+
+void PartitionedConvolver::reset()
+{
+  waitForWorker(true);
+
+  for (auto &state : channels)
+  {
+    state.head.reset();
+    state.tail.reset();
+    std::fill(state.headOutput.begin(), state.headOutput.end(), 0.0f);
+    std::fill(state.delayedDry.begin(), state.delayedDry.end(), 0.0f);
+  }
+
+  headPosition = 0;
+  tailPosition = 0;
+  tailReadPosition = 0;
+  tailResultValid = false;
+  resultOutstanding = false;
+  tailNeedsReset = false;
+}
+
+void PartitionedConvolver::resetWithoutWaiting()
+{
+  // The tail's delay line and results belong to the worker while a job is
+  // pending, so only the audio thread's side is cleared here
+  for (auto &state : channels)
+  {
+    state.head.reset();
+    std::fill(state.headOutput.begin(), state.headOutput.end(), 0.0f);
+    std::fill(state.delayedDry.begin(), state.delayedDry.end(), 0.0f);
+  }
+
+  headPosition = 0;
+  tailPosition = 0;
+  tailReadPosition = 0;
+  tailResultValid = false;
+  resultOutstanding = false;
+  tailNeedsReset = true;
+}
+
+void PartitionedConvolver::setImpulseResponse(std::shared_ptr<const ImpulseResponse> impulseResponse)
+{
+  impulseResponses.publish(std::make_unique<std::shared_ptr<const ImpulseResponse>>(std::move(impulseResponse)));
+}
+
+void PartitionedConvolver::process(juce::AudioBuffer<float> &buffer, juce::AudioBuffer<float> &wet,
+                                   int startSample, int numSamples, bool mayBlock)
+{
+  const int numChannels = juce::jmin(buffer.getNumChannels(), wet.getNumChannels(), static_cast<int>(channels.size()));
+  int done = 0;
+
+  while (done < numSamples)
+  {
+    const int count = juce::jmin(numSamples - done, headBlockSize - headPosition);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+      auto &state = channels[static_cast<size_t>(channel)];
+      float *io = buffer.getWritePointer(channel, startSample + done);
+
+      std::copy(io, io + count, state.headInput.data() + headPosition);
+      std::copy(state.delayedDry.data() + headPosition, state.delayedDry.data() + headPosition + count, io);
+      std::copy(state.headOutput.data() + headPosition, state.headOutput.data() + headPosition + count,
+                wet.getWritePointer(channel, startSample + done));
+    }
+
+    headPosition += count;
+    done += count;
+
+    if (headPosition == headBlockSize)
+    {
+      processHeadBlock(mayBlock);
+      headPosition = 0;
+    }
+  }
+}
+
+void PartitionedConvolver::processHeadBlock(bool mayBlock)
+{
+  // A new response can only replace one the worker isn't reading
+  if (!jobPending.load(std::memory_order_acquire))
+    switchImpulseResponse();
+
+  const auto *impulseResponse = activeImpulseResponse;
+  const bool hasTail = impulseResponse != nullptr && impulseResponse->getNumTailPartitions() > 0 && maxTailPartitions > 0;
+
+  if (hasTail)
+  {
+    for (auto &state : channels)
+      std::copy(state.headInput.begin(), state.headInput.end(), state.tailInput.begin() + tailPosition);
+
+    tailPosition += headBlockSize;
+    if (tailPosition == tailBlockSize)
+    {
+      finishTailBlock(mayBlock);
+      tailPosition = 0;
+    }
+  }
+
+  for (size_t channel = 0; channel < channels.size(); ++channel)
+  {
+    auto &state = channels[channel];
+    std::copy(state.headInput.begin(), state.headInput.end(), state.delayedDry.begin());
+
+    if (impulseResponse != nullptr)
+      state.head.process(state.headInput.data(), state.headOutput.data(), impulseResponse->getHead(static_cast<int>(channel)),
+                         impulseResponse->getNumHeadPartitions());
+    else
+      std::fill(state.headOutput.begin(), state.headOutput.end(), 0.0f);
+
+    if (tailResultValid)
+      juce::FloatVectorOperations::add(state.headOutput.data(), state.tailResults[static_cast<size_t>(playingResult)].data() + tailReadPosition,
+                                       headBlockSize);
+  }
+
+  if (tailResultValid)
+  {
+    tailReadPosition += headBlockSize;
+    tailResultValid = tailReadPosition < tailBlockSize;
+  }
+}
+
+void PartitionedConvolver::finishTailBlock(bool mayBlock)
+{
+  if (!waitForWorker(mayBlock))
+  {
+    // Drop this block and the late one, and restart the tail from silence
+    // rather than let its delay line fall out of step with the head
+    ++missedDeadlines;
+    tailResultValid = false;
+    resultOutstanding = false;
+    tailNeedsReset = true;
+    return;
+  }
+
+  // The worker's last result covers the next tail block of output
+  tailResultValid = resultOutstanding;
+  playingResult = jobResult;
+  tailReadPosition = 0;
+
+  // Hand over the input block that just completed
+  for (auto &state : channels)
+    std::swap(state.tailInput, state.jobInput);
+
+  jobImpulseResponse = activeImpulseResponse;
+  jobResult = 1 - playingResult;
+  jobResetsHistory = tailNeedsReset;
+  tailNeedsReset = false;
+  resultOutstanding = true;
+
+  jobPending.store(true, std::memory_order_release);
+  jobReady.signal();
+}
+
+bool PartitionedConvolver::waitForWorker(bool mayBlock)
+{
+  // Live, the worker has had a whole tail block to finish, so a job that is
+  // still running is dropped rather than waited for: even a short sleep here
+  // can outlast a small audio block
+  if (!mayBlock)
+    return !jobPending.load(std::memory_order_acquire);
+
+  while (jobPending.load(std::memory_order_acquire))
+    jobDone.wait(-1);
+
+  return true;
+}
+
+void PartitionedConvolver::switchImpulseResponse()
+{
+  const auto *reference = impulseResponses.acquire();
+  const auto *next = reference != nullptr ? reference->get() : nullptr;
+  if (next == activeImpulseResponse)
+    return;
+
+  activeImpulseResponse = next;
+
+  // Start both halves from silence so the old response's tail can't play
+  // through the new one's head
+  for (auto &state : channels)
+    state.head.reset();
+
+  tailPosition = 0;
+  tailReadPosition = 0;
+  tailResultValid = false;
+  resultOutstanding = false;
+  tailNeedsReset = true;
+}
+
+void PartitionedConvolver::run()
+{
+  while (!threadShouldExit())
+  {
+    jobReady.wait(100);
+
+    if (threadShouldExit())
+      return;
+
+    if (!jobPending.load(std::memory_order_acquire))
+      continue;
+
+    const auto *impulseResponse = jobImpulseResponse;
+    const int numPartitions = juce::jmin(impulseResponse->getNumTailPartitions(), maxTailPartitions);
+
+    for (size_t channel = 0; channel < channels.size(); ++channel)
+    {
+      auto &state = channels[channel];
+      if (jobResetsHistory)
+        state.tail.reset();
+
+      state.tail.process(state.jobInput.data(), state.tailResults[static_cast<size_t>(jobResult)].data(),
+                         impulseResponse->getTail(static_cast<int>(channel)), numPartitions);
+    }
+
+    jobPending.store(false, std::memory_order_release);
+    jobDone.signal();
+  }
+}
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Created: 18 Oct 2026 6:14:33pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LockFreeSwap.h"
+#include <array>
+#include <vector>
+
+// Uniformly partitioned overlap-save convolution of one channel. The impulse
+// response is cut into blockSize partitions, and each block of input is
+// transformed once and kept in a frequency-domain delay line, so a block costs
+// one FFT pair plus a complex multiply-add per partition. Spectra are stored
+// split (all real parts, then all imaginary parts) so that loop vectorizes.
+class UniformConvolver
+{
+public:
+  // Allocates, so call from prepareToPlay
+  void prepare(int blockSize, int maximumPartitions);
+  void reset();
+
+  // Convolves one blockSize block with the first numPartitions partitions
+  void process(const float *input, float *output, const float *partitions, int numPartitions);
+
+  // The two halves of process(), for convolving the same input with more than
+  // one response: push() takes the next input block, and convolve() can then
+  // run any number of times
+  void push(const float *input);
+  void convolve(float *output, const float *partitions, int numPartitions);
+
+  int getBlockSize() const { return blockSize; }
+  int getPartitionSize() const { return 2 * (blockSize + 1); }
+
+  // Transforms length samples of an impulse response into partition spectra,
+  // laid out the way process() reads them. Allocates.
+  static std::vector<float> transformPartitions(const float *impulseResponse, int length, int blockSize);
+
+private:
+  std::unique_ptr<juce::dsp::FFT> fft;
+  int blockSize = 0;
+  int numBins = 0;
+  int maxPartitions = 0;
+  int historyIndex = 0;
+
+  std::vector<float> history;     // Ring of input spectra, newest at historyIndex
+  std::vector<float> window;      // Previous and current input block
+  std::vector<float> fftBuffer;   // Interleaved complex, twice the FFT size
+  std::vector<float> accumulator; // Split complex sum of the partition products
+};
+
+// Non-uniformly partitioned convolution for long impulse responses. The first
+// headLength samples of the response run on the audio thread in small
+// headBlockSize partitions. The rest runs on a worker thread in large
+// tailBlockSize partitions: each tail block is handed over as soon as its
+// input is complete and has one tail block of time to finish before its first
+// output sample is due. The only latency is one head block.
+class PartitionedConvolver : private juce::Thread
+{
+public:
+  static constexpr int headBlockSize = 256;
+  static constexpr int tailBlockSize = 4096;
+
+  // The tail's output starts this far into the response, which is exactly
+  // where a result handed back one tail block after its input is first needed
+  static constexpr int headLength = 2 * tailBlockSize - headBlockSize;
+
+  // An impulse response cut into head and tail partition spectra. Built off the
+  // audio thread and never modified afterwards, so one copy can be shared by
+  // every convolver running at the same sample rate.
+  class ImpulseResponse
+  {
+  public:
+    explicit ImpulseResponse(const juce::AudioBuffer<float> &impulseResponse);
+
+    int getNumChannels() const { return static_cast<int>(head.size()); }
+    int getNumHeadPartitions() const { return numHeadPartitions; }
+    int getNumTailPartitions() const { return numTailPartitions; }
+
+    // Mono responses are shared by every channel
+    const float *getHead(int channel) const { return head[static_cast<size_t>(juce::jmin(channel, getNumChannels() - 1))].data(); }
+    const float *getTail(int channel) const { return tail[static_cast<size_t>(juce::jmin(channel, getNumChannels() - 1))].data(); }
+
+  private:
+    std::vector<std::vector<float>> head;
+    std::vector<std::vector<float>> tail;
+    int numHeadPartitions = 0;
+    int numTailPartitions = 0;
+  };
+
+  PartitionedConvolver();
+  ~PartitionedConvolver() override;
+
+  // Allocates room for responses up to maximumSeconds long and starts the
+  // worker. Must not run at the same time as process().
+  void prepare(double sampleRate, int numChannels, double maximumSeconds);
+
+  // Clears all convolution state, waiting for the worker to finish first. Must
+  // not run at the same time as process().
+  void reset();
+
+  // Audio thread. Clears the head and restarts the tail from silence without
+  // waiting: a block the worker is still convolving is dropped, and its next
+  // job clears the tail's history. Must not run at the same time as process().
+  void resetWithoutWaiting();
+
+  // Message thread. The audio thread switches over at its next head block.
+  // The convolver keeps its own reference until the response is collected.
+  void setImpulseResponse(std::shared_ptr<const ImpulseResponse> impulseResponse);
+  void collectGarbage() { impulseResponses.collectGarbage(); }
+
+  // Audio thread. Writes the convolved signal for numSamples samples from
+  // startSample into wet, and leaves the input in buffer delayed by
+  // getLatencySamples() so dry and wet stay aligned. When rendering offline,
+  // mayBlock lets it wait for the worker however long it takes.
+  void process(juce::AudioBuffer<float> &buffer, juce::AudioBuffer<float> &wet, int startSample, int numSamples, bool mayBlock);
+
+  int getLatencySamples() const { return headBlockSize; }
+
+  // Tail blocks dropped because the worker didn't finish in time
+  int getNumMissedDeadlines() const { return missedDeadlines.load(); }
+
+private:
+  struct ChannelState
+  {
+    UniformConvolver head;
+    UniformConvolver tail;
+
+    std::vector<float> headInput;  // Input collected for the next head block
+    std::vector<float> headOutput; // Output of the last head block, being played
+    std::vector<float> delayedDry; // Input of the last head block, being played
+
+    std::vector<float> tailInput; // Input collected for the next tail block
+    std::vector<float> jobInput;  // Tail block the worker is convolving
+    std::array<std::vector<float>, 2> tailResults;
+  };
+
+  void run() override;
+
+  void processHeadBlock(bool mayBlock);
+  void finishTailBlock(bool mayBlock);
+  bool waitForWorker(bool mayBlock);
+  void switchImpulseResponse();
+
+  std::vector<ChannelState> channels;
+  int maxHeadPartitions = 0;
+  int maxTailPartitions = 0;
+
+  // The audio thread only ever drops its reference by retiring it, so the
+  // last reference to a shared response is released on the message thread
+  LockFreeSwap<std::shared_ptr<const ImpulseResponse>> impulseResponses;
+  const ImpulseResponse *activeImpulseResponse = nullptr;
+
+  // Audio thread position within the current head and tail blocks
+  int headPosition = 0;
+  int tailPosition = 0;
+  int tailReadPosition = 0;
+  int playingResult = 0;
+  bool tailResultValid = false;
+  bool resultOutstanding = false; // The worker's last job is still due to be played
+
+  // Handover to the worker. The audio thread only touches the job fields
+  // while jobPending is false.
+  std::atomic<bool> jobPending{false};
+  juce::WaitableEvent jobReady;
+  juce::WaitableEvent jobDone;
+  const ImpulseResponse *jobImpulseResponse = nullptr;
+  int jobResult = 0;
+  bool jobResetsHistory = false;
+  bool tailNeedsReset = false;
+
+  std::atomic<int> missedDeadlines{0};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
@@ -0,0 +1,187 @@
+/*
+  ==============================================================================
+
+    PipelinedProcessor.cpp
+    Created: 18 Oct 2026 5:03:12pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "PipelinedProcessor.h"
+
+PipelinedProcessor::PipelinedProcessor(std::shared_ptr<juce::AudioProcessor> processorToRun)
+    : juce::Thread("Pipelined " + processorToRun->getName()),
+      processor(std::move(processorToRun))
+{
+  updateLatency();
+}
+
+PipelinedProcessor::~PipelinedProcessor()
+{
+  signalThreadShouldExit();
+  jobReady.signal();
+  stopThread(4000);
+}
+
+void PipelinedProcessor::setPipelined(bool shouldPipeline)
+{
+  pipelined = shouldPipeline;
+  updateLatency();
+}
+
+void PipelinedProcessor::updateLatency()
+{
+  reportLatency(LatencyReporter::getLatency(*processor) + (pipelined ? blockSize : 0));
+}
+
+void PipelinedProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
+{
+  waitForWorker();
+
+  setPlayConfigDetails(2, 2, sampleRate, samplesPerBlock);
+  processor->setPlayConfigDetails(2, 2, sampleRate, samplesPerBlock);
+  processor->prepareToPlay(sampleRate, samplesPerBlock);
+
+  preparePipeline(samplesPerBlock);
+}
+
+void PipelinedProcessor::preparePipeline(int samplesPerBlock)
+{
+  waitForWorker();
+
+  blockSize = juce::jmax(1, samplesPerBlock);
+  jobBuffer.setSize(2, blockSize);
+  jobMidi.clear();
+  jobSamples = 0;
+
+  // Room for the block being played and the one just finished
+  fifo.setSize(2, 2 * blockSize);
+  running = false;
+
+  updateLatency();
+
+  if (!isThreadRunning())
+    startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(9));
+}
+
+void PipelinedProcessor::releaseResources()
+{
+  waitForWorker();
+  running = false;
+  processor->releaseResources();
+}
+
+void PipelinedProcessor::reset()
+{
+  running = false;
+  resetPending = true;
+}
+
+void PipelinedProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+  // The effect's own latency can change while playing
+  reportLatency(LatencyReporter::getLatency(*processor) + (pipelined ? blockSize : 0));
+
+  if (resetPending)
+  {
+    // Discard the stale block once the worker is done with the effect. It was
+    // handed over a block ago, so this is the wait every pipelined block makes.
+    waitForWorker();
+    jobSamples = 0;
+    processor->reset();
+    resetPending = false;
+  }
+
+  if (!pipelined || blockSize == 0)
+  {
+    if (running)
+    {
+      waitForWorker();
+      running = false;
+    }
+    processor->processBlock(buffer, midiMessages);
+    return;
+  }
+
+  const int numChannels = juce::jmin(2, buffer.getNumChannels());
+  const int numSamples = buffer.getNumSamples();
+
+  if (!running)
+  {
+    // Start a block behind, on silence
+    fifo.clear();
+    fifoRead = 0;
+    fifoSize = blockSize;
+    jobSamples = 0;
+    running = true;
+  }
+
+  // Blocks longer than prepared are taken in pieces, each of which waits for
+  // the last
+  for (int start = 0; start < numSamples; start += blockSize)
+  {
+    const int count = juce::jmin(blockSize, numSamples - start);
+
+    // Collect the block the worker was given last time
+    waitForWorker();
+    const int fifoLength = fifo.getNumSamples();
+    for (int done = 0; done < jobSamples;)
+    {
+      const int write = (fifoRead + fifoSize) % fifoLength;
+      const int chunk = juce::jmin(jobSamples - done, fifoLength - write);
+      for (int channel = 0; channel < 2; ++channel)
+        fifo.copyFrom(channel, write, jobBuffer, juce::jmin(channel, jobChannels - 1), done, chunk);
+      fifoSize += chunk;
+      done += chunk;
+    }
+
+    // Hand this block over, then play the oldest finished audio in its place
+    jobChannels = numChannels;
+    jobSamples = count;
+    for (int channel = 0; channel < numChannels; ++channel)
+      jobBuffer.copyFrom(channel, 0, buffer, channel, start, count);
+
+    for (int done = 0; done < count;)
+    {
+      const int chunk = juce::jmin(count - done, fifoLength - fifoRead);
+      for (int channel = 0; channel < numChannels; ++channel)
+        buffer.copyFrom(channel, start + done, fifo, channel, fifoRead, chunk);
+      fifoRead = (fifoRead + chunk) % fifoLength;
+      fifoSize -= chunk;
+      done += chunk;
+    }
+
+    jobPending.store(true, std::memory_order_release);
+    jobReady.signal();
+  }
+}
+
+void PipelinedProcessor::waitForWorker()
+{
+  while (jobPending.load(std::memory_order_acquire))
+    jobDone.wait(-1);
+}
+
+void PipelinedProcessor::run()
+{
+  juce::ScopedNoDenormals noDenormals;
+
+  while (!threadShouldExit())
+  {
+    jobReady.wait(100);
+
+    if (threadShouldExit())
+      return;
+
+    if (!jobPending.load(std::memory_order_acquire))
+      continue;
+
+    jobMidi.clear();
+    juce::AudioBuffer<float> view(jobBuffer.getArrayOfWritePointers(), jobChannels, jobSamples);
+    processor->processBlock(view, jobMidi);
+
+    jobPending.store(false, std::memory_order_release);
+    jobDone.signal();
+  }
+}
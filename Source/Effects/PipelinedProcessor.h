@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    PipelinedProcessor.h
+    Created: 18 Oct 2026 5:03:12pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "LatencyReporter.h"
+#include <atomic>
+#include <memory>
+
+// Runs a rack slot's effect one block behind, on a thread of its own. While
+// the effect works on block N in the background, the audio thread plays the
+// result of block N-1, so a heavy effect gets a core to itself at the cost of
+// one block of latency, which is reported through the LatencyReporter.
+//
+// Pipelining can be switched off and on again while playing. Switched off,
+// the effect runs directly on the calling thread. Either switch drops the
+// audio that was in flight.
+class PipelinedProcessor : public juce::AudioProcessor,
+                           public LatencyReporter,
+                           private juce::Thread
+{
+public:
+  explicit PipelinedProcessor(std::shared_ptr<juce::AudioProcessor> processorToRun);
+  ~PipelinedProcessor() override;
+
+  juce::AudioProcessor &getProcessor() const { return *processor; }
+
+  // Message thread. Takes effect from the next block.
+  void setPipelined(bool shouldPipeline);
+  bool isPipelined() const { return pipelined.load(); }
+
+  // Prepares the effect as well
+  void prepareToPlay(double sampleRate, int samplesPerBlock) override;
+
+  // Only allocates the pipeline, for wrapping an effect that is already
+  // prepared and may be playing. Must not run at the same time as processBlock().
+  void preparePipeline(int samplesPerBlock);
+
+  void releaseResources() override;
+
+  // Drops the audio in flight and resets the effect without waiting for the
+  // worker, so it is safe on the audio thread. The effect itself is reset by
+  // the next processBlock(), once the worker has let go of it. Must not run at
+  // the same time as processBlock().
+  void reset() override;
+
+  // Effects behind the pipeline get an empty MidiBuffer
+  void processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) override;
+
+  // Plugin methods, forwarded to the effect
+  const juce::String getName() const override { return processor->getName(); }
+  bool acceptsMidi() const override { return false; }
+  bool producesMidi() const override { return false; }
+  bool isMidiEffect() const override { return false; }
+  double getTailLengthSeconds() const override { return processor->getTailLengthSeconds(); }
+  bool hasEditor() const override { return false; }
+  juce::AudioProcessorEditor *createEditor() override { return nullptr; }
+  int getNumPrograms() override { return 1; }
+  int getCurrentProgram() override { return 0; }
+  void setCurrentProgram(int) override {}
+  const juce::String getProgramName(int) override { return {}; }
+  void changeProgramName(int, const juce::String &) override {}
+  void getStateInformation(juce::MemoryBlock &destData) override { processor->getStateInformation(destData); }
+  void setStateInformation(const void *data, int sizeInBytes) override { processor->setStateInformation(data, sizeInBytes); }
+
+private:
+  void run() override;
+
+  // Blocks until the worker has finished the block it was given
+  void waitForWorker();
+  void updateLatency();
+
+  std::shared_ptr<juce::AudioProcessor> processor;
+  std::atomic<bool> pipelined{false};
+  int blockSize = 0;
+
+  // Audio thread. Whether the last block went through the worker, and whether
+  // the block in flight is stale and the effect still has to be reset.
+  bool running = false;
+  bool resetPending = false;
+
+  // The block the worker processes in place. The audio thread only touches
+  // these while jobPending is false.
+  juce::AudioBuffer<float> jobBuffer;
+  juce::MidiBuffer jobMidi;
+  int jobChannels = 0;
+  int jobSamples = 0;
+  std::atomic<bool> jobPending{false};
+  juce::WaitableEvent jobReady;
+  juce::WaitableEvent jobDone;
+
+  // Finished blocks waiting to be played. Always holds one block's worth
+  // when a new block arrives, which is the latency.
+  juce::AudioBuffer<float> fifo;
+  int fifoRead = 0;
+  int fifoSize = 0;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PipelinedProcessor)
+};
@@ -54,40 +54,72 @@ Reverb::Reverb()
                       "freezeMode",  // parameterID
                       "Freeze Mode", // parameter name
                       false          // default value
+                      ),
+                  std::make_unique<juce::AudioParameterChoice>(
+                      "algorithm",                         // parameterID
+                      "Algorithm",                         // parameter name
+                      juce::StringArray("Classic", "FDN"), // choices
+                      0                                    // default choice
+                      ),
+                  std::make_unique<juce::AudioParameterFloat>(
+                      "preDelay",                                               // parameterID
+                      "Pre-Delay",                                              // parameter name
+                      0.0f,                                                     // minimum value
+                      static_cast<float>(EarlyReflections::maxPreDelaySeconds), // maximum value
+                      0.0f                                                      // default value
+                      ),
+                  std::make_unique<juce::AudioParameterFloat>(
+                      "earlyLevel",        // parameterID
+                      "Early Reflections", // parameter name
+                      0.0f,                // minimum value
+                      1.0f,                // maximum value
+                      0.0f                 // default value
                       )})
 {
   DBG("Reverb: Created");
-  roomSizeParam = parameters.getRawParameterValue("roomSize");
-  dampingParam = parameters.getRawParameterValue("damping");
-  wetLevelParam = parameters.getRawParameterValue("wetLevel");
-  dryLevelParam = parameters.getRawParameterValue("dryLevel");
-  widthParam = parameters.getRawParameterValue("width");
-  freezeModeParam = parameters.getRawParameterValue("freezeMode");
 }
 
 Reverb::~Reverb()
 {
   DBG("Reverb: Destroyed");
   releaseResources();
-  roomSizeParam = nullptr;
-  dampingParam = nullptr;
-  wetLevelParam = nullptr;
-  dryLevelParam = nullptr;
-  widthParam = nullptr;
-  freezeModeParam = nullptr;
 }
 
 void Reverb::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
   currentSampleRate = sampleRate;
   reverb.setSampleRate(sampleRate);
-  updateReverbParameters();
+  fdn.prepare(sampleRate, samplesPerBlock);
+
+  maxBlockSize = juce::jmax(1, samplesPerBlock);
+  earlyReflections.prepare(sampleRate, maxBlockSize);
+  dryBuffer.setSize(2, maxBlockSize);
+  earlyBuffer.setSize(2, maxBlockSize);
+
+  snapshot.update();
+  const auto &values = snapshot.get();
+  updateReverbParameters(values);
+
+  // Start the smoothers at the current values so playback doesn't open with a ramp
+  preDelaySmoother.prepare(sampleRate, preDelayRampSeconds, maxBlockSize);
+  earlyLevelSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, maxBlockSize);
+  dryLevelSmoother.prepare(sampleRate, ParameterSmoother::defaultRampSeconds, maxBlockSize);
+  preDelaySmoother.setCurrentAndTarget(std::round(values.preDelay * static_cast<float>(sampleRate)));
+  earlyLevelSmoother.setCurrentAndTarget(values.earlyLevel);
+  dryLevelSmoother.setCurrentAndTarget(values.dryLevel * dryScale);
 }
 
 void Reverb::releaseResources()
+{
+  reset();
+}
+
+void Reverb::reset()
 {
   // Reset the reverb state
   reverb.reset();
+  fdn.reset();
+  earlyReflections.reset();
 }
 
 void Reverb::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
@@ -99,18 +131,78 @@ void Reverb::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &mi
     return;
 
   // Check if we have a valid sample rate
-  if (!isSampleRateValid())
+  if (!isSampleRateValid() || maxBlockSize == 0)
   {
     DBG("Reverb: Invalid sample rate - clearing buffer");
     buffer.clear();
     return;
   }
 
-  // Update reverb parameters
-  updateReverbParameters();
+  // Recompute the comb and all-pass gains only when a parameter moved.
+  // juce::Reverb ramps its gains and damping towards new values itself.
+  if (snapshot.update())
+    updateReverbParameters(snapshot.get());
+
+  // Clear the other engine's tail on a switch, so switching back doesn't
+  // replay whatever it held
+  const auto algorithm = static_cast<Algorithm>(static_cast<int>(snapshot.get().algorithm));
+  if (algorithm != activeAlgorithm)
+  {
+    activeAlgorithm = algorithm;
+    reverb.reset();
+    fdn.reset();
+  }
+
+  // Pre-delay moves in whole samples, so it can be read without interpolation once it settles
+  const auto &values = snapshot.get();
+  preDelaySmoother.setTarget(std::round(values.preDelay * static_cast<float>(currentSampleRate)));
+  earlyLevelSmoother.setTarget(values.earlyLevel);
+  dryLevelSmoother.setTarget(values.dryLevel * dryScale);
+
+  // Work through the block in pieces no longer than the buffers were prepared for
+  const int numSamples = buffer.getNumSamples();
+  for (int start = 0; start < numSamples; start += maxBlockSize)
+  {
+    const int count = juce::jmin(maxBlockSize, numSamples - start);
+    float *left = buffer.getWritePointer(0, start);
+    float *right = buffer.getWritePointer(1, start);
+
+    const auto preDelay = preDelaySmoother.processBlock(count);
+    const auto earlyLevel = earlyLevelSmoother.processBlock(count);
+    const auto dryLevel = dryLevelSmoother.processBlock(count);
+
+    dryBuffer.copyFrom(0, 0, left, count);
+    dryBuffer.copyFrom(1, 0, right, count);
+
+    // Silent reflections aren't worth gathering
+    const bool hasEarly = !(earlyLevel.isStatic() && earlyLevel.value == 0.0f);
+    earlyReflections.process(left, right,
+                             hasEarly ? earlyBuffer.getWritePointer(0) : nullptr,
+                             hasEarly ? earlyBuffer.getWritePointer(1) : nullptr,
+                             preDelay, count);
+
+    // Process the reverb on the pre-delayed input
+    if (algorithm == Algorithm::FDN)
+      fdn.processStereo(left, right, count);
+    else
+      reverb.processStereo(left, right, count);
 
-  // Process the reverb
-  reverb.processStereo(buffer.getWritePointer(0), buffer.getWritePointer(1), buffer.getNumSamples());
+    float *channels[] = {left, right};
+    for (int channel = 0; channel < 2; ++channel)
+    {
+      float *output = channels[channel];
+      const float *dry = dryBuffer.getReadPointer(channel);
+      const float *early = earlyBuffer.getReadPointer(channel);
+
+      for (int sample = 0; sample < count; ++sample)
+      {
+        float value = output[sample] + dry[sample] * dryLevel[sample];
+        if (hasEarly)
+          value += early[sample] * earlyLevel[sample];
+        output[sample] = value;
+      }
+    }
+  }
 }
 
 juce::AudioProcessorEditor *Reverb::createEditor()
@@ -133,16 +225,15 @@ void Reverb::setStateInformation(const void *data, int sizeInBytes)
 
     if (xmlState != nullptr && xmlState->hasTagName(parameters.state.getType()))
     {
-      // Update parameters
+      // Update parameters; the audio thread picks them up on its next block
       parameters.replaceState(juce::ValueTree::fromXml(*xmlState));
 
-      // Update reverb parameters
-      updateReverbParameters();
-
       // Reset reverb state if needed
       if (getSampleRate() > 0.0)
       {
         reverb.reset();
+        fdn.reset();
+        earlyReflections.reset();
       }
     }
   }
@@ -152,20 +243,20 @@ void Reverb::setStateInformation(const void *data, int sizeInBytes)
     if (getSampleRate() > 0.0)
     {
       reverb.reset();
-      updateReverbParameters();
     }
   }
 }
 
-void Reverb::updateReverbParameters()
+void Reverb::updateReverbParameters(const ParameterValues &values)
 {
   juce::Reverb::Parameters params;
-  params.roomSize = roomSizeParam != nullptr ? roomSizeParam->load() : 0.5f;
-  params.damping = dampingParam != nullptr ? dampingParam->load() : 0.5f;
-  params.wetLevel = wetLevelParam != nullptr ? wetLevelParam->load() : 0.33f;
-  params.dryLevel = dryLevelParam != nullptr ? dryLevelParam->load() : 0.4f;
-  params.width = widthParam != nullptr ? widthParam->load() : 1.0f;
-  params.freezeMode = freezeModeParam != nullptr ? freezeModeParam->load() > 0.5f : false;
+  params.roomSize = values.roomSize;
+  params.damping = values.damping;
+  params.wetLevel = values.wetLevel;
+  params.dryLevel = 0.0f; // Mixed in after the engine, around the pre-delay
+  params.width = values.width;
+  params.freezeMode = values.freezeMode > 0.5f;
 
   reverb.setParameters(params);
+  fdn.setParameters(params);
 }
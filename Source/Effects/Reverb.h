@@ -11,16 +11,28 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "EarlyReflections.h"
+#include "FeedbackDelayNetwork.h"
+#include "ParameterSmoother.h"
+#include "ParameterSnapshot.h"
 
 class Reverb : public juce::AudioProcessor
 {
 public:
+  // The engine producing the reverb tail
+  enum class Algorithm
+  {
+    Classic, // juce::Reverb's Freeverb combs and all-passes
+    FDN      // 16-line feedback delay network
+  };
+
   Reverb();
   ~Reverb() override;
 
   // AudioProcessor methods
   void prepareToPlay(double sampleRate, int samplesPerBlock) override;
   void releaseResources() override;
+  void reset() override;
   void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
 
   // Plugin methods
@@ -28,11 +40,14 @@ public:
   bool acceptsMidi() const override { return false; }
   bool producesMidi() const override { return false; }
   bool isMidiEffect() const override { return false; }
-  double getTailLengthSeconds() const override { return 2.0; }
+  double getTailLengthSeconds() const override { return 2.0 + EarlyReflections::maxPreDelaySeconds; }
 
   bool isBypassed() const { return bypassed; }
   void setBypassed(bool shouldBeBypassed) { bypassed = shouldBeBypassed; }
 
+  // Where the rack's morph writes this effect's parameters
+  ParameterOverrides &getParameterOverrides() { return snapshot; }
+
   // Editor methods
   bool hasEditor() const override { return true; }
   juce::AudioProcessorEditor *createEditor() override;
@@ -60,13 +75,37 @@ public:
 
 private:
   juce::Reverb reverb;
-
-  std::atomic<float> *roomSizeParam = nullptr;
-  std::atomic<float> *dampingParam = nullptr;
-  std::atomic<float> *wetLevelParam = nullptr;
-  std::atomic<float> *dryLevelParam = nullptr;
-  std::atomic<float> *widthParam = nullptr;
-  std::atomic<float> *freezeModeParam = nullptr;
+  FeedbackDelayNetwork fdn;
+
+  // The engines only produce the wet tail. The dry signal is mixed back in
+  // here, so it bypasses the pre-delay.
+  EarlyReflections earlyReflections;
+  juce::AudioBuffer<float> dryBuffer;
+  juce::AudioBuffer<float> earlyBuffer;
+  int maxBlockSize = 0;
+
+  // Pre-delay glides in samples rather than jumping, which would click
+  ParameterSmoother preDelaySmoother;
+  ParameterSmoother earlyLevelSmoother;
+  ParameterSmoother dryLevelSmoother;
+  static constexpr double preDelayRampSeconds = 0.05;
+  static constexpr float dryScale = 2.0f; // Matches juce::Reverb's dry scaling
+
+  // Parameter values, loaded once per block
+  struct alignas(64) ParameterValues
+  {
+    float roomSize;
+    float damping;
+    float wetLevel;
+    float dryLevel;
+    float width;
+    float freezeMode; // 0 or 1
+    float algorithm;  // Algorithm index
+    float preDelay;   // Seconds
+    float earlyLevel;
+  };
+  ParameterSnapshot<ParameterValues> snapshot{parameters, {"roomSize", "damping", "wetLevel", "dryLevel", "width", "freezeMode", "algorithm", "preDelay", "earlyLevel"}};
+  Algorithm activeAlgorithm = Algorithm::Classic;
   std::atomic<bool> bypassed{false};
 
   // Processing state
@@ -77,7 +116,7 @@ private:
   static constexpr double MAX_SAMPLE_RATE = 192000.0; // Maximum valid sample rate
   bool isSampleRateValid() const { return currentSampleRate >= MIN_SAMPLE_RATE && currentSampleRate <= MAX_SAMPLE_RATE; }
 
-  void updateReverbParameters();
+  void updateReverbParameters(const ParameterValues &values);
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Reverb)
 };
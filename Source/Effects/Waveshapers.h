@@ -0,0 +1,391 @@
+/*
+  ==============================================================================
+
+    Waveshapers.h
+    Created: 18 Oct 2026 10:12:40am
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+// Transfer curves used by Distortion, each with its first and second
+// antiderivative so they can be run through antiderivative anti-aliasing
+// (ADAA) at the base sample rate instead of oversampling, plus the
+// sample-and-hold decimator behind the SampleRate mode and the lookup table
+// behind the Custom mode.
+//
+// Antiderivatives are evaluated in double precision: ADAA divides differences
+// of them by small input deltas, and float cancellation would show up as noise.
+namespace Waveshapers
+{
+  static constexpr double ln2 = 0.69314718055994530942;
+  static constexpr double piSquaredOver12 = 0.82246703342411321824;
+
+  // Li2(-u) for u in [0, 1], via the Bernoulli series in w = -ln(1 + u).
+  // |w| <= ln 2 here, so six terms are accurate to double precision.
+  inline double dilogarithmOfNegative(double u)
+  {
+    const double w = -std::log1p(u);
+    const double w2 = w * w;
+    return w * (1.0 + w * (-0.25 + w * (1.0 / 36.0 + w2 * (-1.0 / 3600.0 + w2 * (1.0 / 211680.0 + w2 * (-1.0 / 10886400.0))))));
+  }
+
+  // tanh(x). Distortion's sigmoid soft clip is tanh of half the scaled input.
+  struct SoftClipCurve
+  {
+    double evaluate(double x) const { return std::tanh(x); }
+
+    // ln(cosh(x)), written to avoid overflow for large |x|
+    double firstAntiderivative(double x) const
+    {
+      const double ax = std::abs(x);
+      return ax + std::log1p(std::exp(-2.0 * ax)) - ln2;
+    }
+
+    double secondAntiderivative(double x) const
+    {
+      const double ax = std::abs(x);
+      const double value = 0.5 * ax * ax - ax * ln2 + 0.5 * (dilogarithmOfNegative(std::exp(-2.0 * ax)) + piSquaredOver12);
+      return std::copysign(value, x);
+    }
+
+    bool operator==(const SoftClipCurve &) const { return true; }
+  };
+
+  // Clamp to [-limit, limit]
+  struct HardClipCurve
+  {
+    double limit = 1.0;
+
+    double evaluate(double x) const { return std::clamp(x, -limit, limit); }
+
+    double firstAntiderivative(double x) const
+    {
+      const double ax = std::abs(x);
+      return ax <= limit ? 0.5 * x * x : limit * ax - 0.5 * limit * limit;
+    }
+
+    double secondAntiderivative(double x) const
+    {
+      const double ax = std::abs(x);
+      if (ax <= limit)
+        return x * x * x / 6.0;
+
+      return std::copysign(0.5 * limit * x * x - 0.5 * limit * limit * ax + limit * limit * limit / 6.0, x);
+    }
+
+    bool operator==(const HardClipCurve &other) const { return limit == other.limit; }
+  };
+
+  // Triangle folder with period 4, matching Distortion's Fold mode.
+  // Both antiderivatives are periodic, so they stay well conditioned at any drive.
+  struct FoldCurve
+  {
+    // Position within one period, in [0, 4)
+    static double wrap(double x)
+    {
+      const double p = std::fmod(x + 3.0, 4.0);
+      return p < 0.0 ? p + 4.0 : p;
+    }
+
+    double evaluate(double x) const { return 1.0 - std::abs(wrap(x) - 2.0); }
+
+    double firstAntiderivative(double x) const
+    {
+      const double p = wrap(x);
+      return p <= 2.0 ? 0.5 * p * p - p : 3.0 * (p - 2.0) - 0.5 * (p * p - 4.0);
+    }
+
+    double secondAntiderivative(double x) const
+    {
+      const double p = wrap(x);
+      if (p <= 2.0)
+        return p * p * p / 6.0 - 0.5 * p * p;
+
+      const double q = p - 2.0;
+      return -2.0 / 3.0 + 1.5 * q * q - ((p * p * p - 8.0) / 6.0 - 2.0 * q);
+    }
+
+    bool operator==(const FoldCurve &) const { return true; }
+  };
+
+  // Below this input delta the divided differences are replaced by their limit
+  static constexpr double adaaTolerance = 1.0e-5;
+
+  // First-order ADAA: the average of the curve over the segment between
+  // consecutive inputs. Adds half a sample of delay.
+  template <typename Curve>
+  class FirstOrderADAA
+  {
+  public:
+    void reset()
+    {
+      x1 = 0.0;
+      ad1x1 = curve.firstAntiderivative(0.0);
+    }
+
+    // Cached antiderivatives are refreshed if the curve moved. Only a compare
+    // when it didn't, so it can be called every sample.
+    void setCurve(const Curve &newCurve)
+    {
+      if (newCurve == curve)
+        return;
+
+      curve = newCurve;
+      ad1x1 = curve.firstAntiderivative(x1);
+    }
+
+    float processSample(float input)
+    {
+      const double x = input;
+      const double ad1x = curve.firstAntiderivative(x);
+      const double delta = x - x1;
+
+      const double y = std::abs(delta) < adaaTolerance
+                           ? curve.evaluate(0.5 * (x + x1))
+                           : (ad1x - ad1x1) / delta;
+
+      x1 = x;
+      ad1x1 = ad1x;
+      return static_cast<float>(y);
+    }
+
+  private:
+    Curve curve;
+    double x1 = 0.0;
+    double ad1x1 = 0.0;
+  };
+
+  // Second-order ADAA (Bilbao et al.). Stronger alias rejection than first
+  // order for one extra antiderivative per sample. Adds one sample of delay.
+  template <typename Curve>
+  class SecondOrderADAA
+  {
+  public:
+    void reset()
+    {
+      x1 = x2 = 0.0;
+      ad2x1 = curve.secondAntiderivative(0.0);
+      d2 = curve.firstAntiderivative(0.0);
+    }
+
+    // Cached antiderivatives are refreshed if the curve moved. Only a compare
+    // when it didn't, so it can be called every sample.
+    void setCurve(const Curve &newCurve)
+    {
+      if (newCurve == curve)
+        return;
+
+      curve = newCurve;
+      ad2x1 = curve.secondAntiderivative(x1);
+      d2 = dividedDifference(x1, ad2x1, x2, curve.secondAntiderivative(x2));
+    }
+
+    float processSample(float input)
+    {
+      const double x = input;
+      const double ad2x = curve.secondAntiderivative(x);
+      const double d1 = dividedDifference(x, ad2x, x1, ad2x1);
+
+      const double y = std::abs(x - x2) < adaaTolerance
+                           ? fallback(x)
+                           : 2.0 * (d1 - d2) / (x - x2);
+
+      d2 = d1;
+      x2 = x1;
+      x1 = x;
+      ad2x1 = ad2x;
+      return static_cast<float>(y);
+    }
+
+  private:
+    double dividedDifference(double a, double ad2a, double b, double ad2b) const
+    {
+      return std::abs(a - b) < adaaTolerance
+                 ? curve.firstAntiderivative(0.5 * (a + b))
+                 : (ad2a - ad2b) / (a - b);
+    }
+
+    // Used when x[n] and x[n-2] coincide and the main formula is ill conditioned
+    double fallback(double x) const
+    {
+      const double xBar = 0.5 * (x + x2);
+      const double delta = xBar - x1;
+
+      if (std::abs(delta) < adaaTolerance)
+        return curve.evaluate(0.5 * (xBar + x1));
+
+      return (2.0 / delta) * (curve.firstAntiderivative(xBar) + (ad2x1 - curve.secondAntiderivative(xBar)) / delta);
+    }
+
+    Curve curve;
+    double x1 = 0.0;
+    double x2 = 0.0;
+    double ad2x1 = 0.0;
+    double d2 = 0.0;
+  };
+
+  // Sample-and-hold rate reducer with a fractional reduction factor.
+  // Holds no shared state, so use one instance per channel.
+  class Decimator
+  {
+  public:
+    void reset()
+    {
+      phase = 1.0f;
+      heldSample = 0.0f;
+    }
+
+    // Factor of 1 passes audio through, 4 keeps every fourth sample, 2.5 alternates 2 and 3
+    void setReductionFactor(float factor) { increment = 1.0f / std::max(1.0f, factor); }
+
+    float processSample(float input)
+    {
+      if (phase >= 1.0f)
+      {
+        phase -= 1.0f;
+        heldSample = input;
+      }
+
+      phase += increment;
+      return heldSample;
+    }
+
+  private:
+    float increment = 1.0f;
+    float phase = 1.0f;
+    float heldSample = 0.0f;
+  };
+
+  // User-drawn transfer curve, sampled into a lookup table over inputs in [-1, 1].
+  // Inputs outside that range hold the end values. Shaping costs the same few
+  // operations per sample however many control points the curve has.
+  class TransferTable
+  {
+  public:
+    enum class Interpolation
+    {
+      Linear,
+      Cubic
+    };
+
+    static constexpr int size = 4096;
+
+    // Builds the table from control points sorted by x, with x and y in [-1, 1].
+    // The polyline through the points is smoothed with a Hann kernel so its
+    // corners don't spray harmonics all the way up to Nyquist.
+    // Allocates, so only call it off the audio thread.
+    explicit TransferTable(const juce::Array<juce::Point<float>> &points)
+    {
+      std::vector<float> raw(static_cast<size_t>(size));
+      for (int i = 0; i < size; ++i)
+        raw[static_cast<size_t>(i)] = evaluatePolyline(points, -1.0f + 2.0f * static_cast<float>(i) / static_cast<float>(size - 1));
+
+      std::array<float, 2 * smoothingRadius + 1> kernel;
+      float kernelSum = 0.0f;
+      for (int k = -smoothingRadius; k <= smoothingRadius; ++k)
+      {
+        const float weight = 0.5f + 0.5f * std::cos(juce::MathConstants<float>::pi * static_cast<float>(k) / static_cast<float>(smoothingRadius + 1));
+        kernel[static_cast<size_t>(k + smoothingRadius)] = weight;
+        kernelSum += weight;
+      }
+
+      // Entries past the ends repeat the end values, so the flat regions outside [-1, 1] stay flat
+      for (int i = 0; i < size; ++i)
+      {
+        float sum = 0.0f;
+        for (int k = -smoothingRadius; k <= smoothingRadius; ++k)
+          sum += kernel[static_cast<size_t>(k + smoothingRadius)] * raw[static_cast<size_t>(std::clamp(i + k, 0, size - 1))];
+
+        values[static_cast<size_t>(i + 1)] = sum / kernelSum;
+      }
+
+      // Guard entries let cubic interpolation read one before and two after without bounds checks
+      values[0] = values[1];
+      values[size + 1] = values[size];
+      values[size + 2] = values[size];
+    }
+
+    float processSample(float input, Interpolation interpolation) const
+    {
+      return interpolation == Interpolation::Cubic ? cubic(input) : linear(input);
+    }
+
+    // Branch-free inner loops, so the index arithmetic vectorizes
+    void processBlock(const float *input, float *output, int numSamples, Interpolation interpolation) const
+    {
+      if (interpolation == Interpolation::Cubic)
+      {
+        for (int i = 0; i < numSamples; ++i)
+          output[i] = cubic(input[i]);
+      }
+      else
+      {
+        for (int i = 0; i < numSamples; ++i)
+          output[i] = linear(input[i]);
+      }
+    }
+
+  private:
+    static constexpr int smoothingRadius = 32;
+
+    static float evaluatePolyline(const juce::Array<juce::Point<float>> &points, float x)
+    {
+      if (points.isEmpty())
+        return x;
+
+      if (x <= points.getFirst().x)
+        return points.getFirst().y;
+
+      for (int i = 1; i < points.size(); ++i)
+      {
+        const auto &a = points.getReference(i - 1);
+        const auto &b = points.getReference(i);
+
+        if (x <= b.x)
+          return b.x > a.x ? a.y + (b.y - a.y) * (x - a.x) / (b.x - a.x) : b.y;
+      }
+
+      return points.getLast().y;
+    }
+
+    // Table position of an input, in [0, size - 1]
+    static float toPosition(float input)
+    {
+      return (std::clamp(input, -1.0f, 1.0f) + 1.0f) * (0.5f * static_cast<float>(size - 1));
+    }
+
+    float linear(float input) const
+    {
+      const float position = toPosition(input);
+      const int index = static_cast<int>(position);
+      const float fraction = position - static_cast<float>(index);
+      const float *p = values.data() + index + 1;
+      return p[0] + fraction * (p[1] - p[0]);
+    }
+
+    // Catmull-Rom through the four surrounding entries
+    float cubic(float input) const
+    {
+      const float position = toPosition(input);
+      const int index = static_cast<int>(position);
+      const float t = position - static_cast<float>(index);
+      const float *p = values.data() + index;
+
+      const float a = -0.5f * p[0] + 1.5f * p[1] - 1.5f * p[2] + 0.5f * p[3];
+      const float b = p[0] - 2.5f * p[1] + 2.0f * p[2] - 0.5f * p[3];
+      const float c = 0.5f * (p[2] - p[0]);
+      return ((a * t + b) * t + c) * t + p[1];
+    }
+
+    std::array<float, size + 3> values{};
+  };
+}
@@ -1,11 +1,1101 @@
-/*
-  ==============================================================================
-
-    EffectGraphManager.cpp
-    Created: 15 Apr 2025 7:22:24pm
-    Author:  Evan Fraustro
-
-  ==============================================================================
-*/
-
-#include "EffectGraphManager.h"
+/*
+  ==============================================================================
+
+    EffectGraphManager.cpp
+    Created: 15 Apr 2025 7:22:24pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "EffectGraphManager.h"
+#include <array>
+#include <map>
+#include <unordered_map>
+
+//==============================================================================
+// Delays one connection by a whole number of samples. Only the audio thread
+// touches it once a schedule using it is published, and schedules take over
+// the ones their predecessor used.
+class EffectGraphManager::CompensationDelay
+{
+public:
+  // Room for delays up to the capacity less a block
+  explicit CompensationDelay(int capacity)
+  {
+    const int size = juce::nextPowerOfTwo(juce::jmax(minimumCapacity, capacity));
+    for (auto &line : lines)
+      line.assign(static_cast<size_t>(size), 0.0f);
+    mask = size - 1;
+  }
+
+  int getCapacity() const { return mask + 1; }
+
+  void clear()
+  {
+    for (auto &line : lines)
+      std::fill(line.begin(), line.end(), 0.0f);
+  }
+
+  // Writes numSamples of each channel, then reads them back delayed and scaled
+  // into output, replacing or adding to it. Input and output may be the same.
+  // When the delay changes, the old and new delays are crossfaded over the
+  // block.
+  void process(const std::array<float *, 2> &input, int inputChannels, const std::array<float *, 2> &output,
+               int outputChannels, int numSamples, int delay, float gain, bool add)
+  {
+    const int previous = currentDelay < 0 ? delay : currentDelay;
+
+    for (int channel = 0; channel < outputChannels; ++channel)
+    {
+      const float *in = input[static_cast<size_t>(juce::jmin(channel, inputChannels - 1))];
+      float *out = output[static_cast<size_t>(channel)];
+      float *line = lines[static_cast<size_t>(channel)].data();
+
+      for (int i = 0; i < numSamples; ++i)
+        line[(writePosition + i) & mask] = in[i];
+
+      for (int i = 0; i < numSamples; ++i)
+      {
+        float value = line[(writePosition + i - delay) & mask];
+        if (previous != delay)
+        {
+          const float fade = static_cast<float>(i + 1) / static_cast<float>(numSamples);
+          value = fade * value + (1.0f - fade) * line[(writePosition + i - previous) & mask];
+        }
+        out[i] = add ? out[i] + gain * value : gain * value;
+      }
+    }
+
+    writePosition = (writePosition + numSamples) & mask;
+    currentDelay = delay;
+  }
+
+private:
+  // Enough that most latency changes fit without a new line
+  static constexpr int minimumCapacity = 16384;
+
+  std::array<std::vector<float>, 2> lines;
+  int mask = 0;
+  int writePosition = 0;
+  int currentDelay = -1; // Until the first block
+};
+
+//==============================================================================
+// A compiled graph. Buffers are referred to by index: 0 is the host's buffer,
+// then come the scratch buffers, then one per feedback signal.
+struct EffectGraphManager::Schedule : GraphWorkerPool::TaskRunner
+{
+  struct Source
+  {
+    int buffer;
+    float gain;
+
+    // Lines the source up with the slowest path into the step
+    std::shared_ptr<CompensationDelay> delay;
+    int delaySamples = 0;
+  };
+
+  struct Step
+  {
+    NodeType type = NodeType::Mix;
+    SplitMode splitMode = SplitMode::Copy;
+
+    // Summed into buffer before the node runs. Each buffer appears once.
+    std::vector<Source> sources;
+
+    // Where the node runs, which is also its first output
+    int buffer = 0;
+
+    // Frequency and mid/side splits: the buffers of the other outputs
+    std::vector<int> outputs;
+
+    std::shared_ptr<juce::AudioProcessor> processor;
+    mutable juce::MidiBuffer midi; // Passed to the processor when running in parallel
+
+    // Frequency splits. One crossover per band edge, and for each crossover an
+    // allpass on every band below it, so the bands stay in phase and sum flat.
+    mutable std::vector<juce::dsp::LinkwitzRileyFilter<float>> crossovers;
+    mutable std::vector<juce::dsp::LinkwitzRileyFilter<float>> allpasses; // Crossover j, band k at j * (j - 1) / 2 + k
+  };
+
+  std::vector<Step> steps;
+
+  // Copied from the first buffer to the second just before the output is
+  // mixed, so feedback connections read them in the next block
+  std::vector<std::pair<int, int>> feedbackCopies;
+
+  // Only the audio thread touches these once the schedule is published
+  mutable std::vector<juce::AudioBuffer<float>> buffers;
+  mutable std::vector<std::array<float *, 2>> channels;
+  mutable std::vector<int> numChannels;
+
+  int blockSize = 0;
+
+  // Set when steps can run in parallel. One task per step.
+  std::unique_ptr<GraphWorkerPool::TaskGraph> tasks;
+  int numHelpers = 0; // Workers worth waking
+  mutable int chunkSamples = 0;
+
+  // Audio thread. Runs every step over one stretch of the host's buffer.
+  void run(juce::AudioBuffer<float> &buffer, int start, int numSamples, juce::MidiBuffer &midiMessages,
+           GraphWorkerPool &workers) const;
+
+  // Audio thread. Silences the effects, delays, filters and feedback.
+  void reset() const;
+
+private:
+  void runTask(int task) const override;
+  void runStep(const Step &step, int numSamples, juce::MidiBuffer &midiMessages) const;
+  void mixSources(const Step &step, int numSamples) const;
+  void splitMidSide(const Step &step, int numSamples) const;
+  void splitFrequency(const Step &step, int numSamples) const;
+};
+
+//==============================================================================
+int EffectGraphManager::Node::getNumOutputs() const
+{
+  if (type == NodeType::Output)
+    return 0;
+  if (type != NodeType::Split)
+    return 1;
+
+  switch (splitMode)
+  {
+  case SplitMode::Copy:
+    return numCopies;
+  case SplitMode::Frequency:
+    return static_cast<int>(crossovers.size()) + 1;
+  case SplitMode::MidSide:
+    return 2;
+  }
+  return 1;
+}
+
+EffectGraphManager::Graph::Graph()
+{
+  Node input;
+  input.id = inputNodeID;
+  input.type = NodeType::Input;
+  nodes.push_back(input);
+
+  Node output;
+  output.id = outputNodeID;
+  output.type = NodeType::Output;
+  nodes.push_back(output);
+}
+
+EffectGraphManager::Graph EffectGraphManager::Graph::serial(const std::vector<int> &effects)
+{
+  Graph graph;
+  NodeID previous = inputNodeID;
+  for (int effect : effects)
+  {
+    const NodeID node = graph.addEffect(effect);
+    graph.connect(previous, node);
+    previous = node;
+  }
+  graph.connect(previous, outputNodeID);
+  return graph;
+}
+
+EffectGraphManager::NodeID EffectGraphManager::Graph::addNode(Node node)
+{
+  node.id = nextID++;
+  nodes.push_back(std::move(node));
+  return nodes.back().id;
+}
+
+EffectGraphManager::NodeID EffectGraphManager::Graph::addEffect(int effect)
+{
+  Node node;
+  node.type = NodeType::Effect;
+  node.effect = effect;
+  return addNode(std::move(node));
+}
+
+EffectGraphManager::NodeID EffectGraphManager::Graph::addMix()
+{
+  Node node;
+  node.type = NodeType::Mix;
+  return addNode(std::move(node));
+}
+
+EffectGraphManager::NodeID EffectGraphManager::Graph::addCopySplit(int numCopies)
+{
+  Node node;
+  node.type = NodeType::Split;
+  node.splitMode = SplitMode::Copy;
+  node.numCopies = numCopies;
+  return addNode(std::move(node));
+}
+
+EffectGraphManager::NodeID EffectGraphManager::Graph::addFrequencySplit(std::vector<float> crossovers)
+{
+  Node node;
+  node.type = NodeType::Split;
+  node.splitMode = SplitMode::Frequency;
+  node.crossovers = std::move(crossovers);
+  return addNode(std::move(node));
+}
+
+EffectGraphManager::NodeID EffectGraphManager::Graph::addMidSideSplit()
+{
+  Node node;
+  node.type = NodeType::Split;
+  node.splitMode = SplitMode::MidSide;
+  return addNode(std::move(node));
+}
+
+void EffectGraphManager::Graph::removeNode(NodeID id)
+{
+  if (id == inputNodeID || id == outputNodeID)
+    return;
+
+  nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [id](const Node &node)
+                             { return node.id == id; }),
+              nodes.end());
+  connections.erase(std::remove_if(connections.begin(), connections.end(), [id](const Connection &connection)
+                                   { return connection.source == id || connection.destination == id; }),
+                    connections.end());
+}
+
+void EffectGraphManager::Graph::connect(NodeID source, NodeID destination, float gain, int sourceOutput)
+{
+  connections.push_back({source, sourceOutput, destination, gain, false});
+}
+
+void EffectGraphManager::Graph::addFeedback(NodeID source, NodeID destination, float gain, int sourceOutput)
+{
+  connections.push_back({source, sourceOutput, destination, gain, true});
+}
+
+const EffectGraphManager::Node *EffectGraphManager::Graph::findNode(NodeID id) const
+{
+  for (const auto &node : nodes)
+    if (node.id == id)
+      return &node;
+  return nullptr;
+}
+
+juce::ValueTree EffectGraphManager::Graph::toValueTree() const
+{
+  juce::ValueTree tree("ROUTING");
+
+  for (const auto &node : nodes)
+  {
+    juce::StringArray crossovers;
+    for (float frequency : node.crossovers)
+      crossovers.add(juce::String(frequency));
+
+    juce::ValueTree child("NODE");
+    child.setProperty("id", node.id, nullptr);
+    child.setProperty("type", static_cast<int>(node.type), nullptr);
+    child.setProperty("effect", node.effect, nullptr);
+    child.setProperty("splitMode", static_cast<int>(node.splitMode), nullptr);
+    child.setProperty("copies", node.numCopies, nullptr);
+    child.setProperty("crossovers", crossovers.joinIntoString(" "), nullptr);
+    tree.addChild(child, -1, nullptr);
+  }
+
+  for (const auto &connection : connections)
+  {
+    juce::ValueTree child("CONNECTION");
+    child.setProperty("source", connection.source, nullptr);
+    child.setProperty("output", connection.sourceOutput, nullptr);
+    child.setProperty("destination", connection.destination, nullptr);
+    child.setProperty("gain", connection.gain, nullptr);
+    child.setProperty("feedback", connection.feedback, nullptr);
+    tree.addChild(child, -1, nullptr);
+  }
+
+  return tree;
+}
+
+EffectGraphManager::Graph EffectGraphManager::Graph::fromValueTree(const juce::ValueTree &tree)
+{
+  Graph graph;
+  graph.nodes.clear();
+
+  for (const auto &child : tree)
+  {
+    if (child.hasType("NODE"))
+    {
+      Node node;
+      node.id = child.getProperty("id", inputNodeID);
+      node.type = static_cast<NodeType>(juce::jlimit(0, static_cast<int>(NodeType::Split), static_cast<int>(child.getProperty("type", 0))));
+      node.effect = child.getProperty("effect", 0);
+      node.splitMode = static_cast<SplitMode>(juce::jlimit(0, static_cast<int>(SplitMode::MidSide), static_cast<int>(child.getProperty("splitMode", 0))));
+      node.numCopies = child.getProperty("copies", 2);
+
+      for (const auto &frequency : juce::StringArray::fromTokens(child.getProperty("crossovers").toString(), " ", {}))
+        node.crossovers.push_back(frequency.getFloatValue());
+
+      graph.nextID = juce::jmax(graph.nextID, node.id + 1);
+      graph.nodes.push_back(std::move(node));
+    }
+    else if (child.hasType("CONNECTION"))
+    {
+      Connection connection;
+      connection.source = child.getProperty("source", inputNodeID);
+      connection.sourceOutput = child.getProperty("output", 0);
+      connection.destination = child.getProperty("destination", outputNodeID);
+      connection.gain = child.getProperty("gain", 1.0f);
+      connection.feedback = child.getProperty("feedback", false);
+      graph.connections.push_back(connection);
+    }
+  }
+
+  return graph;
+}
+
+//==============================================================================
+EffectGraphManager::EffectGraphManager()
+    : graph(Graph::serial({}))
+{
+}
+
+EffectGraphManager::~EffectGraphManager()
+{
+  stopTimer();
+}
+
+void EffectGraphManager::prepare(double sampleRate, int maximumBlockSize)
+{
+  currentSampleRate = sampleRate;
+  currentBlockSize = maximumBlockSize;
+
+  recompile();
+  startTimerHz(10);
+}
+
+void EffectGraphManager::recompile()
+{
+  Analysis analysis;
+  if (auto schedule = compile(graph, processors, analysis))
+  {
+    compiled = std::move(analysis);
+    if (compiled.parallel)
+      workers->startWorkers();
+    schedules.publish(std::move(schedule));
+  }
+}
+
+bool EffectGraphManager::setGraph(const Graph &newGraph, const EffectResolver &resolveEffect)
+{
+  std::vector<std::shared_ptr<juce::AudioProcessor>> resolved(newGraph.nodes.size());
+  for (size_t i = 0; i < newGraph.nodes.size(); ++i)
+    if (newGraph.nodes[i].type == NodeType::Effect && resolveEffect)
+      resolved[i] = resolveEffect(newGraph.nodes[i].effect);
+
+  Analysis analysis;
+  auto schedule = compile(newGraph, resolved, analysis);
+  if (schedule == nullptr)
+    return false;
+
+  graph = newGraph;
+  processors = std::move(resolved);
+  compiled = std::move(analysis);
+
+  // Until prepare() there is nothing to run it at
+  if (currentBlockSize > 0)
+  {
+    if (compiled.parallel)
+      workers->startWorkers();
+    schedules.publish(std::move(schedule));
+  }
+
+  return true;
+}
+
+void EffectGraphManager::timerCallback()
+{
+  schedules.collectGarbage();
+
+  // Effects change their latency as they are played with, e.g. an EQ band
+  // switched to linear phase, so the delays are checked here
+  for (size_t i = 0; i < processors.size() && i < compiled.effectLatencies.size(); ++i)
+  {
+    if (processors[i] != nullptr && LatencyReporter::getLatency(*processors[i]) != compiled.effectLatencies[i])
+    {
+      recompile();
+      if (onLatencyChanged)
+        onLatencyChanged();
+      return;
+    }
+  }
+}
+
+std::unique_ptr<EffectGraphManager::Schedule> EffectGraphManager::compile(
+    const Graph &graphToCompile, const std::vector<std::shared_ptr<juce::AudioProcessor>> &nodeProcessors,
+    Analysis &analysis) const
+{
+  const auto &nodes = graphToCompile.nodes;
+  const auto &connections = graphToCompile.connections;
+  const int numNodes = static_cast<int>(nodes.size());
+
+  std::unordered_map<NodeID, int> indexOf;
+  for (int n = 0; n < numNodes; ++n)
+  {
+    if (!indexOf.emplace(nodes[static_cast<size_t>(n)].id, n).second)
+      return nullptr; // Duplicate ID
+
+    const auto &node = nodes[static_cast<size_t>(n)];
+    if (node.type == NodeType::Split)
+    {
+      if (node.splitMode == SplitMode::Copy && node.numCopies < 1)
+        return nullptr;
+
+      if (node.splitMode == SplitMode::Frequency)
+      {
+        if (node.crossovers.empty() || static_cast<int>(node.crossovers.size()) > maxCrossovers)
+          return nullptr;
+        if (!std::is_sorted(node.crossovers.begin(), node.crossovers.end()) || node.crossovers.front() <= 0.0f)
+          return nullptr;
+      }
+    }
+  }
+
+  auto inputIt = indexOf.find(inputNodeID);
+  auto outputIt = indexOf.find(outputNodeID);
+  if (inputIt == indexOf.end() || outputIt == indexOf.end())
+    return nullptr;
+  if (nodes[static_cast<size_t>(inputIt->second)].type != NodeType::Input ||
+      nodes[static_cast<size_t>(outputIt->second)].type != NodeType::Output)
+    return nullptr;
+  const int output = outputIt->second;
+
+  // Resolve every connection to node indices
+  const int numConnections = static_cast<int>(connections.size());
+  std::vector<int> sourceOf(static_cast<size_t>(numConnections)), destinationOf(static_cast<size_t>(numConnections));
+  for (int c = 0; c < numConnections; ++c)
+  {
+    const auto &connection = connections[static_cast<size_t>(c)];
+    auto source = indexOf.find(connection.source);
+    auto destination = indexOf.find(connection.destination);
+    if (source == indexOf.end() || destination == indexOf.end())
+      return nullptr;
+    if (connection.source == outputNodeID || connection.destination == inputNodeID)
+      return nullptr;
+    if (connection.feedback && connection.destination == outputNodeID)
+      return nullptr; // Would be read in the block it was written
+    if (connection.sourceOutput < 0 || connection.sourceOutput >= nodes[static_cast<size_t>(source->second)].getNumOutputs())
+      return nullptr;
+
+    sourceOf[static_cast<size_t>(c)] = source->second;
+    destinationOf[static_cast<size_t>(c)] = destination->second;
+  }
+
+  // Only nodes that lead to the output need to run
+  std::vector<bool> needed(static_cast<size_t>(numNodes), false);
+  std::vector<int> pending{output};
+  needed[static_cast<size_t>(output)] = true;
+  while (!pending.empty())
+  {
+    const int n = pending.back();
+    pending.pop_back();
+    for (int c = 0; c < numConnections; ++c)
+    {
+      const int source = sourceOf[static_cast<size_t>(c)];
+      if (destinationOf[static_cast<size_t>(c)] == n && !needed[static_cast<size_t>(source)])
+      {
+        needed[static_cast<size_t>(source)] = true;
+        pending.push_back(source);
+      }
+    }
+  }
+
+  // Topological order over the forward connections. The output goes last, as
+  // it writes to the host's buffer.
+  std::vector<int> inDegree(static_cast<size_t>(numNodes), 0);
+  for (int c = 0; c < numConnections; ++c)
+    if (!connections[static_cast<size_t>(c)].feedback && needed[static_cast<size_t>(destinationOf[static_cast<size_t>(c)])])
+      ++inDegree[static_cast<size_t>(destinationOf[static_cast<size_t>(c)])];
+
+  std::vector<int> order;
+  for (int n = 0; n < numNodes; ++n)
+    if (needed[static_cast<size_t>(n)] && n != output && inDegree[static_cast<size_t>(n)] == 0)
+      order.push_back(n);
+
+  for (size_t next = 0; next < order.size(); ++next)
+  {
+    for (int c = 0; c < numConnections; ++c)
+    {
+      const int destination = destinationOf[static_cast<size_t>(c)];
+      if (connections[static_cast<size_t>(c)].feedback || sourceOf[static_cast<size_t>(c)] != order[next] || !needed[static_cast<size_t>(destination)])
+        continue;
+
+      if (--inDegree[static_cast<size_t>(destination)] == 0 && destination != output)
+        order.push_back(destination);
+    }
+  }
+
+  const auto numNeeded = static_cast<int>(std::count(needed.begin(), needed.end(), true));
+  if (static_cast<int>(order.size()) != numNeeded - 1)
+    return nullptr; // A cycle without a feedback connection
+
+  order.push_back(output);
+  const int numSteps = static_cast<int>(order.size());
+  const int outputStep = numSteps - 1;
+
+  std::vector<int> stepOf(static_cast<size_t>(numNodes), -1);
+  for (int i = 0; i < numSteps; ++i)
+    stepOf[static_cast<size_t>(order[static_cast<size_t>(i)])] = i;
+
+  // Latency into and out of each node. A node waits for its slowest input,
+  // and feedback is left as it is.
+  analysis.effectLatencies.assign(static_cast<size_t>(numNodes), 0);
+  std::vector<int> latencyIn(static_cast<size_t>(numNodes), 0), latencyOut(static_cast<size_t>(numNodes), 0);
+  for (int n : order)
+  {
+    for (int c = 0; c < numConnections; ++c)
+      if (!connections[static_cast<size_t>(c)].feedback && destinationOf[static_cast<size_t>(c)] == n)
+        latencyIn[static_cast<size_t>(n)] = juce::jmax(latencyIn[static_cast<size_t>(n)], latencyOut[static_cast<size_t>(sourceOf[static_cast<size_t>(c)])]);
+
+    if (nodes[static_cast<size_t>(n)].type == NodeType::Effect && nodeProcessors[static_cast<size_t>(n)] != nullptr)
+      analysis.effectLatencies[static_cast<size_t>(n)] = juce::jmax(0, LatencyReporter::getLatency(*nodeProcessors[static_cast<size_t>(n)]));
+
+    latencyOut[static_cast<size_t>(n)] = latencyIn[static_cast<size_t>(n)] + analysis.effectLatencies[static_cast<size_t>(n)];
+  }
+
+  // Which steps wait for which. Besides the connections, every step that
+  // nothing waits for is finished before the output, which copies feedback,
+  // and an effect used by several nodes runs one node at a time.
+  std::vector<std::vector<int>> successors(static_cast<size_t>(numSteps));
+  auto addDependency = [&](int before, int after)
+  {
+    auto &list = successors[static_cast<size_t>(before)];
+    if (before != after && std::find(list.begin(), list.end(), after) == list.end())
+      list.push_back(after);
+  };
+
+  for (int c = 0; c < numConnections; ++c)
+  {
+    const int destination = destinationOf[static_cast<size_t>(c)];
+    if (!connections[static_cast<size_t>(c)].feedback && needed[static_cast<size_t>(destination)])
+      addDependency(stepOf[static_cast<size_t>(sourceOf[static_cast<size_t>(c)])], stepOf[static_cast<size_t>(destination)]);
+  }
+
+  std::map<const juce::AudioProcessor *, int> lastStepOf;
+  for (int i = 0; i < numSteps; ++i)
+  {
+    const int n = order[static_cast<size_t>(i)];
+    const auto *processor = nodes[static_cast<size_t>(n)].type == NodeType::Effect ? nodeProcessors[static_cast<size_t>(n)].get() : nullptr;
+    if (processor == nullptr)
+      continue;
+
+    auto previous = lastStepOf.find(processor);
+    if (previous != lastStepOf.end())
+      addDependency(previous->second, i);
+    lastStepOf[processor] = i;
+  }
+
+  for (int i = 0; i < outputStep; ++i)
+    if (successors[static_cast<size_t>(i)].empty())
+      addDependency(i, outputStep);
+
+  // Steps are worth spreading over the workers when two effects can run at
+  // once. Effects at the same depth never wait for each other.
+  std::vector<std::vector<bool>> ancestors(static_cast<size_t>(numSteps), std::vector<bool>(static_cast<size_t>(numSteps), false));
+  std::vector<int> depth(static_cast<size_t>(numSteps), 0);
+  std::map<int, int> effectsAtDepth;
+  int width = 0;
+  for (int i = 0; i < numSteps; ++i)
+  {
+    const int n = order[static_cast<size_t>(i)];
+    if (nodes[static_cast<size_t>(n)].type == NodeType::Effect && nodeProcessors[static_cast<size_t>(n)] != nullptr)
+      width = juce::jmax(width, ++effectsAtDepth[depth[static_cast<size_t>(i)]]);
+
+    for (int next : successors[static_cast<size_t>(i)])
+    {
+      depth[static_cast<size_t>(next)] = juce::jmax(depth[static_cast<size_t>(next)], depth[static_cast<size_t>(i)] + 1);
+
+      auto &inherited = ancestors[static_cast<size_t>(next)];
+      const auto &own = ancestors[static_cast<size_t>(i)];
+      for (int a = 0; a < i; ++a)
+        if (own[static_cast<size_t>(a)])
+          inherited[static_cast<size_t>(a)] = true;
+      inherited[static_cast<size_t>(i)] = true;
+    }
+  }
+
+  const bool inParallel = workers->getNumWorkers() > 0 && width >= 2;
+
+  // The last step that reads each output of each node. Feedback is read when
+  // it is copied, just before the output step.
+  std::vector<std::vector<int>> lastUse(static_cast<size_t>(numNodes));
+  for (int n = 0; n < numNodes; ++n)
+    lastUse[static_cast<size_t>(n)].assign(static_cast<size_t>(nodes[static_cast<size_t>(n)].getNumOutputs()), -1);
+
+  std::map<std::pair<int, int>, int> feedbackStores; // Node and output to store number
+  for (int c = 0; c < numConnections; ++c)
+  {
+    const auto &connection = connections[static_cast<size_t>(c)];
+    const int source = sourceOf[static_cast<size_t>(c)];
+    const int destination = destinationOf[static_cast<size_t>(c)];
+    if (!needed[static_cast<size_t>(destination)])
+      continue;
+
+    auto &use = lastUse[static_cast<size_t>(source)][static_cast<size_t>(connection.sourceOutput)];
+    if (connection.feedback)
+    {
+      use = juce::jmax(use, outputStep);
+      feedbackStores.emplace(std::make_pair(source, connection.sourceOutput), static_cast<int>(feedbackStores.size()));
+    }
+    else
+    {
+      use = juce::jmax(use, stepOf[static_cast<size_t>(destination)]);
+    }
+  }
+
+  // Give every signal a buffer. A buffer is handed out again once the last
+  // step reading it has run, and a node runs in place in one of its inputs
+  // when that input is read for the last time there. Feedback stores are
+  // numbered negatively until the scratch buffers are counted.
+  //
+  // In parallel, a step only writes to a buffer when every step that used it
+  // before is one the step waits for anyway, so reuse never adds a dependency.
+  std::vector<int> bufferLastUse{-1};
+  std::vector<bool> released{false};
+  std::vector<std::vector<int>> bufferUsers(1);
+  std::vector<int> freeBuffers;
+  std::vector<std::vector<int>> valueBuffer(static_cast<size_t>(numNodes));
+
+  auto mayWrite = [&](int buffer, int step)
+  {
+    if (!inParallel)
+      return true;
+
+    const auto &users = bufferUsers[static_cast<size_t>(buffer)];
+    return std::all_of(users.begin(), users.end(), [&](int user)
+                       { return user == step || ancestors[static_cast<size_t>(step)][static_cast<size_t>(user)]; });
+  };
+
+  auto allocate = [&](int step)
+  {
+    for (auto it = freeBuffers.rbegin(); it != freeBuffers.rend(); ++it)
+    {
+      const int buffer = *it;
+      if (!mayWrite(buffer, step))
+        continue;
+
+      freeBuffers.erase(std::next(it).base());
+      released[static_cast<size_t>(buffer)] = false;
+      return buffer;
+    }
+    bufferLastUse.push_back(-1);
+    released.push_back(false);
+    bufferUsers.emplace_back();
+    return static_cast<int>(bufferLastUse.size()) - 1;
+  };
+
+  auto schedule = std::make_unique<Schedule>();
+  schedule->steps.resize(static_cast<size_t>(numSteps));
+
+  for (int i = 0; i < numSteps; ++i)
+  {
+    for (int buffer = 1; buffer < static_cast<int>(bufferLastUse.size()); ++buffer)
+    {
+      if (!released[static_cast<size_t>(buffer)] && bufferLastUse[static_cast<size_t>(buffer)] < i)
+      {
+        released[static_cast<size_t>(buffer)] = true;
+        freeBuffers.push_back(buffer);
+      }
+    }
+
+    const int n = order[static_cast<size_t>(i)];
+    const auto &node = nodes[static_cast<size_t>(n)];
+    auto &step = schedule->steps[static_cast<size_t>(i)];
+    step.type = node.type;
+    step.splitMode = node.splitMode;
+
+    // Sources reading the same buffer are merged, so mixing can work in place
+    for (int c = 0; c < numConnections; ++c)
+    {
+      const auto &connection = connections[static_cast<size_t>(c)];
+      if (destinationOf[static_cast<size_t>(c)] != n)
+        continue;
+
+      const int source = sourceOf[static_cast<size_t>(c)];
+      const int buffer = connection.feedback
+                             ? -1 - feedbackStores[std::make_pair(source, connection.sourceOutput)]
+                             : valueBuffer[static_cast<size_t>(source)][static_cast<size_t>(connection.sourceOutput)];
+
+      auto existing = std::find_if(step.sources.begin(), step.sources.end(), [buffer](const Schedule::Source &s)
+                                   { return s.buffer == buffer; });
+      if (existing != step.sources.end())
+      {
+        existing->gain += connection.gain;
+        continue;
+      }
+
+      // A buffer holds one output of one node, so its sources share a delay.
+      // The line from the last schedule is kept if it is long enough.
+      Schedule::Source added{buffer, connection.gain};
+      const int delay = connection.feedback ? 0 : latencyIn[static_cast<size_t>(n)] - latencyOut[static_cast<size_t>(source)];
+      if (delay > 0)
+      {
+        const ConnectionKey key{connection.source, connection.sourceOutput, connection.destination};
+        const int capacity = delay + juce::jmax(1, currentBlockSize);
+        auto previous = compiled.delays.find(key);
+        added.delay = previous != compiled.delays.end() && previous->second->getCapacity() >= capacity
+                          ? previous->second
+                          : std::make_shared<CompensationDelay>(capacity);
+        added.delaySamples = delay;
+        analysis.delays[key] = added.delay;
+      }
+      step.sources.push_back(std::move(added));
+    }
+
+    if (node.type == NodeType::Input || node.type == NodeType::Output)
+    {
+      step.buffer = 0;
+    }
+    else
+    {
+      step.buffer = -1;
+      for (const auto &source : step.sources)
+      {
+        if (source.buffer >= 0 && bufferLastUse[static_cast<size_t>(source.buffer)] == i && mayWrite(source.buffer, i))
+        {
+          step.buffer = source.buffer;
+          break;
+        }
+      }
+      if (step.buffer < 0)
+        step.buffer = allocate(i);
+    }
+
+    // Copy splits share the buffer between all their outputs, the other
+    // splits need one more per output
+    const int numOutputs = node.getNumOutputs();
+    auto &values = valueBuffer[static_cast<size_t>(n)];
+    values.assign(static_cast<size_t>(numOutputs), step.buffer);
+
+    for (int o = 0; o < numOutputs; ++o)
+    {
+      if (o > 0 && node.type == NodeType::Split && node.splitMode != SplitMode::Copy)
+      {
+        values[static_cast<size_t>(o)] = allocate(i);
+        step.outputs.push_back(values[static_cast<size_t>(o)]);
+      }
+
+      auto &bufferUse = bufferLastUse[static_cast<size_t>(values[static_cast<size_t>(o)])];
+      bufferUse = juce::jmax(bufferUse, i, lastUse[static_cast<size_t>(n)][static_cast<size_t>(o)]);
+    }
+
+    for (const auto &source : step.sources)
+      if (source.buffer >= 0)
+        bufferUsers[static_cast<size_t>(source.buffer)].push_back(i);
+    bufferUsers[static_cast<size_t>(step.buffer)].push_back(i);
+    for (int buffer : step.outputs)
+      bufferUsers[static_cast<size_t>(buffer)].push_back(i);
+
+    if (node.type == NodeType::Effect)
+      step.processor = nodeProcessors[static_cast<size_t>(n)];
+  }
+
+  // Number the feedback stores after the scratch buffers
+  const int numScratch = static_cast<int>(bufferLastUse.size()) - 1;
+  auto storeBuffer = [numScratch](int buffer)
+  { return buffer < 0 ? numScratch - buffer : buffer; };
+
+  for (auto &step : schedule->steps)
+    for (auto &source : step.sources)
+      source.buffer = storeBuffer(source.buffer);
+
+  for (const auto &store : feedbackStores)
+    schedule->feedbackCopies.push_back({valueBuffer[static_cast<size_t>(store.first.first)][static_cast<size_t>(store.first.second)],
+                                        storeBuffer(-1 - store.second)});
+
+  // Allocate everything the audio thread will touch
+  const int numBuffers = 1 + numScratch + static_cast<int>(feedbackStores.size());
+  schedule->blockSize = currentBlockSize;
+  schedule->buffers.resize(static_cast<size_t>(numBuffers));
+  schedule->channels.resize(static_cast<size_t>(numBuffers));
+  schedule->numChannels.assign(static_cast<size_t>(numBuffers), 2);
+
+  for (int buffer = 1; buffer < numBuffers; ++buffer)
+  {
+    auto &scratch = schedule->buffers[static_cast<size_t>(buffer)];
+    scratch.setSize(2, juce::jmax(1, currentBlockSize));
+    scratch.clear();
+    schedule->channels[static_cast<size_t>(buffer)] = {scratch.getWritePointer(0), scratch.getWritePointer(1)};
+  }
+
+  if (currentSampleRate > 0.0)
+  {
+    const juce::dsp::ProcessSpec spec{currentSampleRate, static_cast<juce::uint32>(juce::jmax(1, currentBlockSize)), 2};
+
+    for (int i = 0; i < numSteps; ++i)
+    {
+      const auto &node = nodes[static_cast<size_t>(order[static_cast<size_t>(i)])];
+      auto &step = schedule->steps[static_cast<size_t>(i)];
+      if (node.type != NodeType::Split || node.splitMode != SplitMode::Frequency)
+        continue;
+
+      auto makeFilter = [&](float frequency, juce::dsp::LinkwitzRileyFilterType type)
+      {
+        juce::dsp::LinkwitzRileyFilter<float> filter;
+        filter.prepare(spec);
+        filter.setType(type);
+        filter.setCutoffFrequency(juce::jlimit(10.0f, static_cast<float>(0.45 * currentSampleRate), frequency));
+        return filter;
+      };
+
+      const int numCrossovers = static_cast<int>(node.crossovers.size());
+      for (int j = 0; j < numCrossovers; ++j)
+      {
+        step.crossovers.push_back(makeFilter(node.crossovers[static_cast<size_t>(j)], juce::dsp::LinkwitzRileyFilterType::lowpass));
+        for (int k = 0; k < j; ++k)
+          step.allpasses.push_back(makeFilter(node.crossovers[static_cast<size_t>(j)], juce::dsp::LinkwitzRileyFilterType::allpass));
+      }
+    }
+  }
+
+  if (inParallel)
+  {
+    schedule->tasks = std::make_unique<GraphWorkerPool::TaskGraph>(successors, workers->getNumThreads());
+    schedule->numHelpers = width - 1;
+  }
+
+  analysis.numScratchBuffers = numScratch;
+  analysis.parallel = inParallel;
+  analysis.latency = latencyIn[static_cast<size_t>(output)];
+  return schedule;
+}
+
+//==============================================================================
+void EffectGraphManager::process(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+  const auto *schedule = schedules.acquire();
+  if (schedule == nullptr || schedule->blockSize <= 0 || buffer.getNumChannels() == 0)
+    return;
+
+  // Hosts may go over the block size they prepared with
+  const int numSamples = buffer.getNumSamples();
+  for (int start = 0; start < numSamples; start += schedule->blockSize)
+    schedule->run(buffer, start, juce::jmin(schedule->blockSize, numSamples - start), midiMessages, *workers);
+}
+
+void EffectGraphManager::reset()
+{
+  if (const auto *schedule = schedules.acquire())
+    schedule->reset();
+}
+
+void EffectGraphManager::Schedule::reset() const
+{
+  for (const auto &step : steps)
+  {
+    if (step.processor != nullptr)
+      step.processor->reset();
+
+    for (const auto &source : step.sources)
+      if (source.delay != nullptr)
+        source.delay->clear();
+
+    for (auto &filter : step.crossovers)
+      filter.reset();
+    for (auto &filter : step.allpasses)
+      filter.reset();
+  }
+
+  for (auto &scratch : buffers)
+    scratch.clear();
+}
+
+//==============================================================================
+// Sums a step's sources into its buffer, each through its compensation delay
+// if it has one. When the buffer is a source itself it is scaled in place first.
+void EffectGraphManager::Schedule::mixSources(const Step &step, int numSamples) const
+{
+  auto &target = channels[static_cast<size_t>(step.buffer)];
+  const int targetChannels = numChannels[static_cast<size_t>(step.buffer)];
+  bool started = false;
+
+  for (const auto &source : step.sources)
+  {
+    if (source.buffer != step.buffer)
+      continue;
+
+    if (source.delay != nullptr)
+      source.delay->process(target, targetChannels, target, targetChannels, numSamples, source.delaySamples, source.gain, false);
+    else if (source.gain != 1.0f)
+      for (int channel = 0; channel < targetChannels; ++channel)
+        juce::FloatVectorOperations::multiply(target[static_cast<size_t>(channel)], source.gain, numSamples);
+    started = true;
+  }
+
+  for (const auto &source : step.sources)
+  {
+    if (source.buffer == step.buffer)
+      continue;
+
+    const auto &from = channels[static_cast<size_t>(source.buffer)];
+    const int fromChannels = numChannels[static_cast<size_t>(source.buffer)];
+
+    if (source.delay != nullptr)
+    {
+      source.delay->process(from, fromChannels, target, targetChannels, numSamples, source.delaySamples, source.gain, started);
+      started = true;
+      continue;
+    }
+
+    for (int channel = 0; channel < targetChannels; ++channel)
+    {
+      const float *input = from[static_cast<size_t>(juce::jmin(channel, fromChannels - 1))];
+      if (started)
+        juce::FloatVectorOperations::addWithMultiply(target[static_cast<size_t>(channel)], input, source.gain, numSamples);
+      else
+        juce::FloatVectorOperations::copyWithMultiply(target[static_cast<size_t>(channel)], input, source.gain, numSamples);
+    }
+    started = true;
+  }
+
+  if (!started)
+    for (int channel = 0; channel < targetChannels; ++channel)
+      juce::FloatVectorOperations::clear(target[static_cast<size_t>(channel)], numSamples);
+}
+
+// Mid goes to both channels of the first output, and side to the second
+// output with the right channel inverted, so summing the two gives back left
+// and right
+void EffectGraphManager::Schedule::splitMidSide(const Step &step, int numSamples) const
+{
+  auto &io = channels[static_cast<size_t>(step.buffer)];
+  auto &side = channels[static_cast<size_t>(step.outputs[0])];
+
+  if (numChannels[static_cast<size_t>(step.buffer)] < 2)
+  {
+    // A mono input is all mid
+    juce::FloatVectorOperations::clear(side[0], numSamples);
+    juce::FloatVectorOperations::clear(side[1], numSamples);
+    return;
+  }
+
+  for (int i = 0; i < numSamples; ++i)
+  {
+    const float mid = 0.5f * (io[0][i] + io[1][i]);
+    const float difference = 0.5f * (io[0][i] - io[1][i]);
+    io[0][i] = mid;
+    io[1][i] = mid;
+    side[0][i] = difference;
+    side[1][i] = -difference;
+  }
+}
+
+void EffectGraphManager::Schedule::splitFrequency(const Step &step, int numSamples) const
+{
+  const int numCrossovers = static_cast<int>(step.crossovers.size());
+  const int channelsToSplit = numChannels[static_cast<size_t>(step.buffer)];
+
+  for (int channel = 0; channel < channelsToSplit; ++channel)
+  {
+    std::array<float *, maxCrossovers + 1> bands{};
+    bands[0] = channels[static_cast<size_t>(step.buffer)][static_cast<size_t>(channel)];
+    for (int band = 1; band <= numCrossovers; ++band)
+      bands[static_cast<size_t>(band)] = channels[static_cast<size_t>(step.outputs[static_cast<size_t>(band - 1)])][static_cast<size_t>(channel)];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+      std::array<float, maxCrossovers + 1> values;
+      float rest = bands[0][i];
+
+      // Peel each band off the bottom of what is left
+      for (int j = 0; j < numCrossovers; ++j)
+      {
+        float low, high;
+        step.crossovers[static_cast<size_t>(j)].processSample(channel, rest, low, high);
+        values[static_cast<size_t>(j)] = low;
+        rest = high;
+
+        for (int k = 0; k < j; ++k)
+          values[static_cast<size_t>(k)] = step.allpasses[static_cast<size_t>(j * (j - 1) / 2 + k)].processSample(channel, values[static_cast<size_t>(k)]);
+      }
+      values[static_cast<size_t>(numCrossovers)] = rest;
+
+      for (int band = 0; band <= numCrossovers; ++band)
+        bands[static_cast<size_t>(band)][i] = values[static_cast<size_t>(band)];
+    }
+  }
+
+  // A mono input leaves the other channel of each scratch output unset
+  if (channelsToSplit < 2)
+    for (int output : step.outputs)
+      juce::FloatVectorOperations::copy(channels[static_cast<size_t>(output)][1],
+                                        channels[static_cast<size_t>(output)][0], numSamples);
+}
+
+void EffectGraphManager::Schedule::run(juce::AudioBuffer<float> &buffer, int start, int numSamples,
+                                       juce::MidiBuffer &midiMessages, GraphWorkerPool &workers) const
+{
+  const int hostChannels = juce::jmin(2, buffer.getNumChannels());
+  numChannels[0] = hostChannels;
+  for (int channel = 0; channel < 2; ++channel)
+    channels[0][static_cast<size_t>(channel)] = buffer.getWritePointer(juce::jmin(channel, hostChannels - 1), start);
+
+  chunkSamples = numSamples;
+  if (tasks != nullptr && workers.run(*tasks, *this, numHelpers))
+    return;
+
+  // In order on this thread, when the graph is a chain or the pool is busy
+  for (const auto &step : steps)
+    runStep(step, numSamples, midiMessages);
+}
+
+void EffectGraphManager::Schedule::runTask(int task) const
+{
+  const auto &step = steps[static_cast<size_t>(task)];
+  step.midi.clear();
+  runStep(step, chunkSamples, step.midi);
+}
+
+void EffectGraphManager::Schedule::runStep(const Step &step, int numSamples, juce::MidiBuffer &midiMessages) const
+{
+  switch (step.type)
+  {
+  case NodeType::Input:
+    break;
+
+  case NodeType::Output:
+    for (const auto &copy : feedbackCopies)
+    {
+      const auto &from = channels[static_cast<size_t>(copy.first)];
+      const int fromChannels = numChannels[static_cast<size_t>(copy.first)];
+      auto &store = buffers[static_cast<size_t>(copy.second)];
+
+      for (int channel = 0; channel < 2; ++channel)
+      {
+        store.copyFrom(channel, 0, from[static_cast<size_t>(juce::jmin(channel, fromChannels - 1))], numSamples);
+        if (numSamples < store.getNumSamples())
+          store.clear(channel, numSamples, store.getNumSamples() - numSamples);
+      }
+    }
+    mixSources(step, numSamples);
+    break;
+
+  case NodeType::Mix:
+    mixSources(step, numSamples);
+    break;
+
+  case NodeType::Effect:
+    mixSources(step, numSamples);
+    if (step.processor != nullptr)
+    {
+      // Refers to the schedule's memory without allocating
+      juce::AudioBuffer<float> view(channels[static_cast<size_t>(step.buffer)].data(),
+                                    numChannels[static_cast<size_t>(step.buffer)], numSamples);
+      step.processor->processBlock(view, midiMessages);
+    }
+    break;
+
+  case NodeType::Split:
+    mixSources(step, numSamples);
+    if (step.splitMode == SplitMode::MidSide)
+      splitMidSide(step, numSamples);
+    else if (step.splitMode == SplitMode::Frequency)
+      splitFrequency(step, numSamples);
+    break;
+  }
+}
@@ -1,11 +1,201 @@
-/*
-  ==============================================================================
-
-    EffectGraphManager.h
-    Created: 15 Apr 2025 7:22:24pm
-    Author:  Evan Fraustro
-
-  ==============================================================================
-*/
-
-#pragma once
+/*
+  ==============================================================================
+
+    EffectGraphManager.h
+    Created: 15 Apr 2025 7:22:24pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../Effects/LatencyReporter.h"
+#include "../Effects/LockFreeSwap.h"
+#include "GraphWorkerPool.h"
+#include <functional>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+// Routes audio through effects along a directed graph. Supported routings are
+// parallel branches, splits by frequency or into mid and side, mixes with a
+// gain on every connection, and feedback connections that return a node's
+// output one block later.
+//
+// The graph is edited on the message thread as a plain description and
+// compiled into a schedule. The schedule lists the nodes in topological order
+// and gives each signal a scratch buffer for exactly as long as it is needed,
+// so branches share as few buffers as possible. Everything the schedule needs
+// is allocated while compiling. It reaches the audio thread through a
+// LockFreeSwap, so process() never locks or allocates.
+//
+// When two or more effects can run at the same time, the schedule also records
+// which steps wait for which, and the shared GraphWorkerPool runs independent
+// branches on several cores. Buffers are then only reused along a path, so
+// branches never wait on each other for memory.
+//
+// Effects report their latency through setLatencySamples(), or through a
+// LatencyReporter if it changes while they play. Every connection into a
+// node is delayed to match the slowest path into it, so parallel branches
+// meet in time, and the graph reports the slowest path to the output.
+// The delays outlive the schedule that made them and glide to a new length
+// over one block, so a recompile doesn't throw away what they hold.
+class EffectGraphManager : private juce::Timer
+{
+public:
+  using NodeID = int;
+  static constexpr NodeID inputNodeID = 0;
+  static constexpr NodeID outputNodeID = 1;
+  static constexpr int maxCrossovers = 4;
+
+  enum class NodeType
+  {
+    Input,  // The rack's input
+    Output, // The rack's output
+    Effect, // Runs one effect, or passes audio through if it has none
+    Mix,    // Only sums its connections, for merging branches
+    Split   // Divides its input between several outputs
+  };
+
+  enum class SplitMode
+  {
+    Copy,      // Every output carries the input, for parallel branches
+    Frequency, // One output per band between the crossovers, low to high
+    MidSide    // Output 0 the mid, output 1 the side. Summing them restores the input.
+  };
+
+  struct Node
+  {
+    NodeID id = inputNodeID;
+    NodeType type = NodeType::Mix;
+    int effect = 0; // Effect nodes: the owner's key for the processor
+    SplitMode splitMode = SplitMode::Copy;
+    int numCopies = 2;             // Copy splits
+    std::vector<float> crossovers; // Frequency splits, ascending, in Hz
+
+    int getNumOutputs() const;
+  };
+
+  // Every node sums the connections into it, each scaled by its gain
+  struct Connection
+  {
+    NodeID source = inputNodeID;
+    int sourceOutput = 0;
+    NodeID destination = outputNodeID;
+    float gain = 1.0f;
+    bool feedback = false; // Carries the source's output from the previous block
+  };
+
+  // A routing. It always has the input and output nodes.
+  class Graph
+  {
+  public:
+    Graph();
+
+    // Input, then each effect in turn, then output
+    static Graph serial(const std::vector<int> &effects);
+
+    NodeID addEffect(int effect);
+    NodeID addMix();
+    NodeID addCopySplit(int numCopies);
+    NodeID addFrequencySplit(std::vector<float> crossovers);
+    NodeID addMidSideSplit();
+    void removeNode(NodeID id);
+
+    void connect(NodeID source, NodeID destination, float gain = 1.0f, int sourceOutput = 0);
+    void addFeedback(NodeID source, NodeID destination, float gain, int sourceOutput = 0);
+
+    const Node *findNode(NodeID id) const;
+
+    juce::ValueTree toValueTree() const;
+    static Graph fromValueTree(const juce::ValueTree &tree);
+
+    std::vector<Node> nodes;
+    std::vector<Connection> connections;
+
+  private:
+    NodeID addNode(Node node);
+    NodeID nextID = outputNodeID + 1;
+  };
+
+  // Looks up the processor for an Effect node's key. Returning nullptr makes
+  // the node pass audio through.
+  using EffectResolver = std::function<std::shared_ptr<juce::AudioProcessor>(int effect)>;
+
+  EffectGraphManager();
+  ~EffectGraphManager() override;
+
+  // Message thread. Recompiles the current graph for the new settings. The
+  // owner prepares the effects themselves.
+  void prepare(double sampleRate, int maximumBlockSize);
+
+  // Message thread. Compiles the graph and hands it to the audio thread. The
+  // schedule holds on to its processors until the audio thread has let go of
+  // it. Returns false and keeps the current routing if the graph has a cycle
+  // without a feedback connection, or refers to nodes it doesn't have.
+  bool setGraph(const Graph &newGraph, const EffectResolver &resolveEffect);
+
+  // Audio thread. Stereo; buffers with more channels only have their first two
+  // processed. Effects in branches that run in parallel get an empty
+  // MidiBuffer of their own instead of the host's.
+  void process(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages);
+
+  // Audio thread. Clears everything the current schedule holds from earlier
+  // blocks, including its effects' own state, without reallocating.
+  void reset();
+
+  // Scratch buffers the current graph needs, not counting feedback
+  int getNumScratchBuffers() const { return compiled.numScratchBuffers; }
+
+  // Whether the current graph runs its branches on the worker pool
+  bool isParallel() const { return compiled.parallel; }
+
+  // Samples from the input to the output along the slowest path
+  int getLatencySamples() const { return compiled.latency; }
+
+  // Message thread. Called after an effect changed its latency and the graph
+  // was compiled again to match.
+  std::function<void()> onLatencyChanged;
+
+private:
+  struct Schedule;
+  class CompensationDelay;
+
+  // A connection, by source node, source output and destination node
+  using ConnectionKey = std::tuple<NodeID, int, NodeID>;
+
+  // What compiling found out besides the schedule
+  struct Analysis
+  {
+    int numScratchBuffers = 0;
+    bool parallel = false;
+    int latency = 0;
+    std::vector<int> effectLatencies; // Per node, as compiled
+    std::map<ConnectionKey, std::shared_ptr<CompensationDelay>> delays;
+  };
+
+  void timerCallback() override;
+
+  // Makes a schedule for the current settings and publishes it
+  void recompile();
+
+  std::unique_ptr<Schedule> compile(const Graph &graphToCompile,
+                                    const std::vector<std::shared_ptr<juce::AudioProcessor>> &nodeProcessors,
+                                    Analysis &analysis) const;
+
+  // The routing as last set, and the processors resolved for its nodes
+  Graph graph;
+  std::vector<std::shared_ptr<juce::AudioProcessor>> processors;
+
+  double currentSampleRate = 0.0;
+  int currentBlockSize = 0;
+  Analysis compiled;
+
+  juce::SharedResourcePointer<GraphWorkerPool> workers;
+  LockFreeSwap<Schedule> schedules;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EffectGraphManager)
+};
@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    GraphWorkerPool.cpp
+    Created: 18 Oct 2026 4:12:37pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#include "GraphWorkerPool.h"
+
+//==============================================================================
+class GraphWorkerPool::Worker : public juce::Thread
+{
+public:
+  Worker(GraphWorkerPool &owner, int threadIndex)
+      : juce::Thread("Graph Worker " + juce::String(threadIndex)), pool(owner), thread(threadIndex)
+  {
+  }
+
+  ~Worker() override
+  {
+    signalThreadShouldExit();
+    wakeUp.signal();
+    stopThread(4000);
+  }
+
+  // Audio thread
+  void wake()
+  {
+    if (sleeping.exchange(false))
+      wakeUp.signal();
+  }
+
+private:
+  void run() override
+  {
+    juce::ScopedNoDenormals noDenormals;
+    double idleSince = -1.0;
+
+    while (!threadShouldExit())
+    {
+      if (pool.currentJob.load(std::memory_order_relaxed) == nullptr)
+      {
+        // Spin a little in case a block is about to start, then sleep until
+        // the audio thread wakes us. The job is checked again after saying
+        // we sleep, so a wake-up can't slip in between.
+        const double now = juce::Time::getMillisecondCounterHiRes();
+        if (idleSince < 0.0)
+          idleSince = now;
+        if (now - idleSince < spinMilliseconds)
+          continue;
+
+        idleSince = -1.0;
+        sleeping.store(true);
+        if (pool.currentJob.load() == nullptr && !threadShouldExit())
+          wakeUp.wait(-1);
+        sleeping.store(false);
+        continue;
+      }
+
+      // Counted as busy before looking at the job, so the audio thread can't
+      // finish the block while we still hold on to it
+      pool.busyWorkers.fetch_add(1);
+      if (const auto *job = pool.currentJob.load())
+        work(*job, thread);
+      pool.busyWorkers.fetch_sub(1);
+      idleSince = -1.0;
+    }
+  }
+
+  // However fast the core, a worker gives up its core this soon after a block
+  static constexpr double spinMilliseconds = 0.2;
+
+  GraphWorkerPool &pool;
+  const int thread;
+  std::atomic<bool> sleeping{false};
+  juce::WaitableEvent wakeUp;
+};
+
+//==============================================================================
+GraphWorkerPool::TaskGraph::Deque::Deque(int numTasks)
+{
+  const int capacity = juce::nextPowerOfTwo(juce::jmax(1, numTasks));
+  tasks = std::make_unique<std::atomic<int>[]>(static_cast<size_t>(capacity));
+  mask = capacity - 1;
+}
+
+void GraphWorkerPool::TaskGraph::Deque::push(int task)
+{
+  const auto b = bottom.load(std::memory_order_relaxed);
+  tasks[static_cast<size_t>(b & mask)].store(task, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+int GraphWorkerPool::TaskGraph::Deque::pop()
+{
+  const auto b = bottom.load(std::memory_order_relaxed) - 1;
+  bottom.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  auto t = top.load(std::memory_order_relaxed);
+
+  if (t > b)
+  {
+    bottom.store(b + 1, std::memory_order_relaxed);
+    return -1;
+  }
+
+  int task = tasks[static_cast<size_t>(b & mask)].load(std::memory_order_relaxed);
+  if (t == b)
+  {
+    // The last task, which a thief may be taking at the same moment
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+      task = -1;
+    bottom.store(b + 1, std::memory_order_relaxed);
+  }
+  return task;
+}
+
+int GraphWorkerPool::TaskGraph::Deque::steal()
+{
+  auto t = top.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  const auto b = bottom.load(std::memory_order_acquire);
+
+  if (t >= b)
+    return -1;
+
+  const int task = tasks[static_cast<size_t>(t & mask)].load(std::memory_order_relaxed);
+  if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+    return -1;
+  return task;
+}
+
+//==============================================================================
+GraphWorkerPool::TaskGraph::TaskGraph(const std::vector<std::vector<int>> &successors, int numThreads)
+{
+  const int numTasks = static_cast<int>(successors.size());
+  numDependencies.assign(static_cast<size_t>(numTasks), 0);
+
+  for (int task = 0; task < numTasks; ++task)
+  {
+    firstSuccessor.push_back(static_cast<int>(successorList.size()));
+    for (int next : successors[static_cast<size_t>(task)])
+    {
+      jassert(next > task && next < numTasks);
+      successorList.push_back(next);
+      ++numDependencies[static_cast<size_t>(next)];
+    }
+  }
+  firstSuccessor.push_back(static_cast<int>(successorList.size()));
+
+  for (int task = 0; task < numTasks; ++task)
+    if (numDependencies[static_cast<size_t>(task)] == 0)
+      roots.push_back(task);
+
+  pending = std::make_unique<std::atomic<int>[]>(static_cast<size_t>(numTasks));
+  for (int thread = 0; thread < numThreads; ++thread)
+    deques.push_back(std::make_unique<Deque>(numTasks));
+}
+
+//==============================================================================
+GraphWorkerPool::GraphWorkerPool()
+{
+  // The threads themselves wait for startWorkers()
+  const int numWorkers = juce::jlimit(0, maxWorkers, juce::SystemStats::getNumCpus() - 1);
+  for (int worker = 0; worker < numWorkers; ++worker)
+    workers.push_back(std::make_unique<Worker>(*this, worker + 1));
+}
+
+void GraphWorkerPool::startWorkers()
+{
+  const juce::ScopedLock sl(startLock);
+  if (workersStarted)
+    return;
+
+  for (auto &worker : workers)
+    worker->startRealtimeThread(juce::Thread::RealtimeOptions{}.withPriority(10));
+  workersStarted = true;
+}
+
+GraphWorkerPool::~GraphWorkerPool()
+{
+  workers.clear();
+}
+
+bool GraphWorkerPool::run(const TaskGraph &graph, const TaskRunner &runner, int numHelpers)
+{
+  if (graph.deques.empty())
+    return false;
+
+  bool expected = false;
+  if (!inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+    return false;
+
+  const int numTasks = graph.getNumTasks();
+  for (int task = 0; task < numTasks; ++task)
+    graph.pending[static_cast<size_t>(task)].store(graph.numDependencies[static_cast<size_t>(task)], std::memory_order_relaxed);
+  graph.remaining.store(numTasks, std::memory_order_relaxed);
+
+  for (int root : graph.roots)
+    graph.deques[0]->push(root);
+
+  const Job job{graph, runner};
+  currentJob.store(&job);
+
+  const int numToWake = juce::jmin(numHelpers, getNumWorkers(), static_cast<int>(graph.deques.size()) - 1);
+  for (int worker = 0; worker < numToWake; ++worker)
+    workers[static_cast<size_t>(worker)]->wake();
+
+  work(job, 0);
+
+  // The job lives on this stack, so wait for every worker to let go of it
+  currentJob.store(nullptr);
+  while (busyWorkers.load() != 0)
+  {
+  }
+
+  inUse.store(false, std::memory_order_release);
+  return true;
+}
+
+void GraphWorkerPool::work(const Job &job, int thread)
+{
+  const auto &graph = job.graph;
+  const int numDeques = static_cast<int>(graph.deques.size());
+  if (thread >= numDeques)
+    return; // Compiled for fewer threads
+
+  auto &own = *graph.deques[static_cast<size_t>(thread)];
+
+  while (graph.remaining.load(std::memory_order_acquire) > 0)
+  {
+    int task = own.pop();
+    for (int offset = 1; task < 0 && offset < numDeques; ++offset)
+      task = graph.deques[static_cast<size_t>((thread + offset) % numDeques)]->steal();
+
+    if (task < 0)
+      continue;
+
+    job.runner.runTask(task);
+
+    // Whoever finishes a task's last dependency runs it next
+    for (int s = graph.firstSuccessor[static_cast<size_t>(task)]; s < graph.firstSuccessor[static_cast<size_t>(task) + 1]; ++s)
+    {
+      const int next = graph.successorList[static_cast<size_t>(s)];
+      if (graph.pending[static_cast<size_t>(next)].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        own.push(next);
+    }
+
+    graph.remaining.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    GraphWorkerPool.h
+    Created: 18 Oct 2026 4:12:37pm
+    Author:  Evan Fraustro
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Real-time worker threads that help the audio thread run the independent
+// branches of a compiled effect graph. Used through juce::SharedResourcePointer,
+// so every rack in the process shares one set of threads. The threads only
+// start once a graph that can use them is published, so serial racks never
+// pay for them.
+//
+// A TaskGraph gives each task the tasks that wait for it. Per block, every task
+// counts down its unfinished dependencies, and whichever thread finishes the
+// last one pushes the waiting task onto its own deque. Idle threads steal from
+// the other deques. All of it is lock-free and allocates nothing; the calling
+// thread takes part and returns once every task has run.
+class GraphWorkerPool
+{
+public:
+  // Anything beyond this many cores is left to the host
+  static constexpr int maxWorkers = 15;
+
+  // Runs the tasks of a TaskGraph. Called on any of the pool's threads.
+  struct TaskRunner
+  {
+    virtual ~TaskRunner() = default;
+    virtual void runTask(int task) const = 0;
+  };
+
+  class TaskGraph
+  {
+  public:
+    // successors[i] lists the tasks that can't start until task i is done.
+    // Every successor must come later than its task.
+    TaskGraph(const std::vector<std::vector<int>> &successors, int numThreads);
+
+    int getNumTasks() const { return static_cast<int>(numDependencies.size()); }
+
+  private:
+    friend class GraphWorkerPool;
+
+    // Chase-Lev deque. Only its owner pushes and pops at the bottom, other
+    // threads steal from the top. Each task is pushed once per block, so it
+    // never holds more than every task at once.
+    class Deque
+    {
+    public:
+      explicit Deque(int numTasks);
+
+      void push(int task);
+      int pop();   // -1 when empty
+      int steal(); // -1 when empty or lost to another thief
+
+    private:
+      std::unique_ptr<std::atomic<int>[]> tasks;
+      juce::int64 mask = 0;
+      alignas(64) std::atomic<juce::int64> top{0};
+      alignas(64) std::atomic<juce::int64> bottom{0};
+    };
+
+    std::vector<int> firstSuccessor; // Into successorList, one more than tasks
+    std::vector<int> successorList;
+    std::vector<int> numDependencies;
+    std::vector<int> roots;
+
+    // Reset at the start of every block
+    std::unique_ptr<std::atomic<int>[]> pending;
+    alignas(64) mutable std::atomic<int> remaining{0};
+
+    std::vector<std::unique_ptr<Deque>> deques; // One per thread, the caller's first
+  };
+
+  GraphWorkerPool();
+  ~GraphWorkerPool();
+
+  int getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+  // Threads a TaskGraph compiled now has to allow for, the caller included
+  int getNumThreads() const { return getNumWorkers() + 1; }
+
+  // Message thread. Starts the worker threads if they aren't running yet.
+  // Until then run() does every task on the calling thread.
+  void startWorkers();
+
+  // Audio thread. Runs every task once, each after all the tasks it waits
+  // for, waking up to numHelpers workers to help. Returns false without
+  // running anything if another thread is using the pool, so the caller can
+  // run the tasks itself.
+  bool run(const TaskGraph &graph, const TaskRunner &runner, int numHelpers);
+
+private:
+  class Worker;
+
+  struct Job
+  {
+    const TaskGraph &graph;
+    const TaskRunner &runner;
+  };
+
+  // Runs tasks from the thread's own deque, then steals, until none are left
+  static void work(const Job &job, int thread);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  juce::CriticalSection startLock;
+  bool workersStarted = false;
+
+  alignas(64) std::atomic<const Job *> currentJob{nullptr};
+  alignas(64) std::atomic<int> busyWorkers{0}; // Workers that may still touch currentJob
+  std::atomic<bool> inUse{false};
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(GraphWorkerPool)
+};
@@ -12,31 +12,70 @@
 //==============================================================================
 DelayAudioProcessorEditor::DelayAudioProcessorEditor(DelayAudioProcessor &p)
     : AudioProcessorEditor(&p), audioProcessor(p),
-      toolbar(p.getEffectRack()),
-      workspaceArea(),
-      topBar()
+      topBar(p.getInputGain(), p.getOutputGain())
 {
     setOpaque(true);
-    addAndMakeVisible(toolbar);
-    addAndMakeVisible(workspaceArea);
     addAndMakeVisible(topBar);
 
-    // Set up the callback for effect visibility changes
-    toolbar.onEffectVisibilityChanged = [this](const juce::String &effectName,
-                                               juce::AudioProcessor *processor,
-                                               bool isVisible)
+    // Each rack gets its own toolbar and workspace, and only the active
+    // rack's are shown
+    for (int i = 0; i < DelayAudioProcessor::numRacks; ++i)
     {
-        if (isVisible)
-            workspaceArea.addEffectParameters(effectName, processor);
-        else
-            workspaceArea.removeEffectParameters(effectName);
+        auto &toolbar = toolbars[static_cast<size_t>(i)];
+        auto &workspace = workspaces[static_cast<size_t>(i)];
+        toolbar = std::make_unique<ToolbarComponent>(p.getEffectRack(i));
+        workspace = std::make_unique<WorkspaceComponent>();
+        addChildComponent(*toolbar);
+        addChildComponent(*workspace);
+
+        // Set up the callback for effect visibility changes
+        auto *workspaceArea = workspace.get();
+        toolbar->onEffectVisibilityChanged = [workspaceArea](EffectRack::Handle handle,
+                                                             const juce::String &effectName,
+                                                             juce::AudioProcessor *processor,
+                                                             bool isVisible)
+        {
+            if (isVisible)
+                workspaceArea->addEffectParameters(handle, effectName, processor);
+            else
+                workspaceArea->removeEffectParameters(handle);
+        };
+
+        // Set up the callback for effect reordering
+        toolbar->onEffectReordered = [workspaceArea](int oldPosition, int newPosition)
+        {
+            // Update the workspace component's effect order
+            workspaceArea->reorderEffects(oldPosition, newPosition);
+        };
+    }
+
+    // The A/B switch flips the processor over on its next block
+    topBar.onCompareClicked = [this]
+    {
+        const int next = (audioProcessor.getActiveRack() + 1) % DelayAudioProcessor::numRacks;
+        audioProcessor.setActiveRack(next);
+        showRack(next);
     };
+    showRack(p.getActiveRack());
 
-    // Set up the callback for effect reordering
-    toolbar.onEffectReordered = [this](int oldPosition, int newPosition)
+    // Snapshots are taken of the rack being heard, and the morph moves both
+    topBar.setMorphParameter(p.getMorphParameter());
+    topBar.onMorphClicked = [this]
     {
-        // Update the workspace component's effect order
-        workspaceArea.reorderEffects(oldPosition, newPosition);
+        auto &rack = audioProcessor.getEffectRack(audioProcessor.getActiveRack());
+        const int numSnapshots = rack.getNumMorphSnapshots();
+
+        juce::PopupMenu menu;
+        menu.addItem(1, "Add snapshot " + juce::String(numSnapshots + 1));
+        menu.addItem(2, "Clear snapshots", numSnapshots > 0);
+        menu.showMenuAsync(juce::PopupMenu::Options().withTargetComponent(&topBar),
+                           [&rack](int result)
+                           {
+                               if (result == 1)
+                                   rack.addMorphSnapshot();
+                               else if (result == 2)
+                                   rack.clearMorphSnapshots();
+                           });
     };
 
     // Start the timer to update level meters
@@ -67,10 +106,25 @@ void DelayAudioProcessorEditor::resized()
 
     // Toolbar takes 20% of width
     int toolbarWidth = static_cast<int>(getWidth() * 0.2);
-    toolbar.setBounds(bounds.removeFromLeft(toolbarWidth));
+    auto toolbarBounds = bounds.removeFromLeft(toolbarWidth);
+
+    // Workspace takes the remaining space. Every rack's are laid out, hidden or not.
+    for (int i = 0; i < DelayAudioProcessor::numRacks; ++i)
+    {
+        toolbars[static_cast<size_t>(i)]->setBounds(toolbarBounds);
+        workspaces[static_cast<size_t>(i)]->setBounds(bounds);
+    }
+}
+
+void DelayAudioProcessorEditor::showRack(int index)
+{
+    for (int i = 0; i < DelayAudioProcessor::numRacks; ++i)
+    {
+        toolbars[static_cast<size_t>(i)]->setVisible(i == index);
+        workspaces[static_cast<size_t>(i)]->setVisible(i == index);
+    }
 
-    // Workspace takes the remaining space
-    workspaceArea.setBounds(bounds);
+    topBar.setActiveRack(index);
 }
 
 void DelayAudioProcessorEditor::setOutputLevel(float leftLevel, float rightLevel)
@@ -31,11 +31,14 @@ public:
 private:
   void timerCallback() override;
 
+  // Shows the toolbar and workspace of the rack being heard
+  void showRack(int index);
+
   // This reference is provided as a quick way for your editor to
   // access the processor object that created it.
   DelayAudioProcessor &audioProcessor;
-  ToolbarComponent toolbar;
-  WorkspaceComponent workspaceArea;
+  std::array<std::unique_ptr<ToolbarComponent>, DelayAudioProcessor::numRacks> toolbars;
+  std::array<std::unique_ptr<WorkspaceComponent>, DelayAudioProcessor::numRacks> workspaces;
   TopBarComponent topBar;
 
   JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DelayAudioProcessorEditor)
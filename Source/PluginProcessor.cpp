@@ -15,6 +15,13 @@ DelayAudioProcessor::DelayAudioProcessor()
                          .withInput("Input", juce::AudioChannelSet::stereo(), true)
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true))
 {
+    addParameter(morph = new juce::AudioParameterFloat(juce::ParameterID("morph", 1), "Morph", 0.0f, 1.0f, 0.0f));
+
+    // Racks publish their latency on the message thread, which is where the
+    // host gets told about it
+    for (auto &rack : effectRacks)
+        rack.onLatencyChanged = [this]
+        { updateHostLatency(); };
 }
 
 DelayAudioProcessor::~DelayAudioProcessor()
@@ -24,10 +31,13 @@ DelayAudioProcessor::~DelayAudioProcessor()
 
     // Then release resources with proper locking
     const juce::ScopedLock sl(effectRackLock);
-    effectRack.releaseResources();
+    for (auto &rack : effectRacks)
+    {
+        rack.releaseResources();
 
-    // Clear all effects before destruction
-    effectRack.clearEffects();
+        // Clear all effects before destruction
+        rack.clearEffects();
+    }
 }
 
 //==============================================================================
@@ -75,10 +85,24 @@ void DelayAudioProcessor::changeProgramName(int, const juce::String &) {}
 //==============================================================================
 void DelayAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
-    // Prepare the effect rack first
+    for (auto *gain : {&inputGain, &outputGain})
+    {
+        gain->setPlayConfigDetails(2, 2, sampleRate, samplesPerBlock);
+        gain->prepareToPlay(sampleRate, samplesPerBlock);
+    }
+
+    // Prepare both racks, so either can take over at any block
     {
         const juce::ScopedLock sl(effectRackLock);
-        effectRack.prepareToPlay(sampleRate, samplesPerBlock);
+        for (auto &rack : effectRacks)
+            rack.prepareToPlay(sampleRate, samplesPerBlock);
+
+        playingRack = activeRack.load();
+        fadingRack = -1;
+        fadeLength = juce::jmax(1, juce::roundToInt(sampleRate * 0.02));
+        fadeBuffer.setSize(2, samplesPerBlock);
+        fadeMidi.ensureSize(2048);
+        setLatencySamples(effectRacks[static_cast<size_t>(playingRack)].getLatencySamples());
     }
 
     isPrepared = true;
@@ -88,7 +112,10 @@ void DelayAudioProcessor::releaseResources()
 {
     isPrepared = false;
     const juce::ScopedLock sl(effectRackLock);
-    effectRack.releaseResources();
+    for (auto &rack : effectRacks)
+        rack.releaseResources();
+    inputGain.releaseResources();
+    outputGain.releaseResources();
 }
 
 bool DelayAudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
@@ -115,46 +142,101 @@ void DelayAudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::M
     for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    // Process the effect rack
+    inputGain.processBlock(buffer, midiMessages);
+
+    // Each rack glides to the new position across this block
+    for (auto &rack : effectRacks)
+        rack.setMorph(morph->get());
+
+    // No lock here: the racks publish their schedules lock-free, so a preset
+    // load rebuilding them never holds up this block
+    processRacks(buffer, midiMessages);
+
+    // The output stage meters as it applies its gain
+    outputGain.processBlock(buffer, midiMessages);
+
+    const auto toMeter = [](float rmsLevel)
     {
-        const juce::ScopedLock sl(effectRackLock);
-        effectRack.processBlock(buffer, midiMessages);
-    }
+        return juce::jlimit(0.0f, 1.0f, (juce::Decibels::gainToDecibels(rmsLevel) + 60.0f) / 60.0f);
+    };
 
-    // Update output levels
     AudioLevels levels;
-
     if (buffer.getNumChannels() >= 1)
+        levels.leftLevel = toMeter(outputGain.getRmsLevel(0));
+    if (buffer.getNumChannels() >= 2)
+        levels.rightLevel = toMeter(outputGain.getRmsLevel(1));
+
+    // Update levels with thread safety
     {
-        const float *leftData = buffer.getReadPointer(0);
-        float sumSquared = 0.0f;
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            sumSquared += leftData[sample] * leftData[sample];
-        }
-        float rmsLevel = std::sqrt(sumSquared / buffer.getNumSamples());
-        levels.leftLevel = juce::jlimit(0.0f, 1.0f,
-                                        (juce::Decibels::gainToDecibels(rmsLevel) + 60.0f) / 60.0f);
+        const juce::ScopedLock sl(levelsLock);
+        currentLevels = levels;
     }
+}
 
-    if (buffer.getNumChannels() >= 2)
+void DelayAudioProcessor::setActiveRack(int index)
+{
+    activeRack.store(juce::jlimit(0, numRacks - 1, index));
+    updateHostLatency();
+}
+
+void DelayAudioProcessor::updateHostLatency()
+{
+    // Effects change the rack's latency while playing, e.g. when pipelined
+    const int latency = effectRacks[static_cast<size_t>(activeRack.load())].getLatencySamples();
+    if (latency != getLatencySamples())
+        setLatencySamples(latency);
+}
+
+void DelayAudioProcessor::processRacks(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages)
+{
+    const int requested = activeRack.load();
+    if (requested != playingRack)
     {
-        const float *rightData = buffer.getReadPointer(1);
-        float sumSquared = 0.0f;
-        for (int sample = 0; sample < buffer.getNumSamples(); ++sample)
-        {
-            sumSquared += rightData[sample] * rightData[sample];
-        }
-        float rmsLevel = std::sqrt(sumSquared / buffer.getNumSamples());
-        levels.rightLevel = juce::jlimit(0.0f, 1.0f,
-                                         (juce::Decibels::gainToDecibels(rmsLevel) + 60.0f) / 60.0f);
+        // A rack that sat idle still holds its tails from when it was last
+        // heard, so it comes back from silence. Switching back mid-fade turns
+        // the fade around where it is instead.
+        if (requested != fadingRack)
+            effectRacks[static_cast<size_t>(requested)].reset();
+
+        fadeSamplesLeft = requested == fadingRack ? fadeLength - fadeSamplesLeft : fadeLength;
+        fadingRack = playingRack;
+        playingRack = requested;
     }
 
-    // Update levels with thread safety
+    auto &playing = effectRacks[static_cast<size_t>(playingRack)];
+    const int numSamples = buffer.getNumSamples();
+    const int numChannels = juce::jmin(buffer.getNumChannels(), fadeBuffer.getNumChannels());
+
+    // Blocks longer than prepared for switch without a fade
+    if (fadingRack < 0 || numSamples > fadeBuffer.getNumSamples())
     {
-        const juce::ScopedLock sl(levelsLock);
-        currentLevels = levels;
+        fadingRack = -1;
+        playing.processBlock(buffer, midiMessages);
+        return;
+    }
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        fadeBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+
+    juce::AudioBuffer<float> fading(fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+    fadeMidi.clear();
+    effectRacks[static_cast<size_t>(fadingRack)].processBlock(fading, fadeMidi);
+    playing.processBlock(buffer, midiMessages);
+
+    // A linear fade, so two racks that sound the same pass through unchanged
+    const int fadeSamples = juce::jmin(numSamples, fadeSamplesLeft);
+    const float startGain = 1.0f - static_cast<float>(fadeSamplesLeft) / static_cast<float>(fadeLength);
+    const float endGain = 1.0f - static_cast<float>(fadeSamplesLeft - fadeSamples) / static_cast<float>(fadeLength);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        buffer.applyGainRamp(channel, 0, fadeSamples, startGain, endGain);
+        buffer.addFromWithRamp(channel, 0, fading.getReadPointer(channel), fadeSamples, 1.0f - startGain, 1.0f - endGain);
     }
+
+    fadeSamplesLeft -= fadeSamples;
+    if (fadeSamplesLeft == 0)
+        fadingRack = -1;
 }
 
 //==============================================================================
@@ -172,13 +254,68 @@ juce::AudioProcessorEditor *DelayAudioProcessor::createEditor()
 void DelayAudioProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
     const juce::ScopedLock sl(effectRackLock);
-    effectRack.getStateInformation(destData);
+
+    juce::ValueTree state("RACKS");
+    state.setProperty("active", activeRack.load(), nullptr);
+    state.setProperty("morph", morph->get(), nullptr);
+
+    // The gain stages sit outside the racks, so A and B share them
+    juce::MemoryBlock inputGainData, outputGainData;
+    inputGain.getStateInformation(inputGainData);
+    outputGain.getStateInformation(outputGainData);
+    state.setProperty("inputGain", inputGainData.toBase64Encoding(), nullptr);
+    state.setProperty("outputGain", outputGainData.toBase64Encoding(), nullptr);
+
+    for (auto &rack : effectRacks)
+    {
+        juce::MemoryBlock rackData;
+        rack.getStateInformation(rackData);
+
+        juce::ValueTree rackState("RACK");
+        rackState.setProperty("state", rackData.toBase64Encoding(), nullptr);
+        state.addChild(rackState, -1, nullptr);
+    }
+
+    std::unique_ptr<juce::XmlElement> xml(state.createXml());
+    copyXmlToBinary(*xml, destData);
 }
 
 void DelayAudioProcessor::setStateInformation(const void *data, int sizeInBytes)
 {
     const juce::ScopedLock sl(effectRackLock);
-    effectRack.setStateInformation(data, sizeInBytes);
+
+    std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
+    if (xml == nullptr)
+        return;
+
+    // States from before A/B comparison hold a single rack, which becomes A
+    if (xml->hasTagName("EFFECTRACK"))
+    {
+        effectRacks[0].setStateInformation(data, sizeInBytes);
+        return;
+    }
+
+    if (!xml->hasTagName("RACKS"))
+        return;
+
+    const auto state = juce::ValueTree::fromXml(*xml);
+    for (int i = 0; i < numRacks && i < state.getNumChildren(); ++i)
+    {
+        juce::MemoryBlock rackData;
+        if (rackData.fromBase64Encoding(state.getChild(i).getProperty("state").toString()))
+            effectRacks[static_cast<size_t>(i)].setStateInformation(rackData.getData(), static_cast<int>(rackData.getSize()));
+    }
+
+    setActiveRack(state.getProperty("active", 0));
+
+    // States saved before the gain stages were stored leave them as they are
+    juce::MemoryBlock gainData;
+    if (gainData.fromBase64Encoding(state.getProperty("inputGain").toString()))
+        inputGain.setStateInformation(gainData.getData(), static_cast<int>(gainData.getSize()));
+    gainData.reset();
+    if (gainData.fromBase64Encoding(state.getProperty("outputGain").toString()))
+        outputGain.setStateInformation(gainData.getData(), static_cast<int>(gainData.getSize()));
+    morph->setValueNotifyingHost(morph->convertTo0to1(state.getProperty("morph", 0.0f)));
 }
 
 //==============================================================================
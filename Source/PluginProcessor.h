@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "./Effects/EffectRack.h"
+#include "./Effects/GainProcessor.h"
+#include <array>
 
 //==============================================================================
 /**
@@ -51,19 +53,37 @@ public:
   void getStateInformation(juce::MemoryBlock &destData) override;
   void setStateInformation(const void *data, int sizeInBytes) override;
 
+  // A/B comparison. Both racks are kept prepared, and switching fades from
+  // one to the other over the next few blocks without touching either
+  // rack's settings. The incoming rack starts from silence rather than
+  // replaying the tails it held when it was last heard.
+  static constexpr int numRacks = 2;
+
   // Effect rack access with thread safety
-  EffectRack &getEffectRack()
+  EffectRack &getEffectRack(int index)
   {
     const juce::ScopedLock sl(effectRackLock);
-    return effectRack;
+    return effectRacks[static_cast<size_t>(juce::jlimit(0, numRacks - 1, index))];
   }
 
-  const EffectRack &getEffectRack() const
+  const EffectRack &getEffectRack(int index) const
   {
     const juce::ScopedLock sl(effectRackLock);
-    return effectRack;
+    return effectRacks[static_cast<size_t>(juce::jlimit(0, numRacks - 1, index))];
   }
 
+  // The rack being heard, or faded to. Any thread; the audio thread picks up
+  // a change at the start of its next block.
+  int getActiveRack() const { return activeRack.load(); }
+  void setActiveRack(int index);
+
+  // Host automatable. Moves both racks through their morph snapshots.
+  juce::RangedAudioParameter &getMorphParameter() { return *morph; }
+
+  // Gain stages at the very start and end of the signal path
+  GainProcessor &getInputGain() { return inputGain; }
+  GainProcessor &getOutputGain() { return outputGain; }
+
   // Level monitoring
   struct AudioLevels
   {
@@ -81,13 +101,37 @@ private:
   //==============================================================================
   void removeAllGraphConnections();
 
+  // Message thread. Reports the active rack's latency to the host.
+  void updateHostLatency();
+
+  // Runs the playing rack, and the one being faded out alongside it
+  void processRacks(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages);
+
   juce::AudioProcessorGraph audioGraph;
   juce::AudioProcessorGraph::Node::Ptr inputNode;
   juce::AudioProcessorGraph::Node::Ptr outputNode;
-  EffectRack effectRack;
-
+  // Shared by both racks, which always play at the same settings
+  EffectPool effectPool;
+  std::array<EffectRack, numRacks> effectRacks{{EffectRack(effectPool), EffectRack(effectPool)}};
+  GainProcessor inputGain{true};
+  GainProcessor outputGain{false};
+
+  // Serialises state saves, loads and preparation of the racks. The audio
+  // thread never takes it.
   mutable juce::CriticalSection effectRackLock;
 
+  std::atomic<int> activeRack{0};
+  juce::AudioParameterFloat *morph = nullptr; // Owned by the processor
+
+  // Audio thread. The fading rack runs on a copy of the input until its
+  // fade is over.
+  int playingRack = 0;
+  int fadingRack = -1;
+  int fadeLength = 0;
+  int fadeSamplesLeft = 0;
+  juce::AudioBuffer<float> fadeBuffer;
+  juce::MidiBuffer fadeMidi;
+
   AudioLevels currentLevels;
   mutable juce::CriticalSection levelsLock;
 